@@ -10,6 +10,7 @@
    CGLM_INLINE void glm_mul(mat4 m1, mat4 m2, mat4 dest);
    CGLM_INLINE void glm_mul_rot(mat4 m1, mat4 m2, mat4 dest);
    CGLM_INLINE void glm_inv_tr(mat4 mat);
+   CGLM_INLINE void glm_inv_affine(mat4 mat, mat4 dest);
  */
 
 #ifndef cglm_affine_mat_h
@@ -186,4 +187,37 @@ glm_inv_tr(mat4 mat) {
 #endif
 }
 
+/*!
+ * @brief inverse affine matrix (any invertible 3x3 part + translation)
+ *
+ * much cheaper than glm_mat4_inv because the last row is known to be
+ * 0 0 0 1, use glm_inv_tr if the 3x3 part is orthonormal.
+ *
+ * @code
+ * X = | M  T |   X' = | M' -M'T |
+ *     | 0  1 |        | 0     1 |
+ * @endcode
+ *
+ * @param[in]  mat  affine matrix
+ * @param[out] dest inverse matrix, may be same as mat
+ */
+CGLM_INLINE
+void
+glm_inv_affine(mat4 mat, mat4 dest) {
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  glm_inv_affine_sse2(mat, dest);
+#else
+  CGLM_ALIGN_MAT mat3 r;
+  CGLM_ALIGN(8)  vec3 t;
+
+  glm_mat4_pick3(mat, r);
+  glm_mat3_inv(r, r);
+  glm_mat3_mulv(r, mat[3], t);
+
+  glm_mat4_identity(dest);
+  glm_mat4_ins3(r, dest);
+  glm_vec3_negate_to(t, dest[3]);
+#endif
+}
+
 #endif /* cglm_affine_mat_h */
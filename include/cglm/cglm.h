@@ -16,6 +16,7 @@
 #include "ivec3.h"
 #include "ivec4.h"
 #include "mat4.h"
+#include "mat4-batch.h"
 #include "mat4x2.h"
 #include "mat4x3.h"
 #include "mat3.h"
@@ -29,11 +30,15 @@
 #include "frustum.h"
 #include "quat.h"
 #include "euler.h"
+#include "quat-batch.h"
+#include "pack.h"
 #include "plane.h"
 #include "aabb2d.h"
 #include "box.h"
+#include "cull.h"
 #include "color.h"
 #include "util.h"
+#include "sincos.h"
 #include "io.h"
 #include "project.h"
 #include "sphere.h"
@@ -41,6 +46,7 @@
 #include "curve.h"
 #include "bezier.h"
 #include "ray.h"
+#include "ray-batch.h"
 #include "affine2d.h"
 
 #endif /* cglm_h */
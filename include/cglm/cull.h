@@ -0,0 +1,350 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief transforming and frustum culling many bounding volumes at once
+ *
+ * Bounds are SoA, component k of item i is at p[k * stride + i], stride must
+ * be >= the number of items:
+ *
+ *   boxes:   center.x center.y center.z extent.x extent.y extent.z
+ *   spheres: center.x center.y center.z radius
+ *
+ * planes are the ones glm_frustum_planes gives. A box is visible when it is
+ * not fully behind any plane, same as glm_aabb_frustum; a sphere is visible
+ * when its center is not farther than radius behind any plane, planes must
+ * be normalized for spheres (glm_plane_normalize).
+ *
+ * The cull functions handle items [first, first + count) and write indices
+ * of visible items, in ascending order, to visible which must have room for
+ * count indices. Disjoint ranges can be culled on different threads to
+ * separate outputs. AVX-512 tests 16, AVX 8 and SSE2 4 items per step.
+ *
+ * The transform functions move item i by m[i] (affine) into world space,
+ * AVX transforms 8 and SSE2 4 items per step. Boxes use Arvo's method, on
+ * center / extent it is c' = M * c + t, e' = |M| * e, which is the tight
+ * box around the transformed box. Unlike glm_sphere_transform the radius is
+ * scaled by the largest axis scale of m[i], so scaled spheres stay bounding.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE void   glm_aabb_soa_set(vec3 box[2], float *dest,
+                                       size_t stride, size_t index);
+   CGLM_INLINE void   glm_sphere_soa_set(vec4 s, float *dest,
+                                         size_t stride, size_t index);
+   CGLM_INLINE size_t glm_aabb_frustum_soa(const float *bounds,
+                                           size_t stride, size_t first,
+                                           size_t count, vec4 planes[6],
+                                           uint32_t *visible);
+   CGLM_INLINE size_t glm_sphere_frustum_soa(const float *spheres,
+                                             size_t stride, size_t first,
+                                             size_t count, vec4 planes[6],
+                                             uint32_t *visible);
+   CGLM_INLINE void   glm_aabb_transform_soa(const float *src, size_t stride,
+                                             mat4 *m, float *dest,
+                                             size_t count);
+   CGLM_INLINE void   glm_sphere_transform_soa(const float *src,
+                                               size_t stride, mat4 *m,
+                                               float *dest, size_t count);
+ */
+
+#ifndef cglm_cull_h
+#define cglm_cull_h
+
+#include "common.h"
+#include "vec3.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/cull.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/cull.h"
+#endif
+
+#ifdef CGLM_AVX512_FP
+#  include "simd/avx512/cull.h"
+#endif
+
+#ifdef CGLM_RUNTIME_DISPATCH
+#  include "dispatch.h"
+#endif
+
+/*!
+ * @brief store box into slot [index] of SoA center / extent storage
+ *
+ * @param[in]  box    bounding box
+ * @param[out] dest   SoA bounds
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  box index
+ */
+CGLM_INLINE
+void
+glm_aabb_soa_set(vec3 box[2], float *dest, size_t stride, size_t index) {
+  int k;
+
+  for (k = 0; k < 3; k++) {
+    dest[k * stride + index]       = (box[1][k] + box[0][k]) * 0.5f;
+    dest[(k + 3) * stride + index] = (box[1][k] - box[0][k]) * 0.5f;
+  }
+}
+
+/*!
+ * @brief store sphere into slot [index] of SoA sphere storage
+ *
+ * @param[in]  s      sphere
+ * @param[out] dest   SoA spheres
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  sphere index
+ */
+CGLM_INLINE
+void
+glm_sphere_soa_set(vec4 s, float *dest, size_t stride, size_t index) {
+  dest[index]              = s[0];
+  dest[stride + index]     = s[1];
+  dest[2 * stride + index] = s[2];
+  dest[3 * stride + index] = s[3];
+}
+
+/*!
+ * @brief frustum cull SoA boxes
+ *
+ * @param[in]  bounds  SoA boxes (center, extent)
+ * @param[in]  stride  distance between planes (in floats)
+ * @param[in]  first   first box to test
+ * @param[in]  count   number of boxes to test
+ * @param[in]  planes  frustum planes
+ * @param[out] visible indices of visible boxes
+ *
+ * @returns number of visible boxes
+ */
+CGLM_INLINE
+size_t
+glm_aabb_frustum_soa(const float *bounds,
+                     size_t       stride,
+                     size_t       first,
+                     size_t       count,
+                     vec4         planes[6],
+                     uint32_t    *visible) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  return glm_dispatch.aabb_frustum_soa(bounds, stride, first, count, planes,
+                                       visible);
+#else
+  const float *b;
+  float  d;
+  size_t i, n;
+  int    j;
+
+  i = 0;
+  n = 0;
+
+#if defined(__AVX512F__)
+  i = glm_aabb_frustum_soa_avx512(bounds, stride, first, count, planes,
+                                  visible, &n);
+#endif
+#if defined(__AVX__)
+  i += glm_aabb_frustum_soa_avx(bounds, stride, first + i, count - i, planes,
+                                visible, &n);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_aabb_frustum_soa_sse2(bounds, stride, first + i, count - i, planes,
+                                 visible, &n);
+#endif
+
+  for (; i < count; i++) {
+    b = bounds + first + i;
+
+    for (j = 0; j < 6; j++) {
+      d = planes[j][0] * b[0]
+        + planes[j][1] * b[stride]
+        + planes[j][2] * b[2 * stride] + planes[j][3]
+        + fabsf(planes[j][0]) * b[3 * stride]
+        + fabsf(planes[j][1]) * b[4 * stride]
+        + fabsf(planes[j][2]) * b[5 * stride];
+
+      if (d < 0.0f)
+        break;
+    }
+
+    if (j == 6)
+      visible[n++] = (uint32_t)(first + i);
+  }
+
+  return n;
+#endif
+}
+
+/*!
+ * @brief frustum cull SoA spheres
+ *
+ * @param[in]  spheres SoA spheres
+ * @param[in]  stride  distance between planes (in floats)
+ * @param[in]  first   first sphere to test
+ * @param[in]  count   number of spheres to test
+ * @param[in]  planes  normalized frustum planes
+ * @param[out] visible indices of visible spheres
+ *
+ * @returns number of visible spheres
+ */
+CGLM_INLINE
+size_t
+glm_sphere_frustum_soa(const float *spheres,
+                       size_t       stride,
+                       size_t       first,
+                       size_t       count,
+                       vec4         planes[6],
+                       uint32_t    *visible) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  return glm_dispatch.sphere_frustum_soa(spheres, stride, first, count,
+                                         planes, visible);
+#else
+  const float *s;
+  float  d;
+  size_t i, n;
+  int    j;
+
+  i = 0;
+  n = 0;
+
+#if defined(__AVX512F__)
+  i = glm_sphere_frustum_soa_avx512(spheres, stride, first, count, planes,
+                                    visible, &n);
+#endif
+#if defined(__AVX__)
+  i += glm_sphere_frustum_soa_avx(spheres, stride, first + i, count - i,
+                                  planes, visible, &n);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_sphere_frustum_soa_sse2(spheres, stride, first + i, count - i,
+                                   planes, visible, &n);
+#endif
+
+  for (; i < count; i++) {
+    s = spheres + first + i;
+
+    for (j = 0; j < 6; j++) {
+      d = planes[j][0] * s[0]
+        + planes[j][1] * s[stride]
+        + planes[j][2] * s[2 * stride] + planes[j][3];
+
+      if (d < -s[3 * stride])
+        break;
+    }
+
+    if (j == 6)
+      visible[n++] = (uint32_t)(first + i);
+  }
+
+  return n;
+#endif
+}
+
+/*!
+ * @brief transform SoA boxes by one matrix each, dest can be src
+ *
+ * @param[in]  src    SoA boxes (center, extent)
+ * @param[in]  stride distance between planes (in floats), same for dest
+ * @param[in]  m      affine transform of each box
+ * @param[out] dest   transformed SoA boxes
+ * @param[in]  count  number of boxes
+ */
+CGLM_INLINE
+void
+glm_aabb_transform_soa(const float *src,
+                       size_t       stride,
+                       mat4        *m,
+                       float       *dest,
+                       size_t       count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.aabb_transform_soa(src, stride, m, dest, count);
+#else
+  float  c[3], e[3];
+  size_t i;
+  int    j, k;
+
+  i = 0;
+
+#if defined(__AVX__)
+  i = glm_aabb_transform_soa_avx(src, stride, m, dest, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_aabb_transform_soa_sse2(src + i, stride, m + i, dest + i,
+                                   count - i);
+#endif
+
+  for (; i < count; i++) {
+    for (k = 0; k < 3; k++) {
+      c[k] = src[k * stride + i];
+      e[k] = src[(k + 3) * stride + i];
+    }
+
+    for (j = 0; j < 3; j++) {
+      dest[j * stride + i] = m[i][3][j]
+                           + m[i][0][j] * c[0]
+                           + m[i][1][j] * c[1]
+                           + m[i][2][j] * c[2];
+      dest[(j + 3) * stride + i] = fabsf(m[i][0][j]) * e[0]
+                                 + fabsf(m[i][1][j]) * e[1]
+                                 + fabsf(m[i][2][j]) * e[2];
+    }
+  }
+#endif
+}
+
+/*!
+ * @brief transform SoA spheres by one matrix each, dest can be src
+ *
+ * @param[in]  src    SoA spheres
+ * @param[in]  stride distance between planes (in floats), same for dest
+ * @param[in]  m      affine transform of each sphere
+ * @param[out] dest   transformed SoA spheres
+ * @param[in]  count  number of spheres
+ */
+CGLM_INLINE
+void
+glm_sphere_transform_soa(const float *src,
+                         size_t       stride,
+                         mat4        *m,
+                         float       *dest,
+                         size_t       count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.sphere_transform_soa(src, stride, m, dest, count);
+#else
+  float  c[3], r, ss;
+  size_t i;
+  int    j, k;
+
+  i = 0;
+
+#if defined(__AVX__)
+  i = glm_sphere_transform_soa_avx(src, stride, m, dest, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_sphere_transform_soa_sse2(src + i, stride, m + i, dest + i,
+                                     count - i);
+#endif
+
+  for (; i < count; i++) {
+    for (k = 0; k < 3; k++)
+      c[k] = src[k * stride + i];
+    r = src[3 * stride + i];
+
+    ss = glm_max(glm_vec3_norm2(m[i][0]),
+                 glm_max(glm_vec3_norm2(m[i][1]), glm_vec3_norm2(m[i][2])));
+
+    for (j = 0; j < 3; j++)
+      dest[j * stride + i] = m[i][3][j]
+                           + m[i][0][j] * c[0]
+                           + m[i][1][j] * c[1]
+                           + m[i][2][j] * c[2];
+    dest[3 * stride + i] = r * sqrtf(ss);
+  }
+#endif
+}
+
+#endif /* cglm_cull_h */
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief runtime CPU dispatch for hot functions
+ *
+ * cglm normally picks SSE2 / AVX / NEON at compile time, so a portable build
+ * never uses wider units of the host. Defining CGLM_RUNTIME_DISPATCH makes
+ * the functions listed in glm_dispatch_table call through a function pointer
+ * table which is resolved once (on first call, or by glm_dispatch_init) by
+ * reading CPUID / XGETBV.
+ *
+ * Kernel tables are ordinary cglm code compiled with different target flags,
+ * one translation unit per table. The translation unit must not define
+ * CGLM_RUNTIME_DISPATCH itself, and must define CGLM_ALL_UNALIGNED because
+ * callers align mat4 for their own flags only (16 bytes without AVX):
+ *
+ * @code
+ * // kernels-avx2.c, compiled with -mavx2 -mfma
+ * #define CGLM_ALL_UNALIGNED
+ * #include "cglm/cglm.h"
+ * #include "cglm/dispatch.h"
+ * CGLM_DISPATCH_KERNELS(avx2, GLM_ISA_AVX2);
+ * @endcode
+ *
+ * On x86 the tables generic (default flags), avx, avx2 (+fma) and avx512
+ * (avx512f + avx2 + fma) must be linked; other architectures only need
+ * generic. Exactly one translation unit defines CGLM_DISPATCH_IMPLEMENTATION
+ * before including this header to get the table and resolver.
+ */
+
+/*
+ Types:
+   enum glm_isa
+   struct glm_dispatch_table
+
+ Functions:
+   CGLM_EXPORT glm_isa glm_cpu_isa(void);
+   CGLM_EXPORT glm_isa glm_dispatch_init(void);
+ */
+
+#ifndef cglm_dispatch_h
+#define cglm_dispatch_h
+
+#include "common.h"
+
+#if defined(__x86_64__) || defined(__i386__)                                  \
+ || defined(_M_X64) || defined(_M_IX86)
+#  define CGLM_DISPATCH_X86
+#endif
+
+typedef enum glm_isa {
+  GLM_ISA_GENERIC = 0, /* whatever the default compile flags give */
+  GLM_ISA_SSE2    = 1,
+  GLM_ISA_AVX     = 2,
+  GLM_ISA_AVX2    = 3, /* AVX2 + FMA */
+  GLM_ISA_AVX512  = 4  /* AVX512F + AVX2 + FMA */
+} glm_isa;
+
+typedef struct glm_dispatch_table {
+  void (*mat4_mul)(mat4 m1, mat4 m2, mat4 dest);
+  void (*mat4_inv)(mat4 mat, mat4 dest);
+  void (*quat_mul)(versor p, versor q, versor dest);
+  void (*mat4_mul_batch)(mat4 *m1, mat4 *m2, mat4 *dest, size_t count);
+  void (*mat4_mulv_batch)(mat4 m, vec4 *v, vec4 *dest, size_t count);
+  void (*mat4_mulv3_batch)(mat4 m, vec3 *v, float last, vec3 *dest,
+                           size_t count);
+  void (*mat4_inv_batch)(mat4 *mat, mat4 *dest, size_t count);
+  size_t (*aabb_frustum_soa)(const float *bounds, size_t stride, size_t first,
+                             size_t count, vec4 planes[6], uint32_t *visible);
+  size_t (*sphere_frustum_soa)(const float *spheres, size_t stride,
+                               size_t first, size_t count, vec4 planes[6],
+                               uint32_t *visible);
+  void (*aabb_transform_soa)(const float *src, size_t stride, mat4 *m,
+                             float *dest, size_t count);
+  void (*sphere_transform_soa)(const float *src, size_t stride, mat4 *m,
+                               float *dest, size_t count);
+  glm_isa isa;
+} glm_dispatch_table;
+
+CGLM_EXPORT extern glm_dispatch_table       glm_dispatch;
+
+CGLM_EXPORT extern const glm_dispatch_table glm_dispatch_generic;
+#ifdef CGLM_DISPATCH_X86
+CGLM_EXPORT extern const glm_dispatch_table glm_dispatch_avx;
+CGLM_EXPORT extern const glm_dispatch_table glm_dispatch_avx2;
+CGLM_EXPORT extern const glm_dispatch_table glm_dispatch_avx512;
+#endif
+
+/*!
+ * @brief best instruction set the CPU and OS support
+ */
+CGLM_EXPORT
+glm_isa
+glm_cpu_isa(void);
+
+/*!
+ * @brief resolve glm_dispatch for this CPU, safe to call more than once
+ *
+ * calling this is optional, the first dispatched call resolves the table
+ *
+ * @return instruction set of the selected table
+ */
+CGLM_EXPORT
+glm_isa
+glm_dispatch_init(void);
+
+/*!
+ * @brief define table glm_dispatch_<name> from the cglm functions as they are
+ *        compiled in the current translation unit
+ */
+#define CGLM_DISPATCH_KERNELS(name, ISA)                                      \
+  static void glmd_mat4_mul(mat4 m1, mat4 m2, mat4 dest) {                    \
+    glm_mat4_mul(m1, m2, dest);                                               \
+  }                                                                           \
+  static void glmd_mat4_inv(mat4 mat, mat4 dest) {                            \
+    glm_mat4_inv(mat, dest);                                                  \
+  }                                                                           \
+  static void glmd_quat_mul(versor p, versor q, versor dest) {                \
+    glm_quat_mul(p, q, dest);                                                 \
+  }                                                                           \
+  static void glmd_mat4_mul_batch(mat4 *m1, mat4 *m2, mat4 *dest,             \
+                                  size_t count) {                             \
+    glm_mat4_mul_batch(m1, m2, dest, count);                                  \
+  }                                                                           \
+  static void glmd_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest,               \
+                                   size_t count) {                            \
+    glm_mat4_mulv_batch(m, v, dest, count);                                   \
+  }                                                                           \
+  static void glmd_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest,  \
+                                    size_t count) {                           \
+    glm_mat4_mulv3_batch(m, v, last, dest, count);                            \
+  }                                                                           \
+  static void glmd_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {      \
+    glm_mat4_inv_batch(mat, dest, count);                                     \
+  }                                                                           \
+  static size_t glmd_aabb_frustum_soa(const float *bounds, size_t stride,     \
+                                      size_t first, size_t count,             \
+                                      vec4 planes[6], uint32_t *visible) {    \
+    return glm_aabb_frustum_soa(bounds, stride, first, count, planes,         \
+                                visible);                                     \
+  }                                                                           \
+  static size_t glmd_sphere_frustum_soa(const float *spheres, size_t stride,  \
+                                        size_t first, size_t count,           \
+                                        vec4 planes[6], uint32_t *visible) {  \
+    return glm_sphere_frustum_soa(spheres, stride, first, count, planes,      \
+                                  visible);                                   \
+  }                                                                           \
+  static void glmd_aabb_transform_soa(const float *src, size_t stride,        \
+                                      mat4 *m, float *dest, size_t count) {   \
+    glm_aabb_transform_soa(src, stride, m, dest, count);                      \
+  }                                                                           \
+  static void glmd_sphere_transform_soa(const float *src, size_t stride,      \
+                                        mat4 *m, float *dest, size_t count) { \
+    glm_sphere_transform_soa(src, stride, m, dest, count);                    \
+  }                                                                           \
+  const glm_dispatch_table glm_dispatch_##name = {                            \
+    glmd_mat4_mul,                                                            \
+    glmd_mat4_inv,                                                            \
+    glmd_quat_mul,                                                            \
+    glmd_mat4_mul_batch,                                                      \
+    glmd_mat4_mulv_batch,                                                     \
+    glmd_mat4_mulv3_batch,                                                    \
+    glmd_mat4_inv_batch,                                                      \
+    glmd_aabb_frustum_soa,                                                    \
+    glmd_sphere_frustum_soa,                                                  \
+    glmd_aabb_transform_soa,                                                  \
+    glmd_sphere_transform_soa,                                                \
+    ISA                                                                       \
+  }
+
+#ifdef CGLM_DISPATCH_IMPLEMENTATION
+
+#ifdef CGLM_DISPATCH_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+
+static
+void
+glm__cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#if defined(_MSC_VER)
+  int x[4];
+  __cpuidex(x, (int)leaf, (int)sub);
+  r[0] = (unsigned)x[0]; r[1] = (unsigned)x[1];
+  r[2] = (unsigned)x[2]; r[3] = (unsigned)x[3];
+#else
+  __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static
+unsigned long long
+glm__xgetbv(void) {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  unsigned lo, hi;
+  __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif
+
+CGLM_EXPORT
+glm_isa
+glm_cpu_isa(void) {
+#ifdef CGLM_DISPATCH_X86
+  unsigned           r[4], maxleaf;
+  unsigned long long xcr0;
+  bool               fma;
+
+  glm__cpuid(0, 0, r);
+  maxleaf = r[0];
+
+  glm__cpuid(1, 0, r);
+  if (!(r[3] & (1u << 26)))                         /* SSE2 */
+    return GLM_ISA_GENERIC;
+
+  /* AVX needs OS support for saving YMM state: OSXSAVE + XCR0 bits 1, 2 */
+  if (!(r[2] & (1u << 27)) || !(r[2] & (1u << 28)))
+    return GLM_ISA_SSE2;
+
+  xcr0 = glm__xgetbv();
+  if ((xcr0 & 0x6) != 0x6)
+    return GLM_ISA_SSE2;
+
+  fma = (r[2] & (1u << 12)) != 0;
+  if (maxleaf < 7)
+    return GLM_ISA_AVX;
+
+  glm__cpuid(7, 0, r);
+  if (!fma || !(r[1] & (1u << 5)))                  /* AVX2 */
+    return GLM_ISA_AVX;
+
+  /* AVX-512 also needs opmask and ZMM state: XCR0 bits 5, 6, 7 */
+  if ((r[1] & (1u << 16)) && (xcr0 & 0xE6) == 0xE6) /* AVX512F */
+    return GLM_ISA_AVX512;
+
+  return GLM_ISA_AVX2;
+#else
+  return GLM_ISA_GENERIC;
+#endif
+}
+
+CGLM_EXPORT
+glm_isa
+glm_dispatch_init(void) {
+  const glm_dispatch_table *t;
+
+  switch (glm_cpu_isa()) {
+#ifdef CGLM_DISPATCH_X86
+    case GLM_ISA_AVX512: t = &glm_dispatch_avx512;  break;
+    case GLM_ISA_AVX2:   t = &glm_dispatch_avx2;    break;
+    case GLM_ISA_AVX:    t = &glm_dispatch_avx;     break;
+#endif
+    default:             t = &glm_dispatch_generic; break;
+  }
+
+  /* every field is valid on its own, racing first calls resolve the same */
+  glm_dispatch.mat4_mul             = t->mat4_mul;
+  glm_dispatch.mat4_inv             = t->mat4_inv;
+  glm_dispatch.quat_mul             = t->quat_mul;
+  glm_dispatch.mat4_mul_batch       = t->mat4_mul_batch;
+  glm_dispatch.mat4_mulv_batch      = t->mat4_mulv_batch;
+  glm_dispatch.mat4_mulv3_batch     = t->mat4_mulv3_batch;
+  glm_dispatch.mat4_inv_batch       = t->mat4_inv_batch;
+  glm_dispatch.aabb_frustum_soa     = t->aabb_frustum_soa;
+  glm_dispatch.sphere_frustum_soa   = t->sphere_frustum_soa;
+  glm_dispatch.aabb_transform_soa   = t->aabb_transform_soa;
+  glm_dispatch.sphere_transform_soa = t->sphere_transform_soa;
+  glm_dispatch.isa                  = t->isa;
+
+  return t->isa;
+}
+
+/* initial table: resolve, then forward */
+
+static void glm__resolve_mat4_mul(mat4 m1, mat4 m2, mat4 dest) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_mul(m1, m2, dest);
+}
+
+static void glm__resolve_mat4_inv(mat4 mat, mat4 dest) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_inv(mat, dest);
+}
+
+static void glm__resolve_quat_mul(versor p, versor q, versor dest) {
+  glm_dispatch_init();
+  glm_dispatch.quat_mul(p, q, dest);
+}
+
+static void glm__resolve_mat4_mul_batch(mat4 *m1, mat4 *m2, mat4 *dest,
+                                        size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_mul_batch(m1, m2, dest, count);
+}
+
+static void glm__resolve_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest,
+                                         size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_mulv_batch(m, v, dest, count);
+}
+
+static void glm__resolve_mat4_mulv3_batch(mat4 m, vec3 *v, float last,
+                                          vec3 *dest, size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_mulv3_batch(m, v, last, dest, count);
+}
+
+static void glm__resolve_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.mat4_inv_batch(mat, dest, count);
+}
+
+static size_t glm__resolve_aabb_frustum_soa(const float *bounds, size_t stride,
+                                            size_t first, size_t count,
+                                            vec4 planes[6],
+                                            uint32_t *visible) {
+  glm_dispatch_init();
+  return glm_dispatch.aabb_frustum_soa(bounds, stride, first, count, planes,
+                                       visible);
+}
+
+static size_t glm__resolve_sphere_frustum_soa(const float *spheres,
+                                              size_t stride, size_t first,
+                                              size_t count, vec4 planes[6],
+                                              uint32_t *visible) {
+  glm_dispatch_init();
+  return glm_dispatch.sphere_frustum_soa(spheres, stride, first, count,
+                                         planes, visible);
+}
+
+static void glm__resolve_aabb_transform_soa(const float *src, size_t stride,
+                                            mat4 *m, float *dest,
+                                            size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.aabb_transform_soa(src, stride, m, dest, count);
+}
+
+static void glm__resolve_sphere_transform_soa(const float *src, size_t stride,
+                                              mat4 *m, float *dest,
+                                              size_t count) {
+  glm_dispatch_init();
+  glm_dispatch.sphere_transform_soa(src, stride, m, dest, count);
+}
+
+glm_dispatch_table glm_dispatch = {
+  glm__resolve_mat4_mul,
+  glm__resolve_mat4_inv,
+  glm__resolve_quat_mul,
+  glm__resolve_mat4_mul_batch,
+  glm__resolve_mat4_mulv_batch,
+  glm__resolve_mat4_mulv3_batch,
+  glm__resolve_mat4_inv_batch,
+  glm__resolve_aabb_frustum_soa,
+  glm__resolve_sphere_frustum_soa,
+  glm__resolve_aabb_transform_soa,
+  glm__resolve_sphere_transform_soa,
+  GLM_ISA_GENERIC
+};
+
+#endif /* CGLM_DISPATCH_IMPLEMENTATION */
+#endif /* cglm_dispatch_h */
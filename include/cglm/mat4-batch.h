@@ -0,0 +1,360 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief mat4 functions that work on many matrices / vectors at once
+ *
+ * Array (AoS) versions take plain mat4 / vec4 / vec3 arrays. SoA versions
+ * take planar storage: element [col][row] of matrix i is stored at
+ * src[(col * 4 + row) * stride + i] and component k of vector i is stored at
+ * src[k * stride + i], so wide SIMD lanes hold one matrix each and no
+ * shuffles are needed at all. stride must be >= count.
+ *
+ * Wide kernels are picked at compile time like the rest of cglm, otherwise
+ * the single matrix functions are called in a loop. The SoA functions, the
+ * inverse and mulv3 take 8 matrices or vectors per iteration with AVX /
+ * AVX2 + FMA and the SoA mul and mulv3 take 16 with AVX-512. mul handles one
+ * matrix per iteration and mulv 2 (AVX) or 4 (AVX-512) vectors, with m1's
+ * columns or m broadcast to every 128-bit lane. Destination may be same as
+ * source. With CGLM_RUNTIME_DISPATCH the AoS functions go through glm_dispatch.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE void glm_mat4_mul_batch(mat4 *m1, mat4 *m2, mat4 *dest,
+                                       size_t count);
+   CGLM_INLINE void glm_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest,
+                                        size_t count);
+   CGLM_INLINE void glm_mat4_mulv3_batch(mat4 m, vec3 *v, float last,
+                                         vec3 *dest, size_t count);
+   CGLM_INLINE void glm_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count);
+   CGLM_INLINE void glm_mat4_soa_get(const float *src, size_t stride,
+                                     size_t index, mat4 dest);
+   CGLM_INLINE void glm_mat4_soa_set(mat4 m, float *dest, size_t stride,
+                                     size_t index);
+   CGLM_INLINE void glm_mat4_mul_soa(const float *m1, const float *m2,
+                                     float *dest, size_t stride, size_t count);
+   CGLM_INLINE void glm_mat4_mulv3_soa(mat4 m, const float *v, float last,
+                                       float *dest, size_t stride,
+                                       size_t count);
+   CGLM_INLINE void glm_mat4_inv_soa(const float *mat, float *dest,
+                                     size_t stride, size_t count);
+   CGLM_INLINE void glm_rotate_make_batch(const float *angle, vec3 *axis,
+                                          mat4 *dest, size_t count);
+ */
+
+#ifndef cglm_mat4_batch_h
+#define cglm_mat4_batch_h
+
+#include "common.h"
+#include "vec3.h"
+#include "mat4.h"
+#include "sincos.h"
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/mat4-batch.h"
+#endif
+
+#ifdef CGLM_AVX512_FP
+#  include "simd/avx512/mat4-batch.h"
+#endif
+
+/*!
+ * @brief multiply each m1[i] with m2[i]: dest[i] = m1[i] * m2[i]
+ *
+ * One matrix per iteration: transposing 8 matrices to SoA registers and
+ * back costs more than the product itself, about 3x slower than
+ * broadcasting m1's columns.
+ *
+ * @param[in]  m1    left matrices
+ * @param[in]  m2    right matrices
+ * @param[out] dest  destination matrices, may be m1 or m2
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_mul_batch(mat4 *m1, mat4 *m2, mat4 *dest, size_t count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_mul_batch(m1, m2, dest, count);
+#elif defined(__AVX512F__)
+  glm_mat4_mul_batch_avx512(m1, m2, dest, count);
+#elif defined(__AVX__)
+  glm_mat4_mul_batch_avx(m1, m2, dest, count);
+#else
+  size_t i;
+  for (i = 0; i < count; i++)
+    glm_mat4_mul(m1[i], m2[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief multiply many vec4 with the same matrix: dest[i] = m * v[i]
+ *
+ * @param[in]  m     matrix
+ * @param[in]  v     vectors
+ * @param[out] dest  destination vectors, may be v
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_mulv_batch(m, v, dest, count);
+#else
+  size_t i;
+
+#if defined(__AVX512F__)
+  i = glm_mat4_mulv_batch_avx512(m, v, dest, count);
+#elif defined(__AVX__)
+  i = glm_mat4_mulv_batch_avx(m, v, dest, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++)
+    glm_mat4_mulv(m, v[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief multiply many vec3 with the same matrix, see glm_mat4_mulv3
+ *
+ * @param[in]  m     matrix
+ * @param[in]  v     vectors
+ * @param[in]  last  4th item to make each vector vec4 (1 point, 0 direction)
+ * @param[out] dest  destination vectors, may be v
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_mulv3_batch(m, v, last, dest, count);
+#else
+  size_t i;
+
+#if defined(__AVX__)
+  i = glm_mat4_mulv3_batch_avx(m, v, last, dest, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++)
+    glm_mat4_mulv3(m, v[i], last, dest[i]);
+#endif
+}
+
+/*!
+ * @brief inverse each matrix: dest[i] = inverse(mat[i])
+ *
+ * @param[in]  mat   matrices
+ * @param[out] dest  inverse matrices, may be mat
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_inv_batch(mat, dest, count);
+#else
+  size_t i;
+
+#if defined(__AVX__)
+  i = glm_mat4_inv_batch_avx(mat, dest, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++)
+    glm_mat4_inv(mat[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief copy matrix [index] out of SoA storage
+ *
+ * @param[in]  src    SoA matrices
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  matrix index
+ * @param[out] dest   matrix
+ */
+CGLM_INLINE
+void
+glm_mat4_soa_get(const float *src, size_t stride, size_t index, mat4 dest) {
+  int c;
+  for (c = 0; c < 16; c++)
+    dest[c >> 2][c & 3] = src[c * stride + index];
+}
+
+/*!
+ * @brief copy matrix into slot [index] of SoA storage
+ *
+ * @param[in]  m      matrix
+ * @param[out] dest   SoA matrices
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  matrix index
+ */
+CGLM_INLINE
+void
+glm_mat4_soa_set(mat4 m, float *dest, size_t stride, size_t index) {
+  int c;
+  for (c = 0; c < 16; c++)
+    dest[c * stride + index] = m[c >> 2][c & 3];
+}
+
+/*!
+ * @brief SoA version of glm_mat4_mul_batch
+ *
+ * @param[in]  m1     left SoA matrices
+ * @param[in]  m2     right SoA matrices
+ * @param[out] dest   destination SoA matrices, may be m1 or m2
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_mul_soa(const float *m1,
+                 const float *m2,
+                 float       *dest,
+                 size_t       stride,
+                 size_t       count) {
+  mat4   a, b;
+  size_t i;
+
+#if defined(__AVX512F__)
+  i = glm_mat4_mul_soa_avx512(m1, m2, dest, stride, count);
+#elif defined(__AVX__)
+  i = glm_mat4_mul_soa_avx(m1, m2, dest, stride, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++) {
+    glm_mat4_soa_get(m1, stride, i, a);
+    glm_mat4_soa_get(m2, stride, i, b);
+    glm_mat4_mul(a, b, a);
+    glm_mat4_soa_set(a, dest, stride, i);
+  }
+}
+
+/*!
+ * @brief SoA version of glm_mat4_mulv3_batch, 3 planes (x, y, z)
+ *
+ * @param[in]  m      matrix
+ * @param[in]  v      SoA vectors
+ * @param[in]  last   4th item to make each vector vec4 (1 point, 0 direction)
+ * @param[out] dest   destination SoA vectors, may be v
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv3_soa(mat4         m,
+                   const float *v,
+                   float        last,
+                   float       *dest,
+                   size_t       stride,
+                   size_t       count) {
+  float  x, y, z;
+  size_t i;
+
+#if defined(__AVX512F__)
+  i = glm_mat4_mulv3_soa_avx512(m, v, last, dest, stride, count);
+#elif defined(__AVX__)
+  i = glm_mat4_mulv3_soa_avx(m, v, last, dest, stride, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++) {
+    x = v[i];
+    y = v[stride + i];
+    z = v[2 * stride + i];
+
+    dest[i]              = m[0][0] * x + m[1][0] * y + m[2][0] * z
+                         + m[3][0] * last;
+    dest[stride + i]     = m[0][1] * x + m[1][1] * y + m[2][1] * z
+                         + m[3][1] * last;
+    dest[2 * stride + i] = m[0][2] * x + m[1][2] * y + m[2][2] * z
+                         + m[3][2] * last;
+  }
+}
+
+/*!
+ * @brief SoA version of glm_mat4_inv_batch
+ *
+ * @param[in]  mat    SoA matrices
+ * @param[out] dest   SoA inverse matrices, may be mat
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_inv_soa(const float *mat, float *dest, size_t stride, size_t count) {
+  mat4   m;
+  size_t i;
+
+#if defined(__AVX__)
+  i = glm_mat4_inv_soa_avx(mat, dest, stride, count);
+#else
+  i = 0;
+#endif
+
+  for (; i < count; i++) {
+    glm_mat4_soa_get(mat, stride, i, m);
+    glm_mat4_inv(m, m);
+    glm_mat4_soa_set(m, dest, stride, i);
+  }
+}
+
+/*!
+ * @brief rotation matrices from angle / axis pairs, see glm_rotate_make
+ *
+ * sin / cos of all angles are computed with glm_sincos_batch first
+ *
+ * @param[in]  angle angles in radians
+ * @param[in]  axis  rotation axes (will be normalized)
+ * @param[out] dest  rotation matrices
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_rotate_make_batch(const float *angle, vec3 *axis, mat4 *dest, size_t count) {
+  CGLM_ALIGN(16) float s[64], c[64];
+  CGLM_ALIGN(8)  vec3  axisn, v, vs;
+  vec4  *m;
+  size_t i, j, n;
+
+  for (i = 0; i < count; i += n) {
+    n = count - i < 64 ? count - i : 64;
+    glm__sincos_batch_default(angle + i, s, c, n);
+
+    for (j = 0; j < n; j++) {
+      m = dest[i + j];
+
+      glm_vec3_normalize_to(axis[i + j], axisn);
+      glm_vec3_scale(axisn, 1.0f - c[j], v);
+      glm_vec3_scale(axisn, s[j], vs);
+
+      m[0][0] = axisn[0] * v[0] + c[j];
+      m[0][1] = axisn[1] * v[0] + vs[2];
+      m[0][2] = axisn[2] * v[0] - vs[1];
+      m[1][0] = axisn[0] * v[1] - vs[2];
+      m[1][1] = axisn[1] * v[1] + c[j];
+      m[1][2] = axisn[2] * v[1] + vs[0];
+      m[2][0] = axisn[0] * v[2] + vs[1];
+      m[2][1] = axisn[1] * v[2] - vs[0];
+      m[2][2] = axisn[2] * v[2] + c[j];
+
+      m[0][3] = m[1][3] = m[2][3] = 0.0f;
+      m[3][0] = m[3][1] = m[3][2] = 0.0f;
+      m[3][3] = 1.0f;
+    }
+  }
+}
+
+#endif /* cglm_mat4_batch_h */
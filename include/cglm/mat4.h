@@ -70,6 +70,10 @@
 #  include "simd/wasm/mat4.h"
 #endif
 
+#ifdef CGLM_RUNTIME_DISPATCH
+#  include "dispatch.h"
+#endif
+
 #ifndef NDEBUG
 # include <assert.h>
 #endif
@@ -315,7 +319,9 @@ glm_mat4_ins3(mat3 mat, mat4 dest) {
 CGLM_INLINE
 void
 glm_mat4_mul(mat4 m1, mat4 m2, mat4 dest) {
-#if defined(__wasm__) && defined(__wasm_simd128__)
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_mul(m1, m2, dest);
+#elif defined(__wasm__) && defined(__wasm_simd128__)
   glm_mat4_mul_wasm(m1, m2, dest);
 #elif defined(__AVX__)
   glm_mat4_mul_avx(m1, m2, dest);
@@ -521,6 +527,8 @@ void
 glm_mat4_transpose_to(mat4 m, mat4 dest) {
 #if defined(__wasm__) && defined(__wasm_simd128__)
   glm_mat4_transp_wasm(m, dest);
+#elif defined(__AVX2__)
+  glm_mat4_transp_avx(m, dest);
 #elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_mat4_transp_sse2(m, dest);
 #elif defined(CGLM_NEON_FP)
@@ -547,6 +555,8 @@ void
 glm_mat4_transpose(mat4 m) {
 #if defined(__wasm__) && defined(__wasm_simd128__)
   glm_mat4_transp_wasm(m, m);
+#elif defined(__AVX2__)
+  glm_mat4_transp_avx(m, m);
 #elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_mat4_transp_sse2(m, m);
 #elif defined(CGLM_NEON_FP)
@@ -646,7 +656,11 @@ glm_mat4_det(mat4 mat) {
 CGLM_INLINE
 void
 glm_mat4_inv(mat4 mat, mat4 dest) {
-#if defined( __SSE__ ) || defined( __SSE2__ )
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.mat4_inv(mat, dest);
+#elif defined(__AVX__)
+  glm_mat4_inv_avx(mat, dest);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_mat4_inv_sse2(mat, dest);
 #elif defined(CGLM_NEON_FP)
   glm_mat4_inv_neon(mat, dest);
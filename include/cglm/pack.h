@@ -0,0 +1,495 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief compact transform formats for GPU upload
+ *
+ * 3x4:    upper three rows of an affine mat4, stored as mat3x4 (48 bytes).
+ *         dest[r] is row r, so in GLSL `vec4(p, 1.0) * m` with an
+ *         `in mat3x4 m` attribute gives the transformed point.
+ * qts:    rotation quaternion, translation and uniform scale as two vec4
+ *         (32 bytes): dest[0] = quaternion, dest[1] = (translation, scale).
+ *         Scale is taken from the length of the first column, the matrix is
+ *         expected to be rotation * uniform scale (no mirroring, no shear).
+ * snorm16 rotations: quaternion as four shorts (8 bytes), decoded as
+ *         max(s / 32767, -1), which normalized GL_SHORT attributes do on
+ *         GL 4.2+. Normalize after decoding, older GL decodes slightly off.
+ *
+ * The unpack functions accept quaternions which are not unit, e.g. decoded
+ * snorm16 ones.
+ *
+ * Vertex attribute formats:
+ * half:   IEEE 754 binary16, rounded to nearest even, for GL_HALF_FLOAT.
+ * unorm8: [0, 1] as bytes, e.g. colors as normalized GL_UNSIGNED_BYTE.
+ * oct snorm16: unit vector folded onto an octahedron and stored as two
+ *         snorm16 (4 bytes), decoded in the shader. Error stays below
+ *         0.05 degrees.
+ * unorm16 quantized: point inside a box as three unorm16, the box is
+ *         applied again as scale and offset when decoding.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE void glm_mat4_pack3x4(mat4 m, mat3x4 dest);
+   CGLM_INLINE void glm_mat4_unpack3x4(mat3x4 src, mat4 dest);
+   CGLM_INLINE void glm_mat4_pack3x4_batch(mat4 *m, mat3x4 *dest,
+                                           size_t count);
+   CGLM_INLINE void glm_mat4_unpack3x4_batch(mat3x4 *src, mat4 *dest,
+                                             size_t count);
+   CGLM_INLINE void glm_mat4_pack_qts(mat4 m, vec4 dest[2]);
+   CGLM_INLINE void glm_mat4_unpack_qts(vec4 src[2], mat4 dest);
+   CGLM_INLINE void glm_mat4_pack_qts_batch(mat4 *m, vec4 *dest,
+                                            size_t count);
+   CGLM_INLINE void glm_mat4_unpack_qts_batch(vec4 *src, mat4 *dest,
+                                              size_t count);
+   CGLM_INLINE void glm_quat_pack_snorm16(versor q, int16_t dest[4]);
+   CGLM_INLINE void glm_quat_unpack_snorm16(const int16_t src[4],
+                                            versor dest);
+   CGLM_INLINE void glm_quat_pack_snorm16_batch(versor *q, int16_t *dest,
+                                                size_t count);
+   CGLM_INLINE void glm_quat_unpack_snorm16_batch(const int16_t *src,
+                                                  versor *dest,
+                                                  size_t count);
+   CGLM_INLINE uint16_t glm_pack_half(float f);
+   CGLM_INLINE float glm_unpack_half(uint16_t h);
+   CGLM_INLINE void glm_vec4_pack_unorm8(vec4 v, uint8_t dest[4]);
+   CGLM_INLINE void glm_vec3_pack_oct_snorm16(vec3 n, int16_t dest[2]);
+   CGLM_INLINE void glm_vec3_unpack_oct_snorm16(const int16_t src[2],
+                                                vec3 dest);
+   CGLM_INLINE void glm_vec3_quantize_unorm16(vec3 v, vec3 box[2],
+                                              uint16_t dest[3]);
+   CGLM_INLINE void glm_vec3_dequantize_unorm16(const uint16_t src[3],
+                                                vec3 box[2], vec3 dest);
+ */
+
+#ifndef cglm_pack_h
+#define cglm_pack_h
+
+#include "common.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "quat.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/pack.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/pack.h"
+#endif
+
+/*!
+ * @brief pack affine matrix to 3x4 (rows), the last row is dropped
+ *
+ * @param[in]  m    affine matrix
+ * @param[out] dest rows 0, 1, 2 of m
+ */
+CGLM_INLINE
+void
+glm_mat4_pack3x4(mat4 m, mat3x4 dest) {
+  int r;
+
+  for (r = 0; r < 3; r++) {
+    dest[r][0] = m[0][r];
+    dest[r][1] = m[1][r];
+    dest[r][2] = m[2][r];
+    dest[r][3] = m[3][r];
+  }
+}
+
+/*!
+ * @brief unpack 3x4 (rows) to affine matrix, last row is 0, 0, 0, 1
+ *
+ * @param[in]  src  rows 0, 1, 2
+ * @param[out] dest affine matrix
+ */
+CGLM_INLINE
+void
+glm_mat4_unpack3x4(mat3x4 src, mat4 dest) {
+  int c;
+
+  for (c = 0; c < 4; c++) {
+    dest[c][0] = src[0][c];
+    dest[c][1] = src[1][c];
+    dest[c][2] = src[2][c];
+    dest[c][3] = 0.0f;
+  }
+
+  dest[3][3] = 1.0f;
+}
+
+/*!
+ * @brief glm_mat4_pack3x4 for many matrices
+ *
+ * @param[in]  m     affine matrices
+ * @param[out] dest  packed matrices
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_pack3x4_batch(mat4 *m, mat3x4 *dest, size_t count) {
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_pack3x4_batch_sse2(m, dest, count);
+#else
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    glm_mat4_pack3x4(m[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief glm_mat4_unpack3x4 for many matrices
+ *
+ * @param[in]  src   packed matrices
+ * @param[out] dest  affine matrices
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_unpack3x4_batch(mat3x4 *src, mat4 *dest, size_t count) {
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_unpack3x4_batch_sse2(src, dest, count);
+#else
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    glm_mat4_unpack3x4(src[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief pack rotation * uniform scale + translation matrix to quaternion,
+ *        translation and scale
+ *
+ * @param[in]  m    transform matrix
+ * @param[out] dest quaternion, then translation and scale (w)
+ */
+CGLM_INLINE
+void
+glm_mat4_pack_qts(mat4 m, vec4 dest[2]) {
+  mat4  r;
+  float s, is;
+
+  s  = glm_vec3_norm(m[0]);
+  is = s > 0.0f ? 1.0f / s : 0.0f;
+
+  glm_vec3_scale(m[0], is, r[0]);
+  glm_vec3_scale(m[1], is, r[1]);
+  glm_vec3_scale(m[2], is, r[2]);
+  glm_mat4_quat(r, dest[0]);
+
+  glm_vec3_copy(m[3], dest[1]);
+  dest[1][3] = s;
+}
+
+/*!
+ * @brief unpack quaternion, translation and scale to matrix
+ *
+ * @param[in]  src  quaternion, then translation and scale (w)
+ * @param[out] dest transform matrix
+ */
+CGLM_INLINE
+void
+glm_mat4_unpack_qts(vec4 src[2], mat4 dest) {
+  CGLM_ALIGN(16) versor q;
+
+  glm_quat_normalize_to(src[0], q);
+  glm_quat_mat4(q, dest);
+  glm_mat4_scale_p(dest, src[1][3]);
+  glm_vec3_copy(src[1], dest[3]);
+  dest[3][3] = 1.0f;
+}
+
+/*!
+ * @brief glm_mat4_pack_qts for many matrices
+ *
+ * @param[in]  m     transform matrices
+ * @param[out] dest  2 * count vec4, two for each matrix
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_pack_qts_batch(mat4 *m, vec4 *dest, size_t count) {
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX__)
+  i = glm_mat4_pack_qts_batch_avx(m, dest, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_mat4_pack_qts_batch_sse2(m + i, dest + 2 * i, count - i);
+#endif
+
+  for (; i < count; i++)
+    glm_mat4_pack_qts(m[i], dest + 2 * i);
+}
+
+/*!
+ * @brief glm_mat4_unpack_qts for many matrices
+ *
+ * @param[in]  src   2 * count vec4, two for each matrix
+ * @param[out] dest  transform matrices
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_unpack_qts_batch(vec4 *src, mat4 *dest, size_t count) {
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX__)
+  i = glm_mat4_unpack_qts_batch_avx(src, dest, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_mat4_unpack_qts_batch_sse2(src + 2 * i, dest + i, count - i);
+#endif
+
+  for (; i < count; i++)
+    glm_mat4_unpack_qts(src + 2 * i, dest[i]);
+}
+
+/*!
+ * @brief pack quaternion to snorm16, components are clamped to [-1, 1]
+ *
+ * @param[in]  q    quaternion
+ * @param[out] dest packed quaternion
+ */
+CGLM_INLINE
+void
+glm_quat_pack_snorm16(versor q, int16_t dest[4]) {
+  int k;
+
+  for (k = 0; k < 4; k++)
+    dest[k] = (int16_t)lrintf(glm_clamp(q[k], -1.0f, 1.0f) * 32767.0f);
+}
+
+/*!
+ * @brief unpack snorm16 quaternion, result is not normalized
+ *
+ * @param[in]  src  packed quaternion
+ * @param[out] dest quaternion
+ */
+CGLM_INLINE
+void
+glm_quat_unpack_snorm16(const int16_t src[4], versor dest) {
+  int k;
+
+  for (k = 0; k < 4; k++)
+    dest[k] = glm_max(src[k] * (1.0f / 32767.0f), -1.0f);
+}
+
+/*!
+ * @brief glm_quat_pack_snorm16 for many quaternions
+ *
+ * @param[in]  q     quaternions
+ * @param[out] dest  4 * count shorts
+ * @param[in]  count number of quaternions
+ */
+CGLM_INLINE
+void
+glm_quat_pack_snorm16_batch(versor *q, int16_t *dest, size_t count) {
+  size_t i;
+
+  i = 0;
+
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i = glm_quat_pack_snorm16_batch_sse2(q, dest, count);
+#endif
+
+  for (; i < count; i++)
+    glm_quat_pack_snorm16(q[i], dest + 4 * i);
+}
+
+/*!
+ * @brief glm_quat_unpack_snorm16 for many quaternions
+ *
+ * @param[in]  src   4 * count shorts
+ * @param[out] dest  quaternions
+ * @param[in]  count number of quaternions
+ */
+CGLM_INLINE
+void
+glm_quat_unpack_snorm16_batch(const int16_t *src, versor *dest,
+                              size_t count) {
+  size_t i;
+
+  i = 0;
+
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i = glm_quat_unpack_snorm16_batch_sse2(src, dest, count);
+#endif
+
+  for (; i < count; i++)
+    glm_quat_unpack_snorm16(src + 4 * i, dest[i]);
+}
+
+/*!
+ * @brief float to half float, round to nearest even. Out of range values
+ *        become infinity, NaN stays NaN
+ *
+ * @param[in]  f    value
+ *
+ * @return binary16 bits
+ */
+CGLM_INLINE
+uint16_t
+glm_pack_half(float f) {
+  union { float f; uint32_t u; } v, magic;
+  uint32_t sign;
+  uint16_t h;
+
+  v.f   = f;
+  sign  = v.u & 0x80000000u;
+  v.u  ^= sign;
+
+  if (v.u >= 0x47800000u) {
+    /* 65520 and up round to infinity, exponent 255 is inf or NaN */
+    h = v.u > 0x7f800000u ? 0x7e00 : 0x7c00;
+  } else if (v.u < 0x38800000u) {
+    /* below the smallest normal half: let the fpu round the denormal */
+    magic.u = 0x3f000000u;
+    v.f    += magic.f;
+    h       = (uint16_t)(v.u - magic.u);
+  } else {
+    /* rebias the exponent and round the 13 dropped mantissa bits */
+    v.u += ((uint32_t)(15 - 127) << 23) + 0xfff + ((v.u >> 13) & 1);
+    h    = (uint16_t)(v.u >> 13);
+  }
+
+  return h | (uint16_t)(sign >> 16);
+}
+
+/*!
+ * @brief half float to float, exact
+ *
+ * @param[in]  h    binary16 bits
+ *
+ * @return value
+ */
+CGLM_INLINE
+float
+glm_unpack_half(uint16_t h) {
+  union { float f; uint32_t u; } v;
+  uint32_t exp, mant;
+
+  exp  = (h >> 10) & 0x1f;
+  mant = h & 0x3ffu;
+
+  if (exp == 0) {
+    v.f = ldexpf((float)mant, -24);
+    return h & 0x8000 ? -v.f : v.f;
+  }
+
+  exp = exp == 31 ? 255 : exp + 127 - 15;
+  v.u = (uint32_t)(h & 0x8000) << 16 | exp << 23 | mant << 13;
+  return v.f;
+}
+
+/*!
+ * @brief pack vec4 to unorm8, components are clamped to [0, 1]
+ *
+ * @param[in]  v    vector, e.g. rgba color
+ * @param[out] dest packed vector
+ */
+CGLM_INLINE
+void
+glm_vec4_pack_unorm8(vec4 v, uint8_t dest[4]) {
+  int k;
+
+  for (k = 0; k < 4; k++)
+    dest[k] = (uint8_t)lrintf(glm_clamp(v[k], 0.0f, 1.0f) * 255.0f);
+}
+
+/*!
+ * @brief pack direction to octahedral snorm16, n need not be normalized
+ *
+ * @param[in]  n    direction, zero packs to +z
+ * @param[out] dest packed direction
+ */
+CGLM_INLINE
+void
+glm_vec3_pack_oct_snorm16(vec3 n, int16_t dest[2]) {
+  float l1, x, y, fx;
+
+  l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+  x  = l1 > 0.0f ? n[0] / l1 : 0.0f;
+  y  = l1 > 0.0f ? n[1] / l1 : 0.0f;
+
+  /* fold the lower half over the diagonals */
+  if (n[2] < 0.0f) {
+    fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+    y  = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    x  = fx;
+  }
+
+  dest[0] = (int16_t)lrintf(glm_clamp(x, -1.0f, 1.0f) * 32767.0f);
+  dest[1] = (int16_t)lrintf(glm_clamp(y, -1.0f, 1.0f) * 32767.0f);
+}
+
+/*!
+ * @brief unpack octahedral snorm16 direction, the result is normalized
+ *
+ * @param[in]  src  packed direction
+ * @param[out] dest unit vector
+ */
+CGLM_INLINE
+void
+glm_vec3_unpack_oct_snorm16(const int16_t src[2], vec3 dest) {
+  float t;
+
+  dest[0] = glm_max(src[0] * (1.0f / 32767.0f), -1.0f);
+  dest[1] = glm_max(src[1] * (1.0f / 32767.0f), -1.0f);
+  dest[2] = 1.0f - fabsf(dest[0]) - fabsf(dest[1]);
+
+  t        = glm_max(-dest[2], 0.0f);
+  dest[0] += dest[0] >= 0.0f ? -t : t;
+  dest[1] += dest[1] >= 0.0f ? -t : t;
+
+  glm_vec3_normalize(dest);
+}
+
+/*!
+ * @brief quantize a point inside box to unorm16, outside points are clamped
+ *
+ * @param[in]  v    point
+ * @param[in]  box  bounding box, min and max
+ * @param[out] dest packed point
+ */
+CGLM_INLINE
+void
+glm_vec3_quantize_unorm16(vec3 v, vec3 box[2], uint16_t dest[3]) {
+  float extent, t;
+  int   k;
+
+  for (k = 0; k < 3; k++) {
+    extent  = box[1][k] - box[0][k];
+    t       = extent > 0.0f ? (v[k] - box[0][k]) / extent : 0.0f;
+    dest[k] = (uint16_t)lrintf(glm_clamp(t, 0.0f, 1.0f) * 65535.0f);
+  }
+}
+
+/*!
+ * @brief dequantize a glm_vec3_quantize_unorm16 point, the same as
+ *        box[0] + src / 65535 * (box[1] - box[0]) in a shader
+ *
+ * @param[in]  src  packed point
+ * @param[in]  box  bounding box it was quantized in
+ * @param[out] dest point
+ */
+CGLM_INLINE
+void
+glm_vec3_dequantize_unorm16(const uint16_t src[3], vec3 box[2], vec3 dest) {
+  int k;
+
+  for (k = 0; k < 3; k++)
+    dest[k] = box[0][k] + src[k] * (1.0f / 65535.0f) * (box[1][k] - box[0][k]);
+}
+
+#endif /* cglm_pack_h */
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief quaternion functions that work on many quaternions at once
+ *
+ * SoA versions take planar storage: component k (x y z w) of quaternion i
+ * is stored at src[k * stride + i], stride must be >= count. AVX2 handles
+ * 8 quaternions and SSE2 4 per step, the rest goes through the single
+ * quaternion functions. Destination may be same as source.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE void glm_euler_xyz_quat_batch(vec3 *angles, versor *dest,
+                                             size_t count);
+   CGLM_INLINE void glm_quat_soa_get(const float *src, size_t stride,
+                                     size_t index, versor dest);
+   CGLM_INLINE void glm_quat_soa_set(versor q, float *dest, size_t stride,
+                                     size_t index);
+   CGLM_INLINE void glm_quat_slerp_soa(const float *from, const float *to,
+                                       const float *t, float *dest,
+                                       size_t stride, size_t count);
+   CGLM_INLINE void glm_quat_nlerp_soa(const float *from, const float *to,
+                                       const float *t, float *dest,
+                                       size_t stride, size_t count);
+   CGLM_INLINE void glm_quat_mat4_soa(const float *q, size_t stride,
+                                      mat4 *dest, size_t count);
+ */
+
+#ifndef cglm_quat_batch_h
+#define cglm_quat_batch_h
+
+#include "common.h"
+#include "quat.h"
+#include "sincos.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/quat-batch.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/quat-batch.h"
+#endif
+
+/*!
+ * @brief quaternions from euler angles, see glm_euler_xyz_quat
+ *
+ * sin / cos of all half angles are computed with glm_sincos_batch first
+ *
+ * @param[in]  angles angles x y z (radians)
+ * @param[out] dest   quaternions
+ * @param[in]  count  number of quaternions
+ */
+CGLM_INLINE
+void
+glm_euler_xyz_quat_batch(vec3 *angles, versor *dest, size_t count) {
+  CGLM_ALIGN(16) float h[96], s[96], c[96];
+  const float *a;
+  float  xs, ys, zs, xc, yc, zc;
+  size_t i, j, n;
+
+  for (i = 0; i < count; i += n) {
+    n = count - i < 32 ? count - i : 32;
+    a = angles[i];
+
+    for (j = 0; j < n * 3; j++)
+      h[j] = a[j] * 0.5f;
+
+    glm__sincos_batch_default(h, s, c, n * 3);
+
+    for (j = 0; j < n; j++) {
+      xs = s[j * 3];     xc = c[j * 3];
+      ys = s[j * 3 + 1]; yc = c[j * 3 + 1];
+      zs = s[j * 3 + 2]; zc = c[j * 3 + 2];
+
+#ifdef CGLM_FORCE_LEFT_HANDED
+      zs = -zs;
+#endif
+
+      dest[i + j][0] = xc * ys * zs + xs * yc * zc;
+      dest[i + j][1] = xc * ys * zc - xs * yc * zs;
+      dest[i + j][2] = xc * yc * zs + xs * ys * zc;
+      dest[i + j][3] = xc * yc * zc - xs * ys * zs;
+    }
+  }
+}
+
+/*!
+ * @brief copy quaternion [index] out of SoA storage
+ *
+ * @param[in]  src    SoA quaternions
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  quaternion index
+ * @param[out] dest   quaternion
+ */
+CGLM_INLINE
+void
+glm_quat_soa_get(const float *src, size_t stride, size_t index, versor dest) {
+  dest[0] = src[index];
+  dest[1] = src[stride + index];
+  dest[2] = src[2 * stride + index];
+  dest[3] = src[3 * stride + index];
+}
+
+/*!
+ * @brief copy quaternion into slot [index] of SoA storage
+ *
+ * @param[in]  q      quaternion
+ * @param[out] dest   SoA quaternions
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  index  quaternion index
+ */
+CGLM_INLINE
+void
+glm_quat_soa_set(versor q, float *dest, size_t stride, size_t index) {
+  dest[index]              = q[0];
+  dest[stride + index]     = q[1];
+  dest[2 * stride + index] = q[2];
+  dest[3 * stride + index] = q[3];
+}
+
+/*!
+ * @brief SoA version of glm_quat_slerp: dest[i] = slerp(from[i], to[i], t[i])
+ *
+ * @param[in]  from   SoA quaternions
+ * @param[in]  to     SoA quaternions
+ * @param[in]  t      interpolant (amount) for each pair
+ * @param[out] dest   SoA result quaternions, may be from or to
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of quaternions
+ */
+CGLM_INLINE
+void
+glm_quat_slerp_soa(const float *from,
+                   const float *to,
+                   const float *t,
+                   float       *dest,
+                   size_t       stride,
+                   size_t       count) {
+  CGLM_ALIGN(16) versor a, b;
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX2__)
+  i = glm_quat_slerp_soa_avx(from, to, t, dest, stride, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_quat_slerp_soa_sse2(from + i, to + i, t + i, dest + i,
+                               stride, count - i);
+#endif
+
+  for (; i < count; i++) {
+    glm_quat_soa_get(from, stride, i, a);
+    glm_quat_soa_get(to,   stride, i, b);
+    glm_quat_slerp(a, b, t[i], a);
+    glm_quat_soa_set(a, dest, stride, i);
+  }
+}
+
+/*!
+ * @brief SoA version of glm_quat_nlerp: dest[i] = nlerp(from[i], to[i], t[i])
+ *
+ * @param[in]  from   SoA quaternions
+ * @param[in]  to     SoA quaternions
+ * @param[in]  t      interpolant (amount) for each pair
+ * @param[out] dest   SoA result quaternions, may be from or to
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of quaternions
+ */
+CGLM_INLINE
+void
+glm_quat_nlerp_soa(const float *from,
+                   const float *to,
+                   const float *t,
+                   float       *dest,
+                   size_t       stride,
+                   size_t       count) {
+  CGLM_ALIGN(16) versor a, b;
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX2__)
+  i = glm_quat_nlerp_soa_avx(from, to, t, dest, stride, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_quat_nlerp_soa_sse2(from + i, to + i, t + i, dest + i,
+                               stride, count - i);
+#endif
+
+  for (; i < count; i++) {
+    glm_quat_soa_get(from, stride, i, a);
+    glm_quat_soa_get(to,   stride, i, b);
+    glm_quat_nlerp(a, b, t[i], a);
+    glm_quat_soa_set(a, dest, stride, i);
+  }
+}
+
+/*!
+ * @brief rotation matrix of each SoA quaternion, see glm_quat_mat4
+ *
+ * @param[in]  q      SoA quaternions
+ * @param[in]  stride distance between planes (in floats)
+ * @param[out] dest   rotation matrices
+ * @param[in]  count  number of quaternions
+ */
+CGLM_INLINE
+void
+glm_quat_mat4_soa(const float *q, size_t stride, mat4 *dest, size_t count) {
+  CGLM_ALIGN(16) versor a;
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX2__)
+  i = glm_quat_mat4_soa_avx(q, stride, dest, count);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_quat_mat4_soa_sse2(q + i, stride, dest + i, count - i);
+#endif
+
+  for (; i < count; i++) {
+    glm_quat_soa_get(q, stride, i, a);
+    glm_quat_mat4(a, dest[i]);
+  }
+}
+
+#endif /* cglm_quat_batch_h */
@@ -458,7 +458,9 @@ glm_quat_mul(versor p, versor q, versor dest) {
     + (a1 d2 + b1 c2 − c1 b2 + d1 a2)k
        a1 a2 − b1 b2 − c1 c2 − d1 d2
    */
-#if defined(__wasm__) && defined(__wasm_simd128__)
+#if defined(CGLM_RUNTIME_DISPATCH)
+  glm_dispatch.quat_mul(p, q, dest);
+#elif defined(__wasm__) && defined(__wasm_simd128__)
   glm_quat_mul_wasm(p, q, dest);
 #elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_quat_mul_sse2(p, q, dest);
@@ -725,7 +727,8 @@ glm_quat_slerp(versor from, versor to, float t, versor dest) {
     cosTheta = -cosTheta;
   }
 
-  sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+  /* factored: 1 - cos^2 cancels badly for close quaternions */
+  sinTheta = sqrtf((1.0f - cosTheta) * (1.0f + cosTheta));
 
   /* LERP to avoid zero division */
   if (fabsf(sinTheta) < 0.001f) {
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief packet ray tests: one ray against many primitives or many rays
+ *        against one primitive
+ *
+ * Primitives and rays are SoA, component k of item i is at p[k * stride + i],
+ * stride must be >= count:
+ *
+ *   triangles: v0.x v0.y v0.z v1.x v1.y v1.z v2.x v2.y v2.z  (9 planes)
+ *   boxes:     min.x min.y min.z max.x max.y max.z           (6 planes)
+ *   rays:      origin.x origin.y origin.z dir.x dir.y dir.z  (6 planes)
+ *
+ * d[i] is the hit distance of item i (see glm_ray_triangle, and tmin of
+ * glm_ray_aabb), FLT_MAX when it is missed. AVX handles 8 and SSE2 4 items
+ * per step, the rest goes through the single ray functions.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE bool glm_ray_triangles_soa(vec3 origin, vec3 dir,
+                                          const float *tri, size_t stride,
+                                          size_t count, float *d);
+   CGLM_INLINE bool glm_rays_triangle_soa(const float *rays, size_t stride,
+                                          size_t count, vec3 v0, vec3 v1,
+                                          vec3 v2, float *d);
+   CGLM_INLINE bool glm_ray_aabbs_soa(vec3 origin, vec3 dir,
+                                      const float *boxes, size_t stride,
+                                      size_t count, float *d);
+   CGLM_INLINE bool glm_rays_aabb_soa(const float *rays, size_t stride,
+                                      size_t count, vec3 box[2], float *d);
+ */
+
+#ifndef cglm_ray_batch_h
+#define cglm_ray_batch_h
+
+#include "common.h"
+#include "ray.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/ray.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/ray.h"
+#endif
+
+/*!
+ * @brief one ray against many triangles
+ *
+ * @param[in]  origin ray origin
+ * @param[in]  dir    ray direction
+ * @param[in]  tri    SoA triangles
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of triangles
+ * @param[out] d      distance for each triangle, FLT_MAX if missed
+ *
+ * @returns whether any triangle is hit
+ */
+CGLM_INLINE
+bool
+glm_ray_triangles_soa(vec3         origin,
+                      vec3         dir,
+                      const float *tri,
+                      size_t       stride,
+                      size_t       count,
+                      float       *d) {
+  vec3   v0, v1, v2;
+  size_t i;
+  int    any;
+
+  i   = 0;
+  any = 0;
+
+#if defined(__AVX__)
+  i = glm_ray_triangles_soa_avx(origin, dir, tri, stride, count, d, &any);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_ray_triangles_soa_sse2(origin, dir, tri + i, stride, count - i,
+                                  d + i, &any);
+#endif
+
+  for (; i < count; i++) {
+    v0[0] = tri[i];              v0[1] = tri[stride + i];
+    v0[2] = tri[2 * stride + i]; v1[0] = tri[3 * stride + i];
+    v1[1] = tri[4 * stride + i]; v1[2] = tri[5 * stride + i];
+    v2[0] = tri[6 * stride + i]; v2[1] = tri[7 * stride + i];
+    v2[2] = tri[8 * stride + i];
+
+    if (glm_ray_triangle(origin, dir, v0, v1, v2, d + i))
+      any = 1;
+    else
+      d[i] = FLT_MAX;
+  }
+
+  return any != 0;
+}
+
+/*!
+ * @brief many rays against one triangle
+ *
+ * @param[in]  rays   SoA rays
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of rays
+ * @param[in]  v0     first vertex of triangle
+ * @param[in]  v1     second vertex of triangle
+ * @param[in]  v2     third vertex of triangle
+ * @param[out] d      distance for each ray, FLT_MAX if missed
+ *
+ * @returns whether any ray hits
+ */
+CGLM_INLINE
+bool
+glm_rays_triangle_soa(const float *rays,
+                      size_t       stride,
+                      size_t       count,
+                      vec3         v0,
+                      vec3         v1,
+                      vec3         v2,
+                      float       *d) {
+  vec3   o, r;
+  size_t i;
+  int    any;
+
+  i   = 0;
+  any = 0;
+
+#if defined(__AVX__)
+  i = glm_rays_triangle_soa_avx(rays, stride, count, v0, v1, v2, d, &any);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_rays_triangle_soa_sse2(rays + i, stride, count - i, v0, v1, v2,
+                                  d + i, &any);
+#endif
+
+  for (; i < count; i++) {
+    o[0] = rays[i];              o[1] = rays[stride + i];
+    o[2] = rays[2 * stride + i]; r[0] = rays[3 * stride + i];
+    r[1] = rays[4 * stride + i]; r[2] = rays[5 * stride + i];
+
+    if (glm_ray_triangle(o, r, v0, v1, v2, d + i))
+      any = 1;
+    else
+      d[i] = FLT_MAX;
+  }
+
+  return any != 0;
+}
+
+/*!
+ * @brief one ray against many boxes
+ *
+ * @param[in]  origin ray origin
+ * @param[in]  dir    ray direction
+ * @param[in]  boxes  SoA boxes
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of boxes
+ * @param[out] d      entry distance for each box (negative if origin is
+ *                    inside), FLT_MAX if missed
+ *
+ * @returns whether any box is hit
+ */
+CGLM_INLINE
+bool
+glm_ray_aabbs_soa(vec3         origin,
+                  vec3         dir,
+                  const float *boxes,
+                  size_t       stride,
+                  size_t       count,
+                  float       *d) {
+  vec3   box[2];
+  size_t i;
+  int    any;
+
+  i   = 0;
+  any = 0;
+
+#if defined(__AVX__)
+  i = glm_ray_aabbs_soa_avx(origin, dir, boxes, stride, count, d, &any);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_ray_aabbs_soa_sse2(origin, dir, boxes + i, stride, count - i,
+                              d + i, &any);
+#endif
+
+  for (; i < count; i++) {
+    box[0][0] = boxes[i];              box[0][1] = boxes[stride + i];
+    box[0][2] = boxes[2 * stride + i]; box[1][0] = boxes[3 * stride + i];
+    box[1][1] = boxes[4 * stride + i]; box[1][2] = boxes[5 * stride + i];
+
+    if (glm_ray_aabb(origin, dir, box, d + i, NULL))
+      any = 1;
+    else
+      d[i] = FLT_MAX;
+  }
+
+  return any != 0;
+}
+
+/*!
+ * @brief many rays against one box
+ *
+ * @param[in]  rays   SoA rays
+ * @param[in]  stride distance between planes (in floats)
+ * @param[in]  count  number of rays
+ * @param[in]  box    bounding box
+ * @param[out] d      entry distance for each ray (negative if origin is
+ *                    inside), FLT_MAX if missed
+ *
+ * @returns whether any ray hits
+ */
+CGLM_INLINE
+bool
+glm_rays_aabb_soa(const float *rays,
+                  size_t       stride,
+                  size_t       count,
+                  vec3         box[2],
+                  float       *d) {
+  vec3   o, r;
+  size_t i;
+  int    any;
+
+  i   = 0;
+  any = 0;
+
+#if defined(__AVX__)
+  i = glm_rays_aabb_soa_avx(rays, stride, count, box, d, &any);
+#endif
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  i += glm_rays_aabb_soa_sse2(rays + i, stride, count - i, box, d + i, &any);
+#endif
+
+  for (; i < count; i++) {
+    o[0] = rays[i];              o[1] = rays[stride + i];
+    o[2] = rays[2 * stride + i]; r[0] = rays[3 * stride + i];
+    r[1] = rays[4 * stride + i]; r[2] = rays[5 * stride + i];
+
+    if (glm_ray_aabb(o, r, box, d + i, NULL))
+      any = 1;
+    else
+      d[i] = FLT_MAX;
+  }
+
+  return any != 0;
+}
+
+#endif /* cglm_ray_batch_h */
@@ -19,6 +19,11 @@
                                  float * __restrict t1,
                                  float * __restrict t2)
  CGLM_INLINE void glm_ray_at(vec3 orig, vec3 dir, float t, vec3 point);
+ CGLM_INLINE bool glm_ray_aabb(vec3 origin,
+                               vec3 dir,
+                               vec3 box[2],
+                               float * __restrict tmin,
+                               float * __restrict tmax);
 */
 
 #ifndef cglm_ray_h
@@ -171,4 +176,48 @@ glm_ray_at(vec3 orig, vec3 dir, float t, vec3 point) {
   glm_vec3_add(orig, dst, point);
 }
 
+/*!
+ * @brief ray AABB intersection (slab test)
+ *
+ * tmin and tmax are where the ray enters and leaves the box, in units of
+ * dir. tmin < 0 means the ray starts inside the box. Zero components in
+ * dir are fine.
+ *
+ * @param[in]  origin ray origin
+ * @param[in]  dir    ray direction
+ * @param[in]  box    bounding box
+ * @param[out] tmin   entry distance, can be NULL
+ * @param[out] tmax   exit distance, can be NULL
+ *
+ * @returns whether the ray hits the box ahead of its origin
+ */
+CGLM_INLINE
+bool
+glm_ray_aabb(vec3 origin,
+             vec3 dir,
+             vec3 box[2],
+             float * __restrict tmin,
+             float * __restrict tmax) {
+  float inv, t0, t1, tn, tf;
+  int   k;
+
+  tn = -FLT_MAX;
+  tf =  FLT_MAX;
+
+  for (k = 0; k < 3; k++) {
+    inv = 1.0f / dir[k];
+    t0  = (box[0][k] - origin[k]) * inv;
+    t1  = (box[1][k] - origin[k]) * inv;
+    tn  = glm_max(tn, glm_min(t0, t1));
+    tf  = glm_min(tf, glm_max(t0, t1));
+  }
+
+  if (tmin)
+    *tmin = tn;
+  if (tmax)
+    *tmax = tf;
+
+  return tf >= tn && tf >= 0.0f;
+}
+
 #endif
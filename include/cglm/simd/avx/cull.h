@@ -0,0 +1,176 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_cull_avx_h
+#define cglm_cull_avx_h
+#ifdef __AVX__
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "../sse2/cull.h"
+#include "mat4-batch.h"
+
+#include <immintrin.h>
+
+CGLM_INLINE
+size_t
+glm_aabb_frustum_soa_avx(const float *bounds,
+                         size_t       stride,
+                         size_t       first,
+                         size_t       count,
+                         vec4         planes[6],
+                         uint32_t    *visible,
+                         size_t      *n) {
+  __m256 p[6][4], a[6][3], c[3], e[3], d, r, m, zero;
+  size_t i;
+  int    j, k;
+
+  for (j = 0; j < 6; j++) {
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm256_set1_ps(planes[j][k]);
+    for (k = 0; k < 3; k++)
+      a[j][k] = _mm256_set1_ps(fabsf(planes[j][k]));
+  }
+
+  zero = _mm256_setzero_ps();
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 3; k++) {
+      c[k] = _mm256_loadu_ps(bounds + k * stride + first + i);
+      e[k] = _mm256_loadu_ps(bounds + (k + 3) * stride + first + i);
+    }
+
+    m = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (j = 0; j < 6; j++) {
+      d = glmm256_fmadd(p[j][0], c[0], p[j][3]);
+      d = glmm256_fmadd(p[j][1], c[1], d);
+      d = glmm256_fmadd(p[j][2], c[2], d);
+      r = _mm256_mul_ps(a[j][0], e[0]);
+      r = glmm256_fmadd(a[j][1], e[1], r);
+      r = glmm256_fmadd(a[j][2], e[2], r);
+      m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_add_ps(d, r), zero,
+                                         _CMP_GE_OQ));
+    }
+
+    glm__cull_append(_mm256_movemask_ps(m), 8, (uint32_t)(first + i),
+                     visible, n);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_sphere_frustum_soa_avx(const float *spheres,
+                           size_t       stride,
+                           size_t       first,
+                           size_t       count,
+                           vec4         planes[6],
+                           uint32_t    *visible,
+                           size_t      *n) {
+  __m256 p[6][4], s[4], d, m;
+  size_t i;
+  int    j, k;
+
+  for (j = 0; j < 6; j++)
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm256_set1_ps(planes[j][k]);
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 4; k++)
+      s[k] = _mm256_loadu_ps(spheres + k * stride + first + i);
+
+    s[3] = _mm256_xor_ps(s[3], glmm_float32x8_SIGNMASK_NEG);
+    m    = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (j = 0; j < 6; j++) {
+      d = glmm256_fmadd(p[j][0], s[0], p[j][3]);
+      d = glmm256_fmadd(p[j][1], s[1], d);
+      d = glmm256_fmadd(p[j][2], s[2], d);
+      m = _mm256_and_ps(m, _mm256_cmp_ps(d, s[3], _CMP_GE_OQ));
+    }
+
+    glm__cull_append(_mm256_movemask_ps(m), 8, (uint32_t)(first + i),
+                     visible, n);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_aabb_transform_soa_avx(const float *src,
+                           size_t       stride,
+                           mat4        *m,
+                           float       *dest,
+                           size_t       count) {
+  __m256 c[3], e[3], a[16], x, y, sign;
+  size_t i;
+  int    j, k;
+
+  sign = glmm_float32x8_SIGNMASK_NEG;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 3; k++) {
+      c[k] = _mm256_loadu_ps(src + k * stride + i);
+      e[k] = _mm256_loadu_ps(src + (k + 3) * stride + i);
+    }
+    glmm256_load_mat4x8(m + i, a);
+
+    for (j = 0; j < 3; j++) {
+      x = glmm256_fmadd(a[j],     c[0], a[12 + j]);
+      x = glmm256_fmadd(a[4 + j], c[1], x);
+      x = glmm256_fmadd(a[8 + j], c[2], x);
+      y = _mm256_mul_ps(_mm256_andnot_ps(sign, a[j]), e[0]);
+      y = glmm256_fmadd(_mm256_andnot_ps(sign, a[4 + j]), e[1], y);
+      y = glmm256_fmadd(_mm256_andnot_ps(sign, a[8 + j]), e[2], y);
+      _mm256_storeu_ps(dest + j * stride + i,       x);
+      _mm256_storeu_ps(dest + (j + 3) * stride + i, y);
+    }
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_sphere_transform_soa_avx(const float *src,
+                             size_t       stride,
+                             mat4        *m,
+                             float       *dest,
+                             size_t       count) {
+  __m256 s[4], a[16], x, ss;
+  size_t i;
+  int    j, k;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 4; k++)
+      s[k] = _mm256_loadu_ps(src + k * stride + i);
+    glmm256_load_mat4x8(m + i, a);
+
+    ss = _mm256_setzero_ps();
+    for (k = 0; k < 3; k++) {
+      x  = _mm256_mul_ps(a[k * 4], a[k * 4]);
+      x  = glmm256_fmadd(a[k * 4 + 1], a[k * 4 + 1], x);
+      x  = glmm256_fmadd(a[k * 4 + 2], a[k * 4 + 2], x);
+      ss = _mm256_max_ps(ss, x);
+    }
+
+    for (j = 0; j < 3; j++) {
+      x = glmm256_fmadd(a[j],     s[0], a[12 + j]);
+      x = glmm256_fmadd(a[4 + j], s[1], x);
+      x = glmm256_fmadd(a[8 + j], s[2], x);
+      _mm256_storeu_ps(dest + j * stride + i, x);
+    }
+    _mm256_storeu_ps(dest + 3 * stride + i,
+                     _mm256_mul_ps(s[3], _mm256_sqrt_ps(ss)));
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_cull_avx_h */
@@ -0,0 +1,442 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_mat4_batch_simd_avx_h
+#define cglm_mat4_batch_simd_avx_h
+#ifdef __AVX__
+
+#include "../../common.h"
+#include "../intrin.h"
+
+#include <immintrin.h>
+
+/* transpose the 4x4 block held in each 128-bit half of r0..r3 */
+#define GLMM256_TRANSPOSE4(r0, r1, r2, r3)                                    \
+  do {                                                                        \
+    __m256 t0_, t1_, t2_, t3_;                                                \
+    t0_ = _mm256_unpacklo_ps(r0, r1);         /* b1 a1 b0 a0 */               \
+    t1_ = _mm256_unpacklo_ps(r2, r3);         /* d1 c1 d0 c0 */               \
+    t2_ = _mm256_unpackhi_ps(r0, r1);         /* b3 a3 b2 a2 */               \
+    t3_ = _mm256_unpackhi_ps(r2, r3);         /* d3 c3 d2 c2 */               \
+    r0  = _mm256_shuffle_ps(t0_, t1_, 0x44);  /* d0 c0 b0 a0 */               \
+    r1  = _mm256_shuffle_ps(t0_, t1_, 0xEE);  /* d1 c1 b1 a1 */               \
+    r2  = _mm256_shuffle_ps(t2_, t3_, 0x44);  /* d2 c2 b2 a2 */               \
+    r3  = _mm256_shuffle_ps(t2_, t3_, 0xEE);  /* d3 c3 b3 a3 */               \
+  } while (0)
+
+/*!
+ * @brief load 8 matrices into SoA registers, lane i of r[c * 4 + j] is m[i][c][j]
+ */
+static inline
+void
+glmm256_load_mat4x8(mat4 *m, __m256 r[16]) {
+  int c;
+
+  for (c = 0; c < 4; c++) {
+    __m256 r0, r1, r2, r3;
+
+    r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m[0][c])),
+                              _mm_loadu_ps(m[4][c]), 1);
+    r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m[1][c])),
+                              _mm_loadu_ps(m[5][c]), 1);
+    r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m[2][c])),
+                              _mm_loadu_ps(m[6][c]), 1);
+    r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(m[3][c])),
+                              _mm_loadu_ps(m[7][c]), 1);
+
+    GLMM256_TRANSPOSE4(r0, r1, r2, r3);
+
+    r[c * 4 + 0] = r0;
+    r[c * 4 + 1] = r1;
+    r[c * 4 + 2] = r2;
+    r[c * 4 + 3] = r3;
+  }
+}
+
+/*!
+ * @brief store SoA registers back to 8 matrices, inverse of glmm256_load_mat4x8
+ */
+static inline
+void
+glmm256_store_mat4x8(mat4 *m, __m256 r[16]) {
+  int c;
+
+  for (c = 0; c < 4; c++) {
+    __m256 r0, r1, r2, r3;
+
+    r0 = r[c * 4 + 0];
+    r1 = r[c * 4 + 1];
+    r2 = r[c * 4 + 2];
+    r3 = r[c * 4 + 3];
+
+    GLMM256_TRANSPOSE4(r0, r1, r2, r3);
+
+    _mm_storeu_ps(m[0][c], _mm256_castps256_ps128(r0));
+    _mm_storeu_ps(m[1][c], _mm256_castps256_ps128(r1));
+    _mm_storeu_ps(m[2][c], _mm256_castps256_ps128(r2));
+    _mm_storeu_ps(m[3][c], _mm256_castps256_ps128(r3));
+    _mm_storeu_ps(m[4][c], _mm256_extractf128_ps(r0, 1));
+    _mm_storeu_ps(m[5][c], _mm256_extractf128_ps(r1, 1));
+    _mm_storeu_ps(m[6][c], _mm256_extractf128_ps(r2, 1));
+    _mm_storeu_ps(m[7][c], _mm256_extractf128_ps(r3, 1));
+  }
+}
+
+/*!
+ * @brief load 8 packed vec3 (24 floats) as x, y, z registers
+ */
+static inline
+void
+glmm256_load_vec3x8(const float * __restrict p,
+                    __m256 * __restrict x,
+                    __m256 * __restrict y,
+                    __m256 * __restrict z) {
+  __m256 m03, m14, m25, xy, yz;
+
+  m03 = _mm256_castps128_ps256(_mm_loadu_ps(p));      /* x1 z0 y0 x0 */
+  m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));  /* y2 x2 z1 y1 */
+  m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));  /* z3 y3 x3 z2 */
+  m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+  m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+  m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+  xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2)); /* y3 x3 y2 x2 */
+  yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1)); /* z1 y1 z0 y0 */
+
+  *x = _mm256_shuffle_ps(m03, xy,  _MM_SHUFFLE(2, 0, 3, 0));
+  *y = _mm256_shuffle_ps(yz,  xy,  _MM_SHUFFLE(3, 1, 2, 0));
+  *z = _mm256_shuffle_ps(yz,  m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+/*!
+ * @brief store x, y, z registers as 8 packed vec3 (24 floats)
+ */
+static inline
+void
+glmm256_store_vec3x8(float * __restrict p, __m256 x, __m256 y, __m256 z) {
+  __m256 rxy, ryz, rzx, r03, r14, r25;
+
+  rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+  ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+  rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+  r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+  r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+  r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+
+  _mm_storeu_ps(p,      _mm256_castps256_ps128(r03));
+  _mm_storeu_ps(p + 4,  _mm256_castps256_ps128(r14));
+  _mm_storeu_ps(p + 8,  _mm256_castps256_ps128(r25));
+  _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r03, 1));
+  _mm_storeu_ps(p + 16, _mm256_extractf128_ps(r14, 1));
+  _mm_storeu_ps(p + 20, _mm256_extractf128_ps(r25, 1));
+}
+
+/*!
+ * @brief multiply 8 matrices held in SoA registers: d = a * b
+ *
+ * d may alias a or b
+ */
+static inline
+void
+glmm256_mat4_mul_soa(__m256 a[16], __m256 b[16], __m256 d[16]) {
+  __m256 r[16];
+  int    c, j;
+
+  for (c = 0; c < 4; c++) {
+    for (j = 0; j < 4; j++) {
+      __m256 x0;
+      x0 = _mm256_mul_ps(a[j], b[c * 4]);
+      x0 = glmm256_fmadd(a[4 + j],  b[c * 4 + 1], x0);
+      x0 = glmm256_fmadd(a[8 + j],  b[c * 4 + 2], x0);
+      x0 = glmm256_fmadd(a[12 + j], b[c * 4 + 3], x0);
+      r[c * 4 + j] = x0;
+    }
+  }
+
+  for (c = 0; c < 16; c++)
+    d[c] = r[c];
+}
+
+/*!
+ * @brief inverse 8 matrices held in SoA registers
+ *
+ * same cofactor expansion as the scalar glm_mat4_inv, one matrix per lane
+ */
+static inline
+void
+glmm256_mat4_inv_soa(__m256 s[16], __m256 d[16]) {
+  __m256 a = s[0],  b = s[1],  c = s[2],  dd = s[3],
+         e = s[4],  f = s[5],  g = s[6],  h  = s[7],
+         i = s[8],  j = s[9],  k = s[10], l  = s[11],
+         m = s[12], n = s[13], o = s[14], p  = s[15];
+  __m256 t0, t1, t2, t3, t4, t5, det;
+
+  t0 = glmm256_fmsub(k, p, _mm256_mul_ps(o, l));
+  t1 = glmm256_fmsub(j, p, _mm256_mul_ps(n, l));
+  t2 = glmm256_fmsub(j, o, _mm256_mul_ps(n, k));
+  t3 = glmm256_fmsub(i, p, _mm256_mul_ps(m, l));
+  t4 = glmm256_fmsub(i, o, _mm256_mul_ps(m, k));
+  t5 = glmm256_fmsub(i, n, _mm256_mul_ps(m, j));
+
+  d[0]  = glmm256_fmadd(h, t2, glmm256_fmsub(f, t0, _mm256_mul_ps(g, t1)));
+  d[4]  = glmm256_fmsub(g, t3, glmm256_fmadd(e, t0, _mm256_mul_ps(h, t4)));
+  d[8]  = glmm256_fmadd(h, t5, glmm256_fmsub(e, t1, _mm256_mul_ps(f, t3)));
+  d[12] = glmm256_fmsub(f, t4, glmm256_fmadd(e, t2, _mm256_mul_ps(g, t5)));
+
+  d[1]  = glmm256_fmsub(c, t1, glmm256_fmadd(b, t0, _mm256_mul_ps(dd, t2)));
+  d[5]  = glmm256_fmadd(dd, t4, glmm256_fmsub(a, t0, _mm256_mul_ps(c, t3)));
+  d[9]  = glmm256_fmsub(b, t3, glmm256_fmadd(a, t1, _mm256_mul_ps(dd, t5)));
+  d[13] = glmm256_fmadd(c, t5, glmm256_fmsub(a, t2, _mm256_mul_ps(b, t4)));
+
+  t0 = glmm256_fmsub(g, p, _mm256_mul_ps(o, h));
+  t1 = glmm256_fmsub(f, p, _mm256_mul_ps(n, h));
+  t2 = glmm256_fmsub(f, o, _mm256_mul_ps(n, g));
+  t3 = glmm256_fmsub(e, p, _mm256_mul_ps(m, h));
+  t4 = glmm256_fmsub(e, o, _mm256_mul_ps(m, g));
+  t5 = glmm256_fmsub(e, n, _mm256_mul_ps(m, f));
+
+  d[2]  = glmm256_fmadd(dd, t2, glmm256_fmsub(b, t0, _mm256_mul_ps(c, t1)));
+  d[6]  = glmm256_fmsub(c, t3, glmm256_fmadd(a, t0, _mm256_mul_ps(dd, t4)));
+  d[10] = glmm256_fmadd(dd, t5, glmm256_fmsub(a, t1, _mm256_mul_ps(b, t3)));
+  d[14] = glmm256_fmsub(b, t4, glmm256_fmadd(a, t2, _mm256_mul_ps(c, t5)));
+
+  t0 = glmm256_fmsub(g, l, _mm256_mul_ps(k, h));
+  t1 = glmm256_fmsub(f, l, _mm256_mul_ps(j, h));
+  t2 = glmm256_fmsub(f, k, _mm256_mul_ps(j, g));
+  t3 = glmm256_fmsub(e, l, _mm256_mul_ps(i, h));
+  t4 = glmm256_fmsub(e, k, _mm256_mul_ps(i, g));
+  t5 = glmm256_fmsub(e, j, _mm256_mul_ps(i, f));
+
+  d[3]  = glmm256_fmsub(c, t1, glmm256_fmadd(b, t0, _mm256_mul_ps(dd, t2)));
+  d[7]  = glmm256_fmadd(dd, t4, glmm256_fmsub(a, t0, _mm256_mul_ps(c, t3)));
+  d[11] = glmm256_fmsub(b, t3, glmm256_fmadd(a, t1, _mm256_mul_ps(dd, t5)));
+  d[15] = glmm256_fmadd(c, t5, glmm256_fmsub(a, t2, _mm256_mul_ps(b, t4)));
+
+  det = _mm256_mul_ps(a, d[0]);
+  det = glmm256_fmadd(b,  d[4],  det);
+  det = glmm256_fmadd(c,  d[8],  det);
+  det = glmm256_fmadd(dd, d[12], det);
+  det = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+  d[0]  = _mm256_mul_ps(d[0],  det); d[1]  = _mm256_mul_ps(d[1],  det);
+  d[2]  = _mm256_mul_ps(d[2],  det); d[3]  = _mm256_mul_ps(d[3],  det);
+  d[4]  = _mm256_mul_ps(d[4],  det); d[5]  = _mm256_mul_ps(d[5],  det);
+  d[6]  = _mm256_mul_ps(d[6],  det); d[7]  = _mm256_mul_ps(d[7],  det);
+  d[8]  = _mm256_mul_ps(d[8],  det); d[9]  = _mm256_mul_ps(d[9],  det);
+  d[10] = _mm256_mul_ps(d[10], det); d[11] = _mm256_mul_ps(d[11], det);
+  d[12] = _mm256_mul_ps(d[12], det); d[13] = _mm256_mul_ps(d[13], det);
+  d[14] = _mm256_mul_ps(d[14], det); d[15] = _mm256_mul_ps(d[15], det);
+}
+
+CGLM_INLINE
+void
+glm_mat4_mul_batch_avx(mat4 *m1,
+                       mat4 *m2,
+                       mat4 *dest,
+                       size_t count) {
+  /* one matrix per iteration, two destination columns per register and no
+     cross-lane shuffles */
+  __m256 y0, y1, y2, y3, b01, b23, d01, d23;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    y0  = _mm256_broadcast_ps((const __m128 *)m1[i][0]);
+    y1  = _mm256_broadcast_ps((const __m128 *)m1[i][1]);
+    y2  = _mm256_broadcast_ps((const __m128 *)m1[i][2]);
+    y3  = _mm256_broadcast_ps((const __m128 *)m1[i][3]);
+
+    b01 = _mm256_loadu_ps(m2[i][0]);
+    b23 = _mm256_loadu_ps(m2[i][2]);
+
+    d01 = _mm256_mul_ps(y0, _mm256_permute_ps(b01, 0x00));
+    d23 = _mm256_mul_ps(y0, _mm256_permute_ps(b23, 0x00));
+    d01 = glmm256_fmadd(y1, _mm256_permute_ps(b01, 0x55), d01);
+    d23 = glmm256_fmadd(y1, _mm256_permute_ps(b23, 0x55), d23);
+    d01 = glmm256_fmadd(y2, _mm256_permute_ps(b01, 0xAA), d01);
+    d23 = glmm256_fmadd(y2, _mm256_permute_ps(b23, 0xAA), d23);
+    d01 = glmm256_fmadd(y3, _mm256_permute_ps(b01, 0xFF), d01);
+    d23 = glmm256_fmadd(y3, _mm256_permute_ps(b23, 0xFF), d23);
+
+    _mm256_storeu_ps(dest[i][0], d01);
+    _mm256_storeu_ps(dest[i][2], d23);
+  }
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mulv_batch_avx(mat4 m, vec4 *v, vec4 *dest,
+                        size_t count) {
+  /* two vectors per register */
+  __m256 y0, y1, y2, y3, v01, d01;
+  size_t i;
+
+  y0 = _mm256_broadcast_ps((const __m128 *)m[0]);
+  y1 = _mm256_broadcast_ps((const __m128 *)m[1]);
+  y2 = _mm256_broadcast_ps((const __m128 *)m[2]);
+  y3 = _mm256_broadcast_ps((const __m128 *)m[3]);
+
+  for (i = 0; i + 2 <= count; i += 2) {
+    v01 = _mm256_loadu_ps(v[i]);
+
+    d01 = _mm256_mul_ps(y0, _mm256_permute_ps(v01, 0x00));
+    d01 = glmm256_fmadd(y1, _mm256_permute_ps(v01, 0x55), d01);
+    d01 = glmm256_fmadd(y2, _mm256_permute_ps(v01, 0xAA), d01);
+    d01 = glmm256_fmadd(y3, _mm256_permute_ps(v01, 0xFF), d01);
+
+    _mm256_storeu_ps(dest[i], d01);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mulv3_batch_avx(mat4 m, vec3 *v, float last,
+                         vec3 *dest, size_t count) {
+  __m256 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m256 x, y, z, dx, dy, dz;
+  size_t i;
+
+  m00 = _mm256_set1_ps(m[0][0]); m01 = _mm256_set1_ps(m[0][1]);
+  m02 = _mm256_set1_ps(m[0][2]); m10 = _mm256_set1_ps(m[1][0]);
+  m11 = _mm256_set1_ps(m[1][1]); m12 = _mm256_set1_ps(m[1][2]);
+  m20 = _mm256_set1_ps(m[2][0]); m21 = _mm256_set1_ps(m[2][1]);
+  m22 = _mm256_set1_ps(m[2][2]);
+  t0  = _mm256_set1_ps(m[3][0] * last);
+  t1  = _mm256_set1_ps(m[3][1] * last);
+  t2  = _mm256_set1_ps(m[3][2] * last);
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    glmm256_load_vec3x8(v[i], &x, &y, &z);
+
+    dx = glmm256_fmadd(m00, x, t0);
+    dy = glmm256_fmadd(m01, x, t1);
+    dz = glmm256_fmadd(m02, x, t2);
+    dx = glmm256_fmadd(m10, y, dx);
+    dy = glmm256_fmadd(m11, y, dy);
+    dz = glmm256_fmadd(m12, y, dz);
+    dx = glmm256_fmadd(m20, z, dx);
+    dy = glmm256_fmadd(m21, z, dy);
+    dz = glmm256_fmadd(m22, z, dz);
+
+    glmm256_store_vec3x8(dest[i], dx, dy, dz);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_inv_batch_avx(mat4 *mat, mat4 *dest,
+                       size_t count) {
+  __m256 r[16];
+  size_t i;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    glmm256_load_mat4x8(mat + i, r);
+    glmm256_mat4_inv_soa(r, r);
+    glmm256_store_mat4x8(dest + i, r);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mul_soa_avx(const float *m1,
+                     const float *m2,
+                     float       *dest,
+                     size_t stride,
+                     size_t count) {
+  __m256 a[16], b[16];
+  size_t i;
+  int    c;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (c = 0; c < 16; c++) {
+      a[c] = _mm256_loadu_ps(m1 + c * stride + i);
+      b[c] = _mm256_loadu_ps(m2 + c * stride + i);
+    }
+
+    glmm256_mat4_mul_soa(a, b, a);
+
+    for (c = 0; c < 16; c++)
+      _mm256_storeu_ps(dest + c * stride + i, a[c]);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mulv3_soa_avx(mat4 m,
+                       const float *v,
+                       float last,
+                       float *dest,
+                       size_t stride,
+                       size_t count) {
+  __m256 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m256 x, y, z;
+  size_t i;
+
+  m00 = _mm256_set1_ps(m[0][0]); m01 = _mm256_set1_ps(m[0][1]);
+  m02 = _mm256_set1_ps(m[0][2]); m10 = _mm256_set1_ps(m[1][0]);
+  m11 = _mm256_set1_ps(m[1][1]); m12 = _mm256_set1_ps(m[1][2]);
+  m20 = _mm256_set1_ps(m[2][0]); m21 = _mm256_set1_ps(m[2][1]);
+  m22 = _mm256_set1_ps(m[2][2]);
+  t0  = _mm256_set1_ps(m[3][0] * last);
+  t1  = _mm256_set1_ps(m[3][1] * last);
+  t2  = _mm256_set1_ps(m[3][2] * last);
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    x = _mm256_loadu_ps(v + i);
+    y = _mm256_loadu_ps(v + stride + i);
+    z = _mm256_loadu_ps(v + 2 * stride + i);
+
+    _mm256_storeu_ps(dest + i,
+                     glmm256_fmadd(m20, z,
+                                   glmm256_fmadd(m10, y,
+                                                 glmm256_fmadd(m00, x, t0))));
+    _mm256_storeu_ps(dest + stride + i,
+                     glmm256_fmadd(m21, z,
+                                   glmm256_fmadd(m11, y,
+                                                 glmm256_fmadd(m01, x, t1))));
+    _mm256_storeu_ps(dest + 2 * stride + i,
+                     glmm256_fmadd(m22, z,
+                                   glmm256_fmadd(m12, y,
+                                                 glmm256_fmadd(m02, x, t2))));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_inv_soa_avx(const float *mat,
+                     float       *dest,
+                     size_t stride,
+                     size_t count) {
+  __m256 r[16];
+  size_t i;
+  int    c;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (c = 0; c < 16; c++)
+      r[c] = _mm256_loadu_ps(mat + c * stride + i);
+
+    glmm256_mat4_inv_soa(r, r);
+
+    for (c = 0; c < 16; c++)
+      _mm256_storeu_ps(dest + c * stride + i, r[c]);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_mat4_batch_simd_avx_h */
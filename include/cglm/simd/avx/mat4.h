@@ -72,5 +72,212 @@ glm_mat4_mul_avx(mat4 m1, mat4 m2, mat4 dest) {
                                             _mm256_mul_ps(y5, y9))));
 }
 
+#ifdef __AVX2__
+CGLM_INLINE
+void
+glm_mat4_transp_avx(mat4 m, mat4 dest) {
+  __m256 y0, y1, y2, y3;
+  __m256i i0, i1;
+
+  y0 = glmm_load256(m[0]);                     /* col 0 | col 1 */
+  y1 = glmm_load256(m[2]);                     /* col 2 | col 3 */
+
+  i0 = _mm256_set_epi32(5, 1, 5, 1, 4, 0, 4, 0);
+  i1 = _mm256_set_epi32(7, 3, 7, 3, 6, 2, 6, 2);
+
+  /* cross-lane gathers, rows 0 | 1 and rows 2 | 3 */
+  y2 = _mm256_blend_ps(_mm256_permutevar8x32_ps(y0, i0),
+                       _mm256_permutevar8x32_ps(y1, i0), 0xCC);
+  y3 = _mm256_blend_ps(_mm256_permutevar8x32_ps(y0, i1),
+                       _mm256_permutevar8x32_ps(y1, i1), 0xCC);
+
+  glmm_store256(dest[0], y2);
+  glmm_store256(dest[2], y3);
+}
+#endif
+
+/*
+ * 2x2 matrix helpers for the block inverse, a 2x2 block is stored as
+ * [x y z w] = | x y |
+ *             | z w |, two independent blocks per register
+ */
+
+/* a * b */
+static inline
+__m256
+glmm256_mat2_mul(__m256 a, __m256 b) {
+  __m256 y0;
+  y0 = _mm256_mul_ps(a, _mm256_permute_ps(b, _MM_SHUFFLE(3, 0, 3, 0)));
+  return glmm256_fmadd(_mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)),
+                       _mm256_permute_ps(b, _MM_SHUFFLE(1, 2, 1, 2)), y0);
+}
+
+/* adj(a) * b */
+static inline
+__m256
+glmm256_mat2_adjmul(__m256 a, __m256 b) {
+  __m256 y0;
+  y0 = _mm256_mul_ps(_mm256_permute_ps(a, _MM_SHUFFLE(2, 2, 1, 1)),
+                     _mm256_permute_ps(b, _MM_SHUFFLE(1, 0, 3, 2)));
+  return glmm256_fmsub(_mm256_permute_ps(a, _MM_SHUFFLE(0, 0, 3, 3)), b, y0);
+}
+
+/* a * adj(b) */
+static inline
+__m256
+glmm256_mat2_muladj(__m256 a, __m256 b) {
+  __m256 y0;
+  y0 = _mm256_mul_ps(_mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)),
+                     _mm256_permute_ps(b, _MM_SHUFFLE(1, 2, 1, 2)));
+  return glmm256_fmsub(a, _mm256_permute_ps(b, _MM_SHUFFLE(0, 3, 0, 3)), y0);
+}
+
+/*!
+ * @brief split mat into 2x2 blocks and compute what det and inverse share
+ *
+ * mat = | A B |, stored by columns which gives the transposed blocks, since
+ *       | C D |  inv(M^T) = inv(M)^T the formulas work on them unchanged
+ *
+ * @param[in]  mat   matrix
+ * @param[out] dets  |A| |A| |B| |B| | |C| |C| |D| |D|
+ * @param[out] ad    A | D
+ * @param[out] bc    B | C
+ * @param[out] da    D | A
+ * @param[out] cb    C | B
+ * @param[out] dc_ab adj(D) C | adj(A) B
+ *
+ * @return det(mat) in all lanes
+ */
+static inline
+__m128
+glmm256_mat4_blocks(mat4    mat,
+                    __m256 *dets,
+                    __m256 *ad,
+                    __m256 *bc,
+                    __m256 *da,
+                    __m256 *cb,
+                    __m256 *dc_ab) {
+  __m256 c02, c13, ac, bd;
+  __m128 x0, x1;
+
+  c02 = _mm256_insertf128_ps(_mm256_castps128_ps256(glmm_load(mat[0])),
+                             glmm_load(mat[2]), 1);
+  c13 = _mm256_insertf128_ps(_mm256_castps128_ps256(glmm_load(mat[1])),
+                             glmm_load(mat[3]), 1);
+
+  ac = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(c02),
+                                           _mm256_castps_pd(c13)));
+  bd = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(c02),
+                                           _mm256_castps_pd(c13)));
+
+  *dets = glmm256_fmsub(_mm256_moveldup_ps(c02), _mm256_movehdup_ps(c13),
+                        _mm256_mul_ps(_mm256_movehdup_ps(c02),
+                                      _mm256_moveldup_ps(c13)));
+
+  *ad    = _mm256_blend_ps(ac, bd, 0xF0);
+  *bc    = _mm256_blend_ps(bd, ac, 0xF0);
+  *da    = _mm256_permute2f128_ps(ac, bd, 0x03);
+  *cb    = _mm256_permute2f128_ps(ac, bd, 0x21);
+  *dc_ab = glmm256_mat2_adjmul(*da, *cb);
+
+  /* det = |A| |D| + |B| |C| - tr(adj(A) B adj(D) C) */
+  x0 = _mm256_castps256_ps128(*dets);
+  x1 = _mm256_extractf128_ps(*dets, 1);
+  x0 = _mm_mul_ps(x0, glmm_shuff1(x1, 1, 0, 3, 2));   /* AD AD BC BC */
+
+  x1 = _mm256_castps256_ps128(*dc_ab);
+  x1 = _mm_mul_ps(_mm256_extractf128_ps(*dc_ab, 1),
+                  glmm_shuff1(x1, 3, 1, 2, 0));
+
+  /* every product is counted twice in x0 */
+  return glmm_vhadd(glmm_fmsub(x0, _mm_set1_ps(0.5f), x1));
+}
+
+/*!
+ * @brief scaled adjugate, adj(M) = [X Y; Z W] with (adj(N) = 2x2 adjugate)
+ *
+ *   X = |D| A - B adj(D) C        Y = |B| C - D adj(adj(A) B)
+ *   W = |A| D - C adj(A) B        Z = |C| B - A adj(adj(D) C)
+ *
+ * each block is still in adjugate form, the final store undoes it; the
+ * independent pairs share one 256-bit register
+ */
+static inline
+__m128
+glmm256_mat4_adj(mat4 mat, __m256 *xw, __m256 *yz) {
+  __m256 dets, da, cb, dc_ab, ad, bc, y0;
+  __m256i i0;
+  __m128 det;
+
+  det = glmm256_mat4_blocks(mat, &dets, &ad, &bc, &da, &cb, &dc_ab);
+  i0  = _mm256_set_epi32(0, 0, 0, 0, 2, 2, 2, 2);
+
+  /* |D| | |A| */
+  y0  = _mm256_permutevar_ps(_mm256_permute2f128_ps(dets, dets, 0x01), i0);
+  *xw = glmm256_fmsub(y0, ad, glmm256_mat2_mul(bc, dc_ab));
+
+  /* |B| | |C| */
+  y0  = _mm256_permutevar_ps(dets, i0);
+  *yz = glmm256_fmsub(y0, cb,
+                      glmm256_mat2_muladj(da,
+                                          _mm256_permute2f128_ps(dc_ab, dc_ab,
+                                                                 0x01)));
+  return det;
+}
+
+/* dest = adj * r where r = 1 / det with signs + - - + */
+static inline
+void
+glmm256_mat4_adj_store(__m256 xw, __m256 yz, __m128 r, mat4 dest) {
+  __m256 y0, y1, y2;
+
+  y2 = _mm256_insertf128_ps(_mm256_castps128_ps256(r), r, 1);
+  xw = _mm256_mul_ps(xw, y2);
+  yz = _mm256_mul_ps(yz, y2);
+
+  y0 = _mm256_blend_ps(xw, yz, 0xF0);                       /* X | Z */
+  y1 = _mm256_blend_ps(yz, xw, 0xF0);                       /* Y | W */
+
+  y2 = _mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(1, 3, 1, 3));  /* row 0 | 2 */
+  y0 = _mm256_shuffle_ps(y0, y1, _MM_SHUFFLE(0, 2, 0, 2));  /* row 1 | 3 */
+
+  glmm_store(dest[0], _mm256_castps256_ps128(y2));
+  glmm_store(dest[1], _mm256_castps256_ps128(y0));
+  glmm_store(dest[2], _mm256_extractf128_ps(y2, 1));
+  glmm_store(dest[3], _mm256_extractf128_ps(y0, 1));
+}
+
+CGLM_INLINE
+float
+glm_mat4_det_avx(mat4 mat) {
+  __m256 dets, ad, bc, da, cb, dc_ab;
+  return _mm_cvtss_f32(glmm256_mat4_blocks(mat, &dets, &ad, &bc,
+                                           &da, &cb, &dc_ab));
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_avx(mat4 mat, mat4 dest) {
+  __m256 xw, yz;
+  __m128 det;
+
+  det = glmm256_mat4_adj(mat, &xw, &yz);
+  glmm256_mat4_adj_store(xw, yz,
+                         _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det),
+                         dest);
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_fast_avx(mat4 mat, mat4 dest) {
+  __m256 xw, yz;
+  __m128 det;
+
+  det = glmm256_mat4_adj(mat, &xw, &yz);
+  det = _mm_xor_ps(_mm_rcp_ps(det),
+                   GLMM__SIGNMASKf(0, GLMM_NEGZEROf, GLMM_NEGZEROf, 0));
+  glmm256_mat4_adj_store(xw, yz, det, dest);
+}
+
 #endif
 #endif /* cglm_mat_simd_avx_h */
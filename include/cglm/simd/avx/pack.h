@@ -0,0 +1,191 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_pack_avx_h
+#define cglm_pack_avx_h
+#ifdef __AVX__
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "mat4-batch.h"
+
+#include <immintrin.h>
+
+/*!
+ * @brief load eight vec4 which are step floats apart as x, y, z, w registers
+ */
+static inline
+void
+glmm256_load_vec4x8(const float *p, size_t step, __m256 r[4]) {
+  int k;
+
+  for (k = 0; k < 4; k++)
+    r[k] = _mm256_insertf128_ps(
+             _mm256_castps128_ps256(_mm_loadu_ps(p + k * step)),
+             _mm_loadu_ps(p + (k + 4) * step), 1);
+
+  GLMM256_TRANSPOSE4(r[0], r[1], r[2], r[3]);
+}
+
+/*!
+ * @brief inverse of glmm256_load_vec4x8
+ */
+static inline
+void
+glmm256_store_vec4x8(float *p, size_t step, __m256 r0, __m256 r1,
+                     __m256 r2, __m256 r3) {
+  GLMM256_TRANSPOSE4(r0, r1, r2, r3);
+
+  _mm_storeu_ps(p,            _mm256_castps256_ps128(r0));
+  _mm_storeu_ps(p + step,     _mm256_castps256_ps128(r1));
+  _mm_storeu_ps(p + 2 * step, _mm256_castps256_ps128(r2));
+  _mm_storeu_ps(p + 3 * step, _mm256_castps256_ps128(r3));
+  _mm_storeu_ps(p + 4 * step, _mm256_extractf128_ps(r0, 1));
+  _mm_storeu_ps(p + 5 * step, _mm256_extractf128_ps(r1, 1));
+  _mm_storeu_ps(p + 6 * step, _mm256_extractf128_ps(r2, 1));
+  _mm_storeu_ps(p + 7 * step, _mm256_extractf128_ps(r3, 1));
+}
+
+/*!
+ * @brief 8 wide glmm_quat_from_rot
+ */
+static inline
+void
+glmm256_quat_from_rot(__m256 m[9], __m256 q[4]) {
+  __m256 one, tr, t, tc, a, b, c, d, e, f, x, y, z, w, k;
+
+  one = _mm256_set1_ps(1.0f);
+  tr  = _mm256_add_ps(_mm256_add_ps(m[0], m[4]), m[8]);
+
+  a = _mm256_sub_ps(m[5], m[7]);
+  b = _mm256_sub_ps(m[6], m[2]);
+  c = _mm256_sub_ps(m[1], m[3]);
+  d = _mm256_add_ps(m[1], m[3]);
+  e = _mm256_add_ps(m[2], m[6]);
+  f = _mm256_add_ps(m[5], m[7]);
+
+  t = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(one, m[0]), m[4]), m[8]);
+  x = e; y = f; z = t; w = c;
+
+  k  = _mm256_cmp_ps(m[4], m[8], _CMP_GE_OQ);
+  tc = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(one, m[0]), m[8]), m[4]);
+  t  = _mm256_blendv_ps(t, tc, k);
+  x  = _mm256_blendv_ps(x, d,  k);
+  y  = _mm256_blendv_ps(y, tc, k);
+  z  = _mm256_blendv_ps(z, f,  k);
+  w  = _mm256_blendv_ps(w, b,  k);
+
+  k  = _mm256_and_ps(_mm256_cmp_ps(m[0], m[4], _CMP_GE_OQ),
+                     _mm256_cmp_ps(m[0], m[8], _CMP_GE_OQ));
+  tc = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(one, m[4]), m[8]), m[0]);
+  t  = _mm256_blendv_ps(t, tc, k);
+  x  = _mm256_blendv_ps(x, tc, k);
+  y  = _mm256_blendv_ps(y, d,  k);
+  z  = _mm256_blendv_ps(z, e,  k);
+  w  = _mm256_blendv_ps(w, a,  k);
+
+  k  = _mm256_cmp_ps(tr, _mm256_setzero_ps(), _CMP_GE_OQ);
+  tc = _mm256_add_ps(one, tr);
+  t  = _mm256_blendv_ps(t, tc, k);
+  x  = _mm256_blendv_ps(x, a,  k);
+  y  = _mm256_blendv_ps(y, b,  k);
+  z  = _mm256_blendv_ps(z, c,  k);
+  w  = _mm256_blendv_ps(w, tc, k);
+
+  k = _mm256_div_ps(_mm256_set1_ps(0.5f), _mm256_sqrt_ps(t));
+
+  q[0] = _mm256_mul_ps(x, k);
+  q[1] = _mm256_mul_ps(y, k);
+  q[2] = _mm256_mul_ps(z, k);
+  q[3] = _mm256_mul_ps(w, k);
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_pack_qts_batch_avx(mat4 *m, vec4 *dest, size_t count) {
+  __m256 r[16], q[4], s, is;
+  size_t i;
+  int    c, k;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    glmm256_load_mat4x8(m + i, r);
+
+    s  = _mm256_mul_ps(r[0], r[0]);
+    s  = glmm256_fmadd(r[1], r[1], s);
+    s  = glmm256_fmadd(r[2], r[2], s);
+    s  = _mm256_sqrt_ps(s);
+    is = _mm256_and_ps(_mm256_cmp_ps(s, _mm256_setzero_ps(), _CMP_GT_OQ),
+                       _mm256_div_ps(_mm256_set1_ps(1.0f), s));
+
+    /* drop row 3 of the 3x3 part: r[c * 4 + j] -> r[c * 3 + j] */
+    for (c = 0; c < 3; c++)
+      for (k = 0; k < 3; k++)
+        r[c * 3 + k] = _mm256_mul_ps(r[c * 4 + k], is);
+
+    glmm256_quat_from_rot(r, q);
+
+    glmm256_store_vec4x8(dest[2 * i],     8, q[0], q[1], q[2], q[3]);
+    glmm256_store_vec4x8(dest[2 * i + 1], 8, r[12], r[13], r[14], s);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_unpack_qts_batch_avx(vec4 *src, mat4 *dest, size_t count) {
+  __m256 q[4], t[4], r[16], zero, s, xx, yy, zz, xy, yz, xz, wx, wy, wz;
+  size_t i;
+
+  zero = _mm256_setzero_ps();
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    glmm256_load_vec4x8(src[2 * i],     8, q);
+    glmm256_load_vec4x8(src[2 * i + 1], 8, t);
+
+    s = _mm256_mul_ps(q[0], q[0]);
+    s = glmm256_fmadd(q[1], q[1], s);
+    s = glmm256_fmadd(q[2], q[2], s);
+    s = glmm256_fmadd(q[3], q[3], s);
+    s = _mm256_and_ps(_mm256_cmp_ps(s, zero, _CMP_GT_OQ),
+                      _mm256_div_ps(_mm256_add_ps(t[3], t[3]), s));
+
+    xx = _mm256_mul_ps(_mm256_mul_ps(s, q[0]), q[0]);
+    yy = _mm256_mul_ps(_mm256_mul_ps(s, q[1]), q[1]);
+    zz = _mm256_mul_ps(_mm256_mul_ps(s, q[2]), q[2]);
+    xy = _mm256_mul_ps(_mm256_mul_ps(s, q[0]), q[1]);
+    yz = _mm256_mul_ps(_mm256_mul_ps(s, q[1]), q[2]);
+    xz = _mm256_mul_ps(_mm256_mul_ps(s, q[0]), q[2]);
+    wx = _mm256_mul_ps(_mm256_mul_ps(s, q[3]), q[0]);
+    wy = _mm256_mul_ps(_mm256_mul_ps(s, q[3]), q[1]);
+    wz = _mm256_mul_ps(_mm256_mul_ps(s, q[3]), q[2]);
+
+    r[0]  = _mm256_sub_ps(_mm256_sub_ps(t[3], yy), zz);
+    r[1]  = _mm256_add_ps(xy, wz);
+    r[2]  = _mm256_sub_ps(xz, wy);
+    r[3]  = zero;
+    r[4]  = _mm256_sub_ps(xy, wz);
+    r[5]  = _mm256_sub_ps(_mm256_sub_ps(t[3], xx), zz);
+    r[6]  = _mm256_add_ps(yz, wx);
+    r[7]  = zero;
+    r[8]  = _mm256_add_ps(xz, wy);
+    r[9]  = _mm256_sub_ps(yz, wx);
+    r[10] = _mm256_sub_ps(_mm256_sub_ps(t[3], xx), yy);
+    r[11] = zero;
+    r[12] = t[0];
+    r[13] = t[1];
+    r[14] = t[2];
+    r[15] = _mm256_set1_ps(1.0f);
+
+    glmm256_store_mat4x8(dest + i, r);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_pack_avx_h */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_quat_batch_avx_h
+#define cglm_quat_batch_avx_h
+#ifdef __AVX2__
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "sincos.h"
+#include "mat4-batch.h"
+
+#include <immintrin.h>
+
+/* 8-lane versions of the SSE2 SoA kernels, see simd/sse2/quat-batch.h */
+
+CGLM_INLINE
+size_t
+glm_quat_slerp_soa_avx(const float *from,
+                       const float *to,
+                       const float *t,
+                       float       *dest,
+                       size_t       stride,
+                       size_t       count) {
+  __m256 a[4], b[4], y0, d, ad, th, sn, ts, tc, ca, cb, m;
+  size_t i;
+  int    k;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 4; k++) {
+      a[k] = _mm256_loadu_ps(from + k * stride + i);
+      b[k] = _mm256_loadu_ps(to   + k * stride + i);
+    }
+    y0 = _mm256_loadu_ps(t + i);
+
+    d  = _mm256_mul_ps(a[0], b[0]);
+    d  = glmm256_fmadd(a[1], b[1], d);
+    d  = glmm256_fmadd(a[2], b[2], d);
+    d  = glmm256_fmadd(a[3], b[3], d);
+    ad = _mm256_andnot_ps(glmm_float32x8_SIGNMASK_NEG, d);
+
+    sn = _mm256_sqrt_ps(
+           _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), ad),
+                                       _mm256_add_ps(_mm256_set1_ps(1.0f), ad)),
+                         _mm256_setzero_ps()));
+    th = glmm256_acos(ad);
+
+    glmm256_sincos(_mm256_mul_ps(th, _mm256_sub_ps(_mm256_set1_ps(1.0f), y0)),
+                   &ts, &tc);
+    ca = _mm256_div_ps(ts, sn);
+    glmm256_sincos(_mm256_mul_ps(th, y0), &ts, &tc);
+    cb = _mm256_div_ps(ts, sn);
+    ca = _mm256_xor_ps(ca, _mm256_and_ps(d, glmm_float32x8_SIGNMASK_NEG));
+
+    m  = _mm256_cmp_ps(sn, _mm256_set1_ps(0.001f), _CMP_LT_OQ);
+    ca = _mm256_blendv_ps(ca, _mm256_sub_ps(_mm256_set1_ps(1.0f), y0), m);
+    cb = _mm256_blendv_ps(cb, y0, m);
+
+    m  = _mm256_cmp_ps(ad, _mm256_set1_ps(1.0f), _CMP_GE_OQ);
+    ca = _mm256_blendv_ps(ca, _mm256_set1_ps(1.0f), m);
+    cb = _mm256_andnot_ps(m, cb);
+
+    for (k = 0; k < 4; k++)
+      _mm256_storeu_ps(dest + k * stride + i,
+                       glmm256_fmadd(a[k], ca, _mm256_mul_ps(b[k], cb)));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_nlerp_soa_avx(const float *from,
+                       const float *to,
+                       const float *t,
+                       float       *dest,
+                       size_t       stride,
+                       size_t       count) {
+  __m256 a[4], b[4], y0, d, s, n;
+  size_t i;
+  int    k;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 4; k++) {
+      a[k] = _mm256_loadu_ps(from + k * stride + i);
+      b[k] = _mm256_loadu_ps(to   + k * stride + i);
+    }
+    y0 = _mm256_loadu_ps(t + i);
+
+    d = _mm256_mul_ps(a[0], b[0]);
+    d = glmm256_fmadd(a[1], b[1], d);
+    d = glmm256_fmadd(a[2], b[2], d);
+    d = glmm256_fmadd(a[3], b[3], d);
+
+    s = _mm256_and_ps(_mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ),
+                      glmm_float32x8_SIGNMASK_NEG);
+
+    n = _mm256_setzero_ps();
+    for (k = 0; k < 4; k++) {
+      b[k] = glmm256_fmadd(y0, _mm256_sub_ps(_mm256_xor_ps(b[k], s), a[k]),
+                           a[k]);
+      n    = glmm256_fmadd(b[k], b[k], n);
+    }
+
+    s = _mm256_cmp_ps(n, _mm256_setzero_ps(), _CMP_LE_OQ);
+    n = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(n));
+
+    for (k = 0; k < 3; k++)
+      _mm256_storeu_ps(dest + k * stride + i,
+                       _mm256_andnot_ps(s, _mm256_mul_ps(b[k], n)));
+
+    _mm256_storeu_ps(dest + 3 * stride + i,
+                     _mm256_blendv_ps(_mm256_mul_ps(b[3], n),
+                                      _mm256_set1_ps(1.0f), s));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_mat4_soa_avx(const float *q,
+                      size_t       stride,
+                      mat4        *dest,
+                      size_t       count) {
+  __m256 r[16], x, y, z, w, s, xx, yy, zz, xy, yz, xz, wx, wy, wz, one;
+  size_t i;
+
+  one  = _mm256_set1_ps(1.0f);
+  r[3] = r[7] = r[11] = r[12] = r[13] = r[14] = _mm256_setzero_ps();
+  r[15] = one;
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    x = _mm256_loadu_ps(q + i);
+    y = _mm256_loadu_ps(q + stride + i);
+    z = _mm256_loadu_ps(q + 2 * stride + i);
+    w = _mm256_loadu_ps(q + 3 * stride + i);
+
+    s = _mm256_mul_ps(x, x);
+    s = glmm256_fmadd(y, y, s);
+    s = glmm256_fmadd(z, z, s);
+    s = glmm256_fmadd(w, w, s);
+    s = _mm256_sqrt_ps(s);
+    s = _mm256_and_ps(_mm256_cmp_ps(s, _mm256_setzero_ps(), _CMP_GT_OQ),
+                      _mm256_div_ps(_mm256_set1_ps(2.0f), s));
+
+    xx = _mm256_mul_ps(_mm256_mul_ps(s, x), x);
+    yy = _mm256_mul_ps(_mm256_mul_ps(s, y), y);
+    zz = _mm256_mul_ps(_mm256_mul_ps(s, z), z);
+    xy = _mm256_mul_ps(_mm256_mul_ps(s, x), y);
+    yz = _mm256_mul_ps(_mm256_mul_ps(s, y), z);
+    xz = _mm256_mul_ps(_mm256_mul_ps(s, x), z);
+    wx = _mm256_mul_ps(_mm256_mul_ps(s, w), x);
+    wy = _mm256_mul_ps(_mm256_mul_ps(s, w), y);
+    wz = _mm256_mul_ps(_mm256_mul_ps(s, w), z);
+
+    r[0]  = _mm256_sub_ps(_mm256_sub_ps(one, yy), zz);
+    r[1]  = _mm256_add_ps(xy, wz);
+    r[2]  = _mm256_sub_ps(xz, wy);
+    r[4]  = _mm256_sub_ps(xy, wz);
+    r[5]  = _mm256_sub_ps(_mm256_sub_ps(one, xx), zz);
+    r[6]  = _mm256_add_ps(yz, wx);
+    r[8]  = _mm256_add_ps(xz, wy);
+    r[9]  = _mm256_sub_ps(yz, wx);
+    r[10] = _mm256_sub_ps(_mm256_sub_ps(one, xx), yy);
+
+    glmm256_store_mat4x8(dest + i, r);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_quat_batch_avx_h */
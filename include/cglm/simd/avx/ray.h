@@ -0,0 +1,236 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_ray_avx_h
+#define cglm_ray_avx_h
+#ifdef __AVX__
+
+#include "../../common.h"
+#include "../intrin.h"
+
+#include <immintrin.h>
+
+static inline
+void
+glmm256_cross3(const __m256 a[3], const __m256 b[3], __m256 d[3]) {
+  d[0] = _mm256_sub_ps(_mm256_mul_ps(a[1], b[2]), _mm256_mul_ps(a[2], b[1]));
+  d[1] = _mm256_sub_ps(_mm256_mul_ps(a[2], b[0]), _mm256_mul_ps(a[0], b[2]));
+  d[2] = _mm256_sub_ps(_mm256_mul_ps(a[0], b[1]), _mm256_mul_ps(a[1], b[0]));
+}
+
+static inline
+__m256
+glmm256_dot3(const __m256 a[3], const __m256 b[3]) {
+  return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[0], b[0]),
+                                     _mm256_mul_ps(a[1], b[1])),
+                       _mm256_mul_ps(a[2], b[2]));
+}
+
+/*!
+ * @brief 8 wide glmm_ray_triangle
+ */
+static inline
+__m256
+glmm256_ray_triangle(const __m256 o[3],
+                     const __m256 dir[3],
+                     const __m256 v0[3],
+                     const __m256 v1[3],
+                     const __m256 v2[3]) {
+  __m256 e1[3], e2[3], p[3], t[3], q[3], eps, one, zero, det, inv, u, v;
+  __m256 dist, m;
+  int    k;
+
+  eps  = _mm256_set1_ps(0.000001f);
+  one  = _mm256_set1_ps(1.0f);
+  zero = _mm256_setzero_ps();
+
+  for (k = 0; k < 3; k++) {
+    e1[k] = _mm256_sub_ps(v1[k], v0[k]);
+    e2[k] = _mm256_sub_ps(v2[k], v0[k]);
+    t[k]  = _mm256_sub_ps(o[k],  v0[k]);
+  }
+
+  glmm256_cross3(dir, e2, p);
+  det = glmm256_dot3(e1, p);
+  inv = _mm256_div_ps(one, det);
+
+  u = _mm256_mul_ps(inv, glmm256_dot3(t, p));
+  glmm256_cross3(t, e1, q);
+  v = _mm256_mul_ps(inv, glmm256_dot3(dir, q));
+  dist = _mm256_mul_ps(inv, glmm256_dot3(e2, q));
+
+  m = _mm256_cmp_ps(_mm256_andnot_ps(glmm_float32x8_SIGNMASK_NEG, det), eps,
+                    _CMP_GE_OQ);
+  m = _mm256_and_ps(m, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+  m = _mm256_and_ps(m, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+  m = _mm256_and_ps(m, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+  m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+  m = _mm256_and_ps(m, _mm256_cmp_ps(dist, eps, _CMP_GT_OQ));
+
+  return _mm256_blendv_ps(_mm256_set1_ps(FLT_MAX), dist, m);
+}
+
+/*!
+ * @brief 8 wide glmm_ray_aabb
+ */
+static inline
+__m256
+glmm256_ray_aabb(const __m256 o[3],
+                 const __m256 inv[3],
+                 const __m256 bmin[3],
+                 const __m256 bmax[3]) {
+  __m256 t0, t1, tn, tf, m;
+  int    k;
+
+  tn = _mm256_set1_ps(-FLT_MAX);
+  tf = _mm256_set1_ps(FLT_MAX);
+
+  for (k = 0; k < 3; k++) {
+    t0 = _mm256_mul_ps(_mm256_sub_ps(bmin[k], o[k]), inv[k]);
+    t1 = _mm256_mul_ps(_mm256_sub_ps(bmax[k], o[k]), inv[k]);
+    tn = _mm256_max_ps(tn, _mm256_min_ps(t0, t1));
+    tf = _mm256_min_ps(tf, _mm256_max_ps(t0, t1));
+  }
+
+  m = _mm256_and_ps(_mm256_cmp_ps(tf, tn, _CMP_GE_OQ),
+                    _mm256_cmp_ps(tf, _mm256_setzero_ps(), _CMP_GE_OQ));
+
+  return _mm256_blendv_ps(_mm256_set1_ps(FLT_MAX), tn, m);
+}
+
+CGLM_INLINE
+size_t
+glm_ray_triangles_soa_avx(vec3         origin,
+                          vec3         dir,
+                          const float *tri,
+                          size_t       stride,
+                          size_t       count,
+                          float       *d,
+                          int         *any) {
+  __m256 o[3], r[3], v[9], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    o[k] = _mm256_set1_ps(origin[k]);
+    r[k] = _mm256_set1_ps(dir[k]);
+  }
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 9; k++)
+      v[k] = _mm256_loadu_ps(tri + k * stride + i);
+
+    x = glmm256_ray_triangle(o, r, v, v + 3, v + 6);
+    *any |= _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_set1_ps(FLT_MAX),
+                                             _CMP_LT_OQ));
+    _mm256_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_rays_triangle_soa_avx(const float *rays,
+                          size_t       stride,
+                          size_t       count,
+                          vec3         v0,
+                          vec3         v1,
+                          vec3         v2,
+                          float       *d,
+                          int         *any) {
+  __m256 a[3], b[3], c[3], r[6], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    a[k] = _mm256_set1_ps(v0[k]);
+    b[k] = _mm256_set1_ps(v1[k]);
+    c[k] = _mm256_set1_ps(v2[k]);
+  }
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 6; k++)
+      r[k] = _mm256_loadu_ps(rays + k * stride + i);
+
+    x = glmm256_ray_triangle(r, r + 3, a, b, c);
+    *any |= _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_set1_ps(FLT_MAX),
+                                             _CMP_LT_OQ));
+    _mm256_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_ray_aabbs_soa_avx(vec3         origin,
+                      vec3         dir,
+                      const float *boxes,
+                      size_t       stride,
+                      size_t       count,
+                      float       *d,
+                      int         *any) {
+  __m256 o[3], inv[3], b[6], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    o[k]   = _mm256_set1_ps(origin[k]);
+    inv[k] = _mm256_set1_ps(1.0f / dir[k]);
+  }
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 6; k++)
+      b[k] = _mm256_loadu_ps(boxes + k * stride + i);
+
+    x = glmm256_ray_aabb(o, inv, b, b + 3);
+    *any |= _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_set1_ps(FLT_MAX),
+                                             _CMP_LT_OQ));
+    _mm256_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_rays_aabb_soa_avx(const float *rays,
+                      size_t       stride,
+                      size_t       count,
+                      vec3         box[2],
+                      float       *d,
+                      int         *any) {
+  __m256 lo[3], hi[3], o[3], inv[3], one, x;
+  size_t i;
+  int    k;
+
+  one = _mm256_set1_ps(1.0f);
+
+  for (k = 0; k < 3; k++) {
+    lo[k] = _mm256_set1_ps(box[0][k]);
+    hi[k] = _mm256_set1_ps(box[1][k]);
+  }
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    for (k = 0; k < 3; k++) {
+      o[k]   = _mm256_loadu_ps(rays + k * stride + i);
+      inv[k] = _mm256_div_ps(one,
+                             _mm256_loadu_ps(rays + (k + 3) * stride + i));
+    }
+
+    x = glmm256_ray_aabb(o, inv, lo, hi);
+    *any |= _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_set1_ps(FLT_MAX),
+                                             _CMP_LT_OQ));
+    _mm256_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_ray_avx_h */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_sincos_avx_h
+#define cglm_sincos_avx_h
+#ifdef __AVX2__
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "../sse2/sincos.h"
+
+#include <immintrin.h>
+
+/* 8-lane versions of glmm_sincos* and glmm_acos, quadrant bits need AVX2 */
+
+static inline
+void
+glmm256_sincos_quadrant(__m256i q, __m256 ps, __m256 pc, __m256 *s, __m256 *c) {
+  __m256i one, two;
+  __m256  swap, ss, sc;
+
+  one  = _mm256_set1_epi32(1);
+  two  = _mm256_set1_epi32(2);
+
+  swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+  ss   = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+  sc   = _mm256_castsi256_ps(
+           _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+
+  *s = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), ss);
+  *c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), sc);
+}
+
+static inline
+void
+glmm256_sincos(__m256 x, __m256 *s, __m256 *c) {
+  __m256i q;
+  __m256  r, z, ps, pc;
+
+  q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(GLM_2_PIf)));
+  z = _mm256_cvtepi32_ps(q);
+
+  r = glmm256_fnmadd(z, _mm256_set1_ps(CGLM_SINCOS_PIO2_1), x);
+  r = glmm256_fnmadd(z, _mm256_set1_ps(CGLM_SINCOS_PIO2_2), r);
+  r = glmm256_fnmadd(z, _mm256_set1_ps(CGLM_SINCOS_PIO2_3), r);
+  z = _mm256_mul_ps(r, r);
+
+  ps = glmm256_fmadd(z, _mm256_set1_ps(CGLM_SINCOS_S3),
+                     _mm256_set1_ps(CGLM_SINCOS_S2));
+  ps = glmm256_fmadd(ps, z, _mm256_set1_ps(CGLM_SINCOS_S1));
+  ps = glmm256_fmadd(ps, _mm256_mul_ps(z, r), r);
+
+  pc = glmm256_fmadd(z, _mm256_set1_ps(CGLM_SINCOS_C3),
+                     _mm256_set1_ps(CGLM_SINCOS_C2));
+  pc = glmm256_fmadd(pc, z, _mm256_set1_ps(CGLM_SINCOS_C1));
+  pc = glmm256_fmadd(pc, _mm256_mul_ps(z, z),
+                     glmm256_fnmadd(z, _mm256_set1_ps(0.5f),
+                                    _mm256_set1_ps(1.0f)));
+
+  glmm256_sincos_quadrant(q, ps, pc, s, c);
+}
+
+static inline
+void
+glmm256_sincos_fast(__m256 x, __m256 *s, __m256 *c) {
+  __m256i q;
+  __m256  r, z, ps, pc;
+
+  q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(GLM_2_PIf)));
+  r = glmm256_fnmadd(_mm256_cvtepi32_ps(q), _mm256_set1_ps(GLM_PI_2f), x);
+  z = _mm256_mul_ps(r, r);
+
+  ps = glmm256_fmadd(z, _mm256_set1_ps(CGLM_SINCOS_FAST_S2),
+                     _mm256_set1_ps(CGLM_SINCOS_FAST_S1));
+  ps = glmm256_fmadd(ps, _mm256_mul_ps(z, r), r);
+
+  pc = glmm256_fmadd(z, _mm256_set1_ps(CGLM_SINCOS_FAST_C2),
+                     _mm256_set1_ps(CGLM_SINCOS_FAST_C1));
+  pc = glmm256_fmadd(pc, z, _mm256_set1_ps(1.0f));
+
+  glmm256_sincos_quadrant(q, ps, pc, s, c);
+}
+
+static inline
+__m256
+glmm256_acos(__m256 x) {
+  __m256 a, z, v, p, big;
+
+  a   = _mm256_andnot_ps(glmm_float32x8_SIGNMASK_NEG, x);
+  big = _mm256_cmp_ps(a, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+  z   = _mm256_blendv_ps(_mm256_mul_ps(a, a),
+                         glmm256_fnmadd(a, _mm256_set1_ps(0.5f),
+                                        _mm256_set1_ps(0.5f)), big);
+  v   = _mm256_blendv_ps(a, _mm256_sqrt_ps(z), big);
+
+  p = glmm256_fmadd(z, _mm256_set1_ps(CGLM_ASIN_P0),
+                    _mm256_set1_ps(CGLM_ASIN_P1));
+  p = glmm256_fmadd(p, z, _mm256_set1_ps(CGLM_ASIN_P2));
+  p = glmm256_fmadd(p, z, _mm256_set1_ps(CGLM_ASIN_P3));
+  p = glmm256_fmadd(p, z, _mm256_set1_ps(CGLM_ASIN_P4));
+  p = glmm256_fmadd(p, _mm256_mul_ps(z, v), v);
+
+  p = _mm256_blendv_ps(_mm256_sub_ps(_mm256_set1_ps(GLM_PI_2f), p),
+                       _mm256_add_ps(p, p), big);
+
+  return _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(GLM_PIf), p),
+                          _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+}
+
+#endif
+#endif /* cglm_sincos_avx_h */
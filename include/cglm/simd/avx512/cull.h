@@ -0,0 +1,118 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_cull_avx512_h
+#define cglm_cull_avx512_h
+#ifdef __AVX512F__
+
+#include "../../common.h"
+#include "../intrin.h"
+
+#include <immintrin.h>
+
+/* visible indices are written with compress stores instead of per lane */
+
+CGLM_INLINE
+size_t
+glm_aabb_frustum_soa_avx512(const float *bounds,
+                            size_t       stride,
+                            size_t       first,
+                            size_t       count,
+                            vec4         planes[6],
+                            uint32_t    *visible,
+                            size_t      *n) {
+  __m512    p[6][4], a[6][3], c[3], e[3], d, r, zero;
+  __m512i   idx, step;
+  __mmask16 m;
+  size_t    i;
+  int       j, k;
+
+  for (j = 0; j < 6; j++) {
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm512_set1_ps(planes[j][k]);
+    for (k = 0; k < 3; k++)
+      a[j][k] = _mm512_set1_ps(fabsf(planes[j][k]));
+  }
+
+  zero = _mm512_setzero_ps();
+  step = _mm512_set1_epi32(16);
+  idx  = _mm512_add_epi32(_mm512_set1_epi32((int)first),
+                          _mm512_setr_epi32(0, 1, 2,  3,  4,  5,  6,  7,
+                                            8, 9, 10, 11, 12, 13, 14, 15));
+
+  for (i = 0; i + 16 <= count; i += 16) {
+    for (k = 0; k < 3; k++) {
+      c[k] = _mm512_loadu_ps(bounds + k * stride + first + i);
+      e[k] = _mm512_loadu_ps(bounds + (k + 3) * stride + first + i);
+    }
+
+    m = 0xFFFF;
+    for (j = 0; j < 6; j++) {
+      d = _mm512_fmadd_ps(p[j][0], c[0], p[j][3]);
+      d = _mm512_fmadd_ps(p[j][1], c[1], d);
+      d = _mm512_fmadd_ps(p[j][2], c[2], d);
+      r = _mm512_mul_ps(a[j][0], e[0]);
+      r = _mm512_fmadd_ps(a[j][1], e[1], r);
+      r = _mm512_fmadd_ps(a[j][2], e[2], r);
+      m = _mm512_mask_cmp_ps_mask(m, _mm512_add_ps(d, r), zero, _CMP_GE_OQ);
+    }
+
+    _mm512_mask_compressstoreu_epi32(visible + *n, m, idx);
+    *n += (size_t)_mm_popcnt_u32(m);
+    idx = _mm512_add_epi32(idx, step);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_sphere_frustum_soa_avx512(const float *spheres,
+                              size_t       stride,
+                              size_t       first,
+                              size_t       count,
+                              vec4         planes[6],
+                              uint32_t    *visible,
+                              size_t      *n) {
+  __m512    p[6][4], s[4], d;
+  __m512i   idx, step;
+  __mmask16 m;
+  size_t    i;
+  int       j, k;
+
+  for (j = 0; j < 6; j++)
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm512_set1_ps(planes[j][k]);
+
+  step = _mm512_set1_epi32(16);
+  idx  = _mm512_add_epi32(_mm512_set1_epi32((int)first),
+                          _mm512_setr_epi32(0, 1, 2,  3,  4,  5,  6,  7,
+                                            8, 9, 10, 11, 12, 13, 14, 15));
+
+  for (i = 0; i + 16 <= count; i += 16) {
+    for (k = 0; k < 4; k++)
+      s[k] = _mm512_loadu_ps(spheres + k * stride + first + i);
+
+    s[3] = _mm512_sub_ps(_mm512_setzero_ps(), s[3]);
+    m    = 0xFFFF;
+    for (j = 0; j < 6; j++) {
+      d = _mm512_fmadd_ps(p[j][0], s[0], p[j][3]);
+      d = _mm512_fmadd_ps(p[j][1], s[1], d);
+      d = _mm512_fmadd_ps(p[j][2], s[2], d);
+      m = _mm512_mask_cmp_ps_mask(m, d, s[3], _CMP_GE_OQ);
+    }
+
+    _mm512_mask_compressstoreu_epi32(visible + *n, m, idx);
+    *n += (size_t)_mm_popcnt_u32(m);
+    idx = _mm512_add_epi32(idx, step);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_cull_avx512_h */
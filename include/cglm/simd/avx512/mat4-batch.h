@@ -0,0 +1,144 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_mat4_batch_simd_avx512_h
+#define cglm_mat4_batch_simd_avx512_h
+#ifdef __AVX512F__
+
+#include "../../common.h"
+#include "../intrin.h"
+
+#include <immintrin.h>
+
+CGLM_INLINE
+void
+glm_mat4_mul_batch_avx512(mat4 *m1, mat4 *m2, mat4 *dest, size_t count) {
+  /* one matrix per iteration, whole in one register, m1 columns repeated in
+     every 128-bit lane */
+  __m512 z0, z1, z2, z3, b, d;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    z0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m1[i][0]));
+    z1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m1[i][1]));
+    z2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m1[i][2]));
+    z3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m1[i][3]));
+    b  = _mm512_loadu_ps(m2[i][0]);
+
+    d = _mm512_mul_ps(z0, _mm512_permute_ps(b, 0x00));
+    d = _mm512_fmadd_ps(z1, _mm512_permute_ps(b, 0x55), d);
+    d = _mm512_fmadd_ps(z2, _mm512_permute_ps(b, 0xAA), d);
+    d = _mm512_fmadd_ps(z3, _mm512_permute_ps(b, 0xFF), d);
+
+    _mm512_storeu_ps(dest[i][0], d);
+  }
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mulv_batch_avx512(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  /* four vectors per register */
+  __m512 z0, z1, z2, z3, x, d;
+  size_t i;
+
+  z0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m[0]));
+  z1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m[1]));
+  z2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m[2]));
+  z3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m[3]));
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = _mm512_loadu_ps(v[i]);
+
+    d = _mm512_mul_ps(z0, _mm512_permute_ps(x, 0x00));
+    d = _mm512_fmadd_ps(z1, _mm512_permute_ps(x, 0x55), d);
+    d = _mm512_fmadd_ps(z2, _mm512_permute_ps(x, 0xAA), d);
+    d = _mm512_fmadd_ps(z3, _mm512_permute_ps(x, 0xFF), d);
+
+    _mm512_storeu_ps(dest[i], d);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mul_soa_avx512(const float *m1,
+                        const float *m2,
+                        float *dest,
+                        size_t stride,
+                        size_t count) {
+  __m512 a[16], b[4], x0;
+  size_t i;
+  int    c, j;
+
+  for (i = 0; i + 16 <= count; i += 16) {
+    for (c = 0; c < 16; c++)
+      a[c] = _mm512_loadu_ps(m1 + c * stride + i);
+
+    /* dest column c only depends on column c of m2, so dest may alias m2 */
+    for (c = 0; c < 4; c++) {
+      for (j = 0; j < 4; j++)
+        b[j] = _mm512_loadu_ps(m2 + (c * 4 + j) * stride + i);
+
+      for (j = 0; j < 4; j++) {
+        x0 = _mm512_mul_ps(a[j], b[0]);
+        x0 = _mm512_fmadd_ps(a[4 + j],  b[1], x0);
+        x0 = _mm512_fmadd_ps(a[8 + j],  b[2], x0);
+        x0 = _mm512_fmadd_ps(a[12 + j], b[3], x0);
+        _mm512_storeu_ps(dest + (c * 4 + j) * stride + i, x0);
+      }
+    }
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_mulv3_soa_avx512(mat4 m,
+                          const float *v,
+                          float last,
+                          float *dest,
+                          size_t stride,
+                          size_t count) {
+  __m512 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m512 x, y, z;
+  size_t i;
+
+  m00 = _mm512_set1_ps(m[0][0]); m01 = _mm512_set1_ps(m[0][1]);
+  m02 = _mm512_set1_ps(m[0][2]); m10 = _mm512_set1_ps(m[1][0]);
+  m11 = _mm512_set1_ps(m[1][1]); m12 = _mm512_set1_ps(m[1][2]);
+  m20 = _mm512_set1_ps(m[2][0]); m21 = _mm512_set1_ps(m[2][1]);
+  m22 = _mm512_set1_ps(m[2][2]);
+  t0  = _mm512_set1_ps(m[3][0] * last);
+  t1  = _mm512_set1_ps(m[3][1] * last);
+  t2  = _mm512_set1_ps(m[3][2] * last);
+
+  for (i = 0; i + 16 <= count; i += 16) {
+    x = _mm512_loadu_ps(v + i);
+    y = _mm512_loadu_ps(v + stride + i);
+    z = _mm512_loadu_ps(v + 2 * stride + i);
+
+    _mm512_storeu_ps(dest + i,
+                     _mm512_fmadd_ps(m20, z,
+                                     _mm512_fmadd_ps(m10, y,
+                                                     _mm512_fmadd_ps(m00, x, t0))));
+    _mm512_storeu_ps(dest + stride + i,
+                     _mm512_fmadd_ps(m21, z,
+                                     _mm512_fmadd_ps(m11, y,
+                                                     _mm512_fmadd_ps(m01, x, t1))));
+    _mm512_storeu_ps(dest + 2 * stride + i,
+                     _mm512_fmadd_ps(m22, z,
+                                     _mm512_fmadd_ps(m12, y,
+                                                     _mm512_fmadd_ps(m02, x, t2))));
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_mat4_batch_simd_avx512_h */
@@ -72,6 +72,10 @@
 #  endif
 #endif
 
+#ifdef __AVX512F__
+#  define CGLM_AVX512_FP 1
+#endif
+
 /* ARM Neon */
 #if defined(_WIN32) && defined(_MSC_VER)
 /* TODO: non-ARM stuff already inported, will this be better option */
@@ -111,5 +111,50 @@ glm_inv_tr_sse2(mat4 mat) {
   glmm_store(mat[3], x0);
 }
 
+
+CGLM_INLINE
+void
+glm_inv_affine_sse2(mat4 mat, mat4 dest) {
+  __m128 r0, r1, r2, r3, x0, x1, x2, x3, x4, x5;
+
+  r0 = glmm_load(mat[0]);
+  r1 = glmm_load(mat[1]);
+  r2 = glmm_load(mat[2]);
+  r3 = glmm_load(mat[3]);
+
+  /* a x b = (a * b.yzx - a.yzx * b).yzx, w stays 0 */
+  x3 = glmm_shuff1(r0, 3, 0, 2, 1);
+  x4 = glmm_shuff1(r1, 3, 0, 2, 1);
+  x5 = glmm_shuff1(r2, 3, 0, 2, 1);
+
+  /* rows of adj(R): r1 x r2, r2 x r0, r0 x r1 */
+  x0 = glmm_fmsub(r1, x5, _mm_mul_ps(x4, r2));
+  x1 = glmm_fmsub(r2, x3, _mm_mul_ps(x5, r0));
+  x2 = glmm_fmsub(r0, x4, _mm_mul_ps(x3, r1));
+
+  x0 = glmm_shuff1(x0, 3, 0, 2, 1);
+  x1 = glmm_shuff1(x1, 3, 0, 2, 1);
+  x2 = glmm_shuff1(x2, 3, 0, 2, 1);
+
+  /* 1 / det(R), det(R) = r0 . (r1 x r2) */
+  x3 = glmm_div(_mm_set1_ps(1.0f), glmm_vhadd(_mm_mul_ps(r0, x0)));
+
+  x0 = _mm_mul_ps(x0, x3);
+  x1 = _mm_mul_ps(x1, x3);
+  x2 = _mm_mul_ps(x2, x3);
+  x3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+  _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+
+  /* -R'T */
+  x4 = glmm_fnmadd(x2, glmm_splat(r3, 2), x3);
+  x4 = glmm_fnmadd(x1, glmm_splat(r3, 1), x4);
+  x4 = glmm_fnmadd(x0, glmm_splat(r3, 0), x4);
+
+  glmm_store(dest[0], x0);
+  glmm_store(dest[1], x1);
+  glmm_store(dest[2], x2);
+  glmm_store(dest[3], x4);
+}
 #endif
 #endif /* cglm_affine_mat_sse2_h */
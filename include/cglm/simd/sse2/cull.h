@@ -0,0 +1,197 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_cull_sse2_h
+#define cglm_cull_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "pack.h"
+
+/*
+ * culling kernels, see cull.h for the layouts. Each handles items
+ * [first, first + count) in whole groups, appends visible indices to
+ * visible[*n] and returns how many items it processed.
+ */
+
+/*!
+ * @brief append indices of set mask bits, branch free
+ */
+static inline
+void
+glm__cull_append(int mask, int lanes, uint32_t index,
+                 uint32_t *visible, size_t *n) {
+  size_t c;
+  int    k;
+
+  c = *n;
+  for (k = 0; k < lanes; k++) {
+    visible[c] = index + (uint32_t)k;
+    c         += (size_t)((mask >> k) & 1);
+  }
+  *n = c;
+}
+
+CGLM_INLINE
+size_t
+glm_aabb_frustum_soa_sse2(const float *bounds,
+                          size_t       stride,
+                          size_t       first,
+                          size_t       count,
+                          vec4         planes[6],
+                          uint32_t    *visible,
+                          size_t      *n) {
+  __m128 p[6][4], a[6][3], c[3], e[3], d, r, m, zero;
+  size_t i;
+  int    j, k;
+
+  for (j = 0; j < 6; j++) {
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm_set1_ps(planes[j][k]);
+    for (k = 0; k < 3; k++)
+      a[j][k] = _mm_set1_ps(fabsf(planes[j][k]));
+  }
+
+  zero = _mm_setzero_ps();
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 3; k++) {
+      c[k] = _mm_loadu_ps(bounds + k * stride + first + i);
+      e[k] = _mm_loadu_ps(bounds + (k + 3) * stride + first + i);
+    }
+
+    m = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (j = 0; j < 6; j++) {
+      d = glmm_fmadd(p[j][0], c[0], p[j][3]);
+      d = glmm_fmadd(p[j][1], c[1], d);
+      d = glmm_fmadd(p[j][2], c[2], d);
+      r = _mm_mul_ps(a[j][0], e[0]);
+      r = glmm_fmadd(a[j][1], e[1], r);
+      r = glmm_fmadd(a[j][2], e[2], r);
+      m = _mm_and_ps(m, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+    }
+
+    glm__cull_append(_mm_movemask_ps(m), 4, (uint32_t)(first + i),
+                     visible, n);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_sphere_frustum_soa_sse2(const float *spheres,
+                            size_t       stride,
+                            size_t       first,
+                            size_t       count,
+                            vec4         planes[6],
+                            uint32_t    *visible,
+                            size_t      *n) {
+  __m128 p[6][4], s[4], d, m;
+  size_t i;
+  int    j, k;
+
+  for (j = 0; j < 6; j++)
+    for (k = 0; k < 4; k++)
+      p[j][k] = _mm_set1_ps(planes[j][k]);
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 4; k++)
+      s[k] = _mm_loadu_ps(spheres + k * stride + first + i);
+
+    /* -r <= n . c + w */
+    s[3] = _mm_xor_ps(s[3], glmm_float32x4_SIGNMASK_NEG);
+    m    = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (j = 0; j < 6; j++) {
+      d = glmm_fmadd(p[j][0], s[0], p[j][3]);
+      d = glmm_fmadd(p[j][1], s[1], d);
+      d = glmm_fmadd(p[j][2], s[2], d);
+      m = _mm_and_ps(m, _mm_cmpge_ps(d, s[3]));
+    }
+
+    glm__cull_append(_mm_movemask_ps(m), 4, (uint32_t)(first + i),
+                     visible, n);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_aabb_transform_soa_sse2(const float *src,
+                            size_t       stride,
+                            mat4        *m,
+                            float       *dest,
+                            size_t       count) {
+  __m128 c[3], e[3], a[4][4], x, y;
+  size_t i;
+  int    j, k;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 3; k++) {
+      c[k] = _mm_loadu_ps(src + k * stride + i);
+      e[k] = _mm_loadu_ps(src + (k + 3) * stride + i);
+    }
+    for (k = 0; k < 4; k++)
+      glmm_load_vec4x4(m[i][k], 16, a[k]);
+
+    for (j = 0; j < 3; j++) {
+      x = glmm_fmadd(a[0][j], c[0], a[3][j]);
+      x = glmm_fmadd(a[1][j], c[1], x);
+      x = glmm_fmadd(a[2][j], c[2], x);
+      y = _mm_mul_ps(glmm_abs(a[0][j]), e[0]);
+      y = glmm_fmadd(glmm_abs(a[1][j]), e[1], y);
+      y = glmm_fmadd(glmm_abs(a[2][j]), e[2], y);
+      _mm_storeu_ps(dest + j * stride + i,       x);
+      _mm_storeu_ps(dest + (j + 3) * stride + i, y);
+    }
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_sphere_transform_soa_sse2(const float *src,
+                              size_t       stride,
+                              mat4        *m,
+                              float       *dest,
+                              size_t       count) {
+  __m128 s[4], a[4][4], x, ss;
+  size_t i;
+  int    j, k;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 4; k++) {
+      s[k] = _mm_loadu_ps(src + k * stride + i);
+      glmm_load_vec4x4(m[i][k], 16, a[k]);
+    }
+
+    /* largest squared axis scale */
+    ss = _mm_setzero_ps();
+    for (k = 0; k < 3; k++) {
+      x  = _mm_mul_ps(a[k][0], a[k][0]);
+      x  = glmm_fmadd(a[k][1], a[k][1], x);
+      x  = glmm_fmadd(a[k][2], a[k][2], x);
+      ss = _mm_max_ps(ss, x);
+    }
+
+    for (j = 0; j < 3; j++) {
+      x = glmm_fmadd(a[0][j], s[0], a[3][j]);
+      x = glmm_fmadd(a[1][j], s[1], x);
+      x = glmm_fmadd(a[2][j], s[2], x);
+      _mm_storeu_ps(dest + j * stride + i, x);
+    }
+    _mm_storeu_ps(dest + 3 * stride + i, _mm_mul_ps(s[3], _mm_sqrt_ps(ss)));
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_cull_sse2_h */
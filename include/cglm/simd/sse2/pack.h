@@ -0,0 +1,289 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_pack_sse2_h
+#define cglm_pack_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+
+/*
+ * AoS kernels for the compact transform formats, see pack.h. Kernels which
+ * return a count only handle whole groups of four, the caller finishes the
+ * rest.
+ */
+
+/*!
+ * @brief load four vec4 which are step floats apart as x, y, z, w registers
+ */
+static inline
+void
+glmm_load_vec4x4(const float *p, size_t step, __m128 r[4]) {
+  r[0] = _mm_loadu_ps(p);
+  r[1] = _mm_loadu_ps(p + step);
+  r[2] = _mm_loadu_ps(p + 2 * step);
+  r[3] = _mm_loadu_ps(p + 3 * step);
+  _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+}
+
+/*!
+ * @brief inverse of glmm_load_vec4x4
+ */
+static inline
+void
+glmm_store_vec4x4(float *p, size_t step, __m128 r0, __m128 r1,
+                  __m128 r2, __m128 r3) {
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps(p,            r0);
+  _mm_storeu_ps(p + step,     r1);
+  _mm_storeu_ps(p + 2 * step, r2);
+  _mm_storeu_ps(p + 3 * step, r3);
+}
+
+/*!
+ * @brief quaternions from SoA rotation matrices, m[c * 3 + r] is m[c][r]
+ *
+ * same case selection as glm_mat4_quat, done with blends
+ */
+static inline
+void
+glmm_quat_from_rot(__m128 m[9], __m128 q[4]) {
+  __m128 one, tr, t, tc, a, b, c, d, e, f, x, y, z, w, k;
+
+  one = _mm_set1_ps(1.0f);
+  tr  = _mm_add_ps(_mm_add_ps(m[0], m[4]), m[8]);
+
+  a = _mm_sub_ps(m[5], m[7]);   /* m12 - m21 */
+  b = _mm_sub_ps(m[6], m[2]);   /* m20 - m02 */
+  c = _mm_sub_ps(m[1], m[3]);   /* m01 - m10 */
+  d = _mm_add_ps(m[1], m[3]);   /* m01 + m10 */
+  e = _mm_add_ps(m[2], m[6]);   /* m02 + m20 */
+  f = _mm_add_ps(m[5], m[7]);   /* m12 + m21 */
+
+  /* z is largest */
+  t = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, m[0]), m[4]), m[8]);
+  x = e; y = f; z = t; w = c;
+
+  /* y is largest */
+  k  = _mm_cmpge_ps(m[4], m[8]);
+  tc = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, m[0]), m[8]), m[4]);
+  t  = glmm_blendv(t, tc, k);
+  x  = glmm_blendv(x, d,  k);
+  y  = glmm_blendv(y, tc, k);
+  z  = glmm_blendv(z, f,  k);
+  w  = glmm_blendv(w, b,  k);
+
+  /* x is largest */
+  k  = _mm_and_ps(_mm_cmpge_ps(m[0], m[4]), _mm_cmpge_ps(m[0], m[8]));
+  tc = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, m[4]), m[8]), m[0]);
+  t  = glmm_blendv(t, tc, k);
+  x  = glmm_blendv(x, tc, k);
+  y  = glmm_blendv(y, d,  k);
+  z  = glmm_blendv(z, e,  k);
+  w  = glmm_blendv(w, a,  k);
+
+  /* w is largest */
+  k  = _mm_cmpge_ps(tr, _mm_setzero_ps());
+  tc = _mm_add_ps(one, tr);
+  t  = glmm_blendv(t, tc, k);
+  x  = glmm_blendv(x, a,  k);
+  y  = glmm_blendv(y, b,  k);
+  z  = glmm_blendv(z, c,  k);
+  w  = glmm_blendv(w, tc, k);
+
+  /* 0.5 / sqrt(t) * t is the 0.5 * sqrt(t) of the largest component */
+  k = _mm_div_ps(_mm_set1_ps(0.5f), _mm_sqrt_ps(t));
+
+  q[0] = _mm_mul_ps(x, k);
+  q[1] = _mm_mul_ps(y, k);
+  q[2] = _mm_mul_ps(z, k);
+  q[3] = _mm_mul_ps(w, k);
+}
+
+CGLM_INLINE
+void
+glm_mat4_pack3x4_batch_sse2(mat4 *m, mat3x4 *dest, size_t count) {
+  __m128 r0, r1, r2, r3;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    r0 = _mm_loadu_ps(m[i][0]);
+    r1 = _mm_loadu_ps(m[i][1]);
+    r2 = _mm_loadu_ps(m[i][2]);
+    r3 = _mm_loadu_ps(m[i][3]);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(dest[i][0], r0);
+    _mm_storeu_ps(dest[i][1], r1);
+    _mm_storeu_ps(dest[i][2], r2);
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_unpack3x4_batch_sse2(mat3x4 *src, mat4 *dest, size_t count) {
+  __m128 r0, r1, r2, r3;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    r0 = _mm_loadu_ps(src[i][0]);
+    r1 = _mm_loadu_ps(src[i][1]);
+    r2 = _mm_loadu_ps(src[i][2]);
+    r3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(dest[i][0], r0);
+    _mm_storeu_ps(dest[i][1], r1);
+    _mm_storeu_ps(dest[i][2], r2);
+    _mm_storeu_ps(dest[i][3], r3);
+  }
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_pack_qts_batch_sse2(mat4 *m, vec4 *dest, size_t count) {
+  __m128 c0[4], c1[4], c2[4], t[4], r[9], q[4], s, is;
+  size_t i;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    glmm_load_vec4x4(m[i][0], 16, c0);
+    glmm_load_vec4x4(m[i][1], 16, c1);
+    glmm_load_vec4x4(m[i][2], 16, c2);
+    glmm_load_vec4x4(m[i][3], 16, t);
+
+    s  = _mm_mul_ps(c0[0], c0[0]);
+    s  = glmm_fmadd(c0[1], c0[1], s);
+    s  = glmm_fmadd(c0[2], c0[2], s);
+    s  = _mm_sqrt_ps(s);
+    is = _mm_and_ps(_mm_cmpgt_ps(s, _mm_setzero_ps()),
+                    _mm_div_ps(_mm_set1_ps(1.0f), s));
+
+    r[0] = _mm_mul_ps(c0[0], is);
+    r[1] = _mm_mul_ps(c0[1], is);
+    r[2] = _mm_mul_ps(c0[2], is);
+    r[3] = _mm_mul_ps(c1[0], is);
+    r[4] = _mm_mul_ps(c1[1], is);
+    r[5] = _mm_mul_ps(c1[2], is);
+    r[6] = _mm_mul_ps(c2[0], is);
+    r[7] = _mm_mul_ps(c2[1], is);
+    r[8] = _mm_mul_ps(c2[2], is);
+
+    glmm_quat_from_rot(r, q);
+
+    glmm_store_vec4x4(dest[2 * i],     8, q[0], q[1], q[2], q[3]);
+    glmm_store_vec4x4(dest[2 * i + 1], 8, t[0], t[1], t[2], s);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_mat4_unpack_qts_batch_sse2(vec4 *src, mat4 *dest, size_t count) {
+  __m128 q[4], t[4], zero, s, xx, yy, zz, xy, yz, xz, wx, wy, wz;
+  __m128 r0, r1, r2;
+  size_t i;
+
+  zero = _mm_setzero_ps();
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    glmm_load_vec4x4(src[2 * i],     8, q);
+    glmm_load_vec4x4(src[2 * i + 1], 8, t);
+
+    /* 2 * scale / |q|^2, so unnormalized (e.g. snorm16) rotations are fine */
+    s = _mm_mul_ps(q[0], q[0]);
+    s = glmm_fmadd(q[1], q[1], s);
+    s = glmm_fmadd(q[2], q[2], s);
+    s = glmm_fmadd(q[3], q[3], s);
+    s = _mm_and_ps(_mm_cmpgt_ps(s, zero),
+                   _mm_div_ps(_mm_add_ps(t[3], t[3]), s));
+
+    xx = _mm_mul_ps(_mm_mul_ps(s, q[0]), q[0]);
+    yy = _mm_mul_ps(_mm_mul_ps(s, q[1]), q[1]);
+    zz = _mm_mul_ps(_mm_mul_ps(s, q[2]), q[2]);
+    xy = _mm_mul_ps(_mm_mul_ps(s, q[0]), q[1]);
+    yz = _mm_mul_ps(_mm_mul_ps(s, q[1]), q[2]);
+    xz = _mm_mul_ps(_mm_mul_ps(s, q[0]), q[2]);
+    wx = _mm_mul_ps(_mm_mul_ps(s, q[3]), q[0]);
+    wy = _mm_mul_ps(_mm_mul_ps(s, q[3]), q[1]);
+    wz = _mm_mul_ps(_mm_mul_ps(s, q[3]), q[2]);
+
+    r0 = _mm_sub_ps(_mm_sub_ps(t[3], yy), zz);
+    r1 = _mm_add_ps(xy, wz);
+    r2 = _mm_sub_ps(xz, wy);
+    glmm_store_vec4x4(dest[i][0], 16, r0, r1, r2, zero);
+
+    r0 = _mm_sub_ps(xy, wz);
+    r1 = _mm_sub_ps(_mm_sub_ps(t[3], xx), zz);
+    r2 = _mm_add_ps(yz, wx);
+    glmm_store_vec4x4(dest[i][1], 16, r0, r1, r2, zero);
+
+    r0 = _mm_add_ps(xz, wy);
+    r1 = _mm_sub_ps(yz, wx);
+    r2 = _mm_sub_ps(_mm_sub_ps(t[3], xx), yy);
+    glmm_store_vec4x4(dest[i][2], 16, r0, r1, r2, zero);
+
+    glmm_store_vec4x4(dest[i][3], 16, t[0], t[1], t[2], _mm_set1_ps(1.0f));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_pack_snorm16_batch_sse2(versor *q, int16_t *dest, size_t count) {
+  __m128  k, lo, hi;
+  __m128i a, b;
+  size_t  i;
+
+  k  = _mm_set1_ps(32767.0f);
+  lo = _mm_set1_ps(-1.0f);
+  hi = _mm_set1_ps(1.0f);
+
+  for (i = 0; i + 2 <= count; i += 2) {
+    a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(
+          _mm_loadu_ps(q[i]), lo), hi), k));
+    b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(
+          _mm_loadu_ps(q[i + 1]), lo), hi), k));
+
+    _mm_storeu_si128((__m128i *)(dest + i * 4), _mm_packs_epi32(a, b));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_unpack_snorm16_batch_sse2(const int16_t *src, versor *dest,
+                                   size_t count) {
+  __m128  k, lo;
+  __m128i x;
+  size_t  i;
+
+  k  = _mm_set1_ps(1.0f / 32767.0f);
+  lo = _mm_set1_ps(-1.0f);
+
+  for (i = 0; i + 2 <= count; i += 2) {
+    x = _mm_loadu_si128((const __m128i *)(src + i * 4));
+
+    /* sign extend: move each short to the high half, shift back */
+    _mm_storeu_ps(dest[i],
+                  _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                    _mm_unpacklo_epi16(x, x), 16)), k), lo));
+    _mm_storeu_ps(dest[i + 1],
+                  _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                    _mm_unpackhi_epi16(x, x), 16)), k), lo));
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_pack_sse2_h */
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_quat_batch_sse2_h
+#define cglm_quat_batch_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+#include "sincos.h"
+
+/*
+ * SoA kernels, component k of quaternion i is at p[k * stride + i]. Each
+ * returns how many quaternions it processed, the caller finishes the rest.
+ */
+
+CGLM_INLINE
+size_t
+glm_quat_slerp_soa_sse2(const float *from,
+                        const float *to,
+                        const float *t,
+                        float       *dest,
+                        size_t       stride,
+                        size_t       count) {
+  __m128 a[4], b[4], x0, d, ad, th, sn, ts, tc, ca, cb, m;
+  size_t i;
+  int    k;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 4; k++) {
+      a[k] = _mm_loadu_ps(from + k * stride + i);
+      b[k] = _mm_loadu_ps(to   + k * stride + i);
+    }
+    x0 = _mm_loadu_ps(t + i);
+
+    d  = _mm_mul_ps(a[0], b[0]);
+    d  = glmm_fmadd(a[1], b[1], d);
+    d  = glmm_fmadd(a[2], b[2], d);
+    d  = glmm_fmadd(a[3], b[3], d);
+    ad = glmm_abs(d);
+
+    /* sin(theta), theta = acos(|d|), factored like glm_quat_slerp */
+    sn = _mm_sqrt_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), ad),
+                                           _mm_add_ps(_mm_set1_ps(1.0f), ad)),
+                                _mm_setzero_ps()));
+    th = glmm_acos(ad);
+
+    /* sin((1 - t) theta) / sin(theta), sin(t theta) / sin(theta), each
+       straight from its angle like glm_quat_slerp: going through
+       cos(t theta) - cos(theta) sin(t theta) cancels for close quaternions */
+    glmm_sincos(_mm_mul_ps(th, _mm_sub_ps(_mm_set1_ps(1.0f), x0)), &ts, &tc);
+    ca = _mm_div_ps(ts, sn);
+    glmm_sincos(_mm_mul_ps(th, x0), &ts, &tc);
+    cb = _mm_div_ps(ts, sn);
+
+    /* from is negated when the quaternions are in different hemispheres */
+    ca = _mm_xor_ps(ca, _mm_and_ps(d, glmm_float32x4_SIGNMASK_NEG));
+
+    /* lerp when sin(theta) is too small, copy from when |d| >= 1 */
+    m  = _mm_cmplt_ps(sn, _mm_set1_ps(0.001f));
+    ca = glmm_blendv(ca, _mm_sub_ps(_mm_set1_ps(1.0f), x0), m);
+    cb = glmm_blendv(cb, x0, m);
+
+    m  = _mm_cmpge_ps(ad, _mm_set1_ps(1.0f));
+    ca = glmm_blendv(ca, _mm_set1_ps(1.0f), m);
+    cb = _mm_andnot_ps(m, cb);
+
+    for (k = 0; k < 4; k++)
+      _mm_storeu_ps(dest + k * stride + i,
+                    glmm_fmadd(a[k], ca, _mm_mul_ps(b[k], cb)));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_nlerp_soa_sse2(const float *from,
+                        const float *to,
+                        const float *t,
+                        float       *dest,
+                        size_t       stride,
+                        size_t       count) {
+  __m128 a[4], b[4], x0, d, s, n;
+  size_t i;
+  int    k;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 4; k++) {
+      a[k] = _mm_loadu_ps(from + k * stride + i);
+      b[k] = _mm_loadu_ps(to   + k * stride + i);
+    }
+    x0 = _mm_loadu_ps(t + i);
+
+    d = _mm_mul_ps(a[0], b[0]);
+    d = glmm_fmadd(a[1], b[1], d);
+    d = glmm_fmadd(a[2], b[2], d);
+    d = glmm_fmadd(a[3], b[3], d);
+
+    /* shortest path: flip to when dot < 0 */
+    s = _mm_and_ps(_mm_cmplt_ps(d, _mm_setzero_ps()),
+                   glmm_float32x4_SIGNMASK_NEG);
+
+    n = _mm_setzero_ps();
+    for (k = 0; k < 4; k++) {
+      b[k] = glmm_fmadd(x0, _mm_sub_ps(_mm_xor_ps(b[k], s), a[k]), a[k]);
+      n    = glmm_fmadd(b[k], b[k], n);
+    }
+
+    /* normalize, zero length gives identity like glm_quat_normalize */
+    s = _mm_cmple_ps(n, _mm_setzero_ps());
+    n = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(n));
+
+    for (k = 0; k < 3; k++)
+      _mm_storeu_ps(dest + k * stride + i,
+                    _mm_andnot_ps(s, _mm_mul_ps(b[k], n)));
+
+    _mm_storeu_ps(dest + 3 * stride + i,
+                  glmm_blendv(_mm_mul_ps(b[3], n), _mm_set1_ps(1.0f), s));
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_quat_mat4_soa_sse2(const float *q,
+                       size_t       stride,
+                       mat4        *dest,
+                       size_t       count) {
+  __m128 x, y, z, w, s, xx, yy, zz, xy, yz, xz, wx, wy, wz, one, zero;
+  __m128 r0, r1, r2, r3;
+  size_t i;
+  int    k;
+
+  one  = _mm_set1_ps(1.0f);
+  zero = _mm_setzero_ps();
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = _mm_loadu_ps(q + i);
+    y = _mm_loadu_ps(q + stride + i);
+    z = _mm_loadu_ps(q + 2 * stride + i);
+    w = _mm_loadu_ps(q + 3 * stride + i);
+
+    /* s = 2 / norm, 0 for zero quaternions, see glm_quat_mat4 */
+    s = _mm_mul_ps(x, x);
+    s = glmm_fmadd(y, y, s);
+    s = glmm_fmadd(z, z, s);
+    s = glmm_fmadd(w, w, s);
+    s = _mm_sqrt_ps(s);
+    s = _mm_and_ps(_mm_cmpgt_ps(s, zero), _mm_div_ps(_mm_set1_ps(2.0f), s));
+
+    xx = _mm_mul_ps(_mm_mul_ps(s, x), x);
+    yy = _mm_mul_ps(_mm_mul_ps(s, y), y);
+    zz = _mm_mul_ps(_mm_mul_ps(s, z), z);
+    xy = _mm_mul_ps(_mm_mul_ps(s, x), y);
+    yz = _mm_mul_ps(_mm_mul_ps(s, y), z);
+    xz = _mm_mul_ps(_mm_mul_ps(s, x), z);
+    wx = _mm_mul_ps(_mm_mul_ps(s, w), x);
+    wy = _mm_mul_ps(_mm_mul_ps(s, w), y);
+    wz = _mm_mul_ps(_mm_mul_ps(s, w), z);
+
+    /* column 0 of four matrices */
+    r0 = _mm_sub_ps(_mm_sub_ps(one, yy), zz);
+    r1 = _mm_add_ps(xy, wz);
+    r2 = _mm_sub_ps(xz, wy);
+    r3 = zero;
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dest[i][0],     r0);
+    _mm_storeu_ps(dest[i + 1][0], r1);
+    _mm_storeu_ps(dest[i + 2][0], r2);
+    _mm_storeu_ps(dest[i + 3][0], r3);
+
+    r0 = _mm_sub_ps(xy, wz);
+    r1 = _mm_sub_ps(_mm_sub_ps(one, xx), zz);
+    r2 = _mm_add_ps(yz, wx);
+    r3 = zero;
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dest[i][1],     r0);
+    _mm_storeu_ps(dest[i + 1][1], r1);
+    _mm_storeu_ps(dest[i + 2][1], r2);
+    _mm_storeu_ps(dest[i + 3][1], r3);
+
+    r0 = _mm_add_ps(xz, wy);
+    r1 = _mm_sub_ps(yz, wx);
+    r2 = _mm_sub_ps(_mm_sub_ps(one, xx), yy);
+    r3 = zero;
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dest[i][2],     r0);
+    _mm_storeu_ps(dest[i + 1][2], r1);
+    _mm_storeu_ps(dest[i + 2][2], r2);
+    _mm_storeu_ps(dest[i + 3][2], r3);
+
+    r3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    for (k = 0; k < 4; k++)
+      _mm_storeu_ps(dest[i + k][3], r3);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_quat_batch_sse2_h */
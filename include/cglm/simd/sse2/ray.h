@@ -0,0 +1,231 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_ray_sse2_h
+#define cglm_ray_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+
+/*
+ * packet kernels, see ray-batch.h for the layouts. Each returns how many
+ * items it processed, ORs lanes which hit into *any, the caller finishes
+ * the rest.
+ */
+
+static inline
+void
+glmm_cross3(const __m128 a[3], const __m128 b[3], __m128 d[3]) {
+  d[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+  d[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+  d[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+}
+
+static inline
+__m128
+glmm_dot3(const __m128 a[3], const __m128 b[3]) {
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+                    _mm_mul_ps(a[2], b[2]));
+}
+
+/*!
+ * @brief glm_ray_triangle on four lanes, FLT_MAX where there is no hit
+ */
+static inline
+__m128
+glmm_ray_triangle(const __m128 o[3],
+                  const __m128 dir[3],
+                  const __m128 v0[3],
+                  const __m128 v1[3],
+                  const __m128 v2[3]) {
+  __m128 e1[3], e2[3], p[3], t[3], q[3], eps, one, det, inv, u, v, dist, m;
+  int    k;
+
+  eps = _mm_set1_ps(0.000001f);
+  one = _mm_set1_ps(1.0f);
+
+  for (k = 0; k < 3; k++) {
+    e1[k] = _mm_sub_ps(v1[k], v0[k]);
+    e2[k] = _mm_sub_ps(v2[k], v0[k]);
+    t[k]  = _mm_sub_ps(o[k],  v0[k]);
+  }
+
+  glmm_cross3(dir, e2, p);
+  det = glmm_dot3(e1, p);
+  inv = _mm_div_ps(one, det);
+
+  u = _mm_mul_ps(inv, glmm_dot3(t, p));
+  glmm_cross3(t, e1, q);
+  v = _mm_mul_ps(inv, glmm_dot3(dir, q));
+  dist = _mm_mul_ps(inv, glmm_dot3(e2, q));
+
+  m = _mm_cmpge_ps(glmm_abs(det), eps);
+  m = _mm_and_ps(m, _mm_cmpge_ps(u, _mm_setzero_ps()));
+  m = _mm_and_ps(m, _mm_cmple_ps(u, one));
+  m = _mm_and_ps(m, _mm_cmpge_ps(v, _mm_setzero_ps()));
+  m = _mm_and_ps(m, _mm_cmple_ps(_mm_add_ps(u, v), one));
+  m = _mm_and_ps(m, _mm_cmpgt_ps(dist, eps));
+
+  return glmm_blendv(_mm_set1_ps(FLT_MAX), dist, m);
+}
+
+/*!
+ * @brief slab test on four lanes, near distance or FLT_MAX where there is
+ *        no hit, inv is 1 / direction
+ */
+static inline
+__m128
+glmm_ray_aabb(const __m128 o[3],
+              const __m128 inv[3],
+              const __m128 bmin[3],
+              const __m128 bmax[3]) {
+  __m128 t0, t1, tn, tf, m;
+  int    k;
+
+  tn = _mm_set1_ps(-FLT_MAX);
+  tf = _mm_set1_ps(FLT_MAX);
+
+  for (k = 0; k < 3; k++) {
+    t0 = _mm_mul_ps(_mm_sub_ps(bmin[k], o[k]), inv[k]);
+    t1 = _mm_mul_ps(_mm_sub_ps(bmax[k], o[k]), inv[k]);
+    tn = _mm_max_ps(tn, _mm_min_ps(t0, t1));
+    tf = _mm_min_ps(tf, _mm_max_ps(t0, t1));
+  }
+
+  m = _mm_and_ps(_mm_cmpge_ps(tf, tn), _mm_cmpge_ps(tf, _mm_setzero_ps()));
+
+  return glmm_blendv(_mm_set1_ps(FLT_MAX), tn, m);
+}
+
+CGLM_INLINE
+size_t
+glm_ray_triangles_soa_sse2(vec3         origin,
+                           vec3         dir,
+                           const float *tri,
+                           size_t       stride,
+                           size_t       count,
+                           float       *d,
+                           int         *any) {
+  __m128 o[3], r[3], v[9], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    o[k] = _mm_set1_ps(origin[k]);
+    r[k] = _mm_set1_ps(dir[k]);
+  }
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 9; k++)
+      v[k] = _mm_loadu_ps(tri + k * stride + i);
+
+    x = glmm_ray_triangle(o, r, v, v + 3, v + 6);
+    *any |= _mm_movemask_ps(_mm_cmplt_ps(x, _mm_set1_ps(FLT_MAX)));
+    _mm_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_rays_triangle_soa_sse2(const float *rays,
+                           size_t       stride,
+                           size_t       count,
+                           vec3         v0,
+                           vec3         v1,
+                           vec3         v2,
+                           float       *d,
+                           int         *any) {
+  __m128 a[3], b[3], c[3], r[6], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    a[k] = _mm_set1_ps(v0[k]);
+    b[k] = _mm_set1_ps(v1[k]);
+    c[k] = _mm_set1_ps(v2[k]);
+  }
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 6; k++)
+      r[k] = _mm_loadu_ps(rays + k * stride + i);
+
+    x = glmm_ray_triangle(r, r + 3, a, b, c);
+    *any |= _mm_movemask_ps(_mm_cmplt_ps(x, _mm_set1_ps(FLT_MAX)));
+    _mm_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_ray_aabbs_soa_sse2(vec3         origin,
+                       vec3         dir,
+                       const float *boxes,
+                       size_t       stride,
+                       size_t       count,
+                       float       *d,
+                       int         *any) {
+  __m128 o[3], inv[3], b[6], x;
+  size_t i;
+  int    k;
+
+  for (k = 0; k < 3; k++) {
+    o[k]   = _mm_set1_ps(origin[k]);
+    inv[k] = _mm_set1_ps(1.0f / dir[k]);
+  }
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 6; k++)
+      b[k] = _mm_loadu_ps(boxes + k * stride + i);
+
+    x = glmm_ray_aabb(o, inv, b, b + 3);
+    *any |= _mm_movemask_ps(_mm_cmplt_ps(x, _mm_set1_ps(FLT_MAX)));
+    _mm_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+CGLM_INLINE
+size_t
+glm_rays_aabb_soa_sse2(const float *rays,
+                       size_t       stride,
+                       size_t       count,
+                       vec3         box[2],
+                       float       *d,
+                       int         *any) {
+  __m128 lo[3], hi[3], o[3], inv[3], one, x;
+  size_t i;
+  int    k;
+
+  one = _mm_set1_ps(1.0f);
+
+  for (k = 0; k < 3; k++) {
+    lo[k] = _mm_set1_ps(box[0][k]);
+    hi[k] = _mm_set1_ps(box[1][k]);
+  }
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (k = 0; k < 3; k++) {
+      o[k]   = _mm_loadu_ps(rays + k * stride + i);
+      inv[k] = _mm_div_ps(one, _mm_loadu_ps(rays + (k + 3) * stride + i));
+    }
+
+    x = glmm_ray_aabb(o, inv, lo, hi);
+    *any |= _mm_movemask_ps(_mm_cmplt_ps(x, _mm_set1_ps(FLT_MAX)));
+    _mm_storeu_ps(d + i, x);
+  }
+
+  return i;
+}
+
+#endif
+#endif /* cglm_ray_sse2_h */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_sincos_sse2_h
+#define cglm_sincos_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+
+/*
+ * x = r + q * pi/2, |r| <= pi/4. pi/2 is split in three parts (Cody-Waite)
+ * so q * PIO2_1 is exact, polynomials are Cephes' sinf / cosf minimax ones.
+ * fast versions use one reduction step and shorter polynomials.
+ */
+#define CGLM_SINCOS_PIO2_1 1.5703125f
+#define CGLM_SINCOS_PIO2_2 4.837512969970703125e-4f
+#define CGLM_SINCOS_PIO2_3 7.54978995489188216e-8f
+
+#define CGLM_SINCOS_S1    -1.6666654611e-1f
+#define CGLM_SINCOS_S2     8.3321608736e-3f
+#define CGLM_SINCOS_S3    -1.9515295891e-4f
+#define CGLM_SINCOS_C1     4.166664568298827e-2f
+#define CGLM_SINCOS_C2    -1.388731625493765e-3f
+#define CGLM_SINCOS_C3     2.443315711809948e-5f
+
+#define CGLM_SINCOS_FAST_S1 -1.6663390e-1f
+#define CGLM_SINCOS_FAST_S2  8.1632745e-3f
+#define CGLM_SINCOS_FAST_C1 -4.9977630e-1f
+#define CGLM_SINCOS_FAST_C2  4.0488931e-2f
+
+/* Cephes asinf, |x| <= 0.5 */
+#define CGLM_ASIN_P0 4.2163199048e-2f
+#define CGLM_ASIN_P1 2.4181311049e-2f
+#define CGLM_ASIN_P2 4.5470025998e-2f
+#define CGLM_ASIN_P3 7.4953002686e-2f
+#define CGLM_ASIN_P4 1.6666752422e-1f
+
+/* rotate (sin r, cos r) by quadrant q */
+static inline
+void
+glmm_sincos_quadrant(__m128i q, __m128 ps, __m128 pc, __m128 *s, __m128 *c) {
+  __m128i one, two;
+  __m128  swap, ss, sc;
+
+  one  = _mm_set1_epi32(1);
+  two  = _mm_set1_epi32(2);
+
+  swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+  ss   = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+  sc   = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one),
+                                                       two), 30));
+
+  *s = _mm_xor_ps(glmm_blendv(ps, pc, swap), ss);
+  *c = _mm_xor_ps(glmm_blendv(pc, ps, swap), sc);
+}
+
+/*!
+ * @brief sin and cos of 4 floats, ~1 ulp for |x| < 8192
+ */
+static inline
+void
+glmm_sincos(__m128 x, __m128 *s, __m128 *c) {
+  __m128i q;
+  __m128  r, z, ps, pc;
+
+  q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(GLM_2_PIf)));
+  z = _mm_cvtepi32_ps(q);
+
+  r = glmm_fnmadd(z, _mm_set1_ps(CGLM_SINCOS_PIO2_1), x);
+  r = glmm_fnmadd(z, _mm_set1_ps(CGLM_SINCOS_PIO2_2), r);
+  r = glmm_fnmadd(z, _mm_set1_ps(CGLM_SINCOS_PIO2_3), r);
+  z = _mm_mul_ps(r, r);
+
+  /* r + r^3 (S1 + z (S2 + z S3)) */
+  ps = glmm_fmadd(z, _mm_set1_ps(CGLM_SINCOS_S3), _mm_set1_ps(CGLM_SINCOS_S2));
+  ps = glmm_fmadd(ps, z, _mm_set1_ps(CGLM_SINCOS_S1));
+  ps = glmm_fmadd(ps, _mm_mul_ps(z, r), r);
+
+  /* 1 - z / 2 + z^2 (C1 + z (C2 + z C3)) */
+  pc = glmm_fmadd(z, _mm_set1_ps(CGLM_SINCOS_C3), _mm_set1_ps(CGLM_SINCOS_C2));
+  pc = glmm_fmadd(pc, z, _mm_set1_ps(CGLM_SINCOS_C1));
+  pc = glmm_fmadd(pc, _mm_mul_ps(z, z),
+                  glmm_fnmadd(z, _mm_set1_ps(0.5f), _mm_set1_ps(1.0f)));
+
+  glmm_sincos_quadrant(q, ps, pc, s, c);
+}
+
+/*!
+ * @brief sin and cos of 4 floats, ~2e-5 absolute error for |x| < 100
+ */
+static inline
+void
+glmm_sincos_fast(__m128 x, __m128 *s, __m128 *c) {
+  __m128i q;
+  __m128  r, z, ps, pc;
+
+  q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(GLM_2_PIf)));
+  r = glmm_fnmadd(_mm_cvtepi32_ps(q), _mm_set1_ps(GLM_PI_2f), x);
+  z = _mm_mul_ps(r, r);
+
+  ps = glmm_fmadd(z, _mm_set1_ps(CGLM_SINCOS_FAST_S2),
+                  _mm_set1_ps(CGLM_SINCOS_FAST_S1));
+  ps = glmm_fmadd(ps, _mm_mul_ps(z, r), r);
+
+  pc = glmm_fmadd(z, _mm_set1_ps(CGLM_SINCOS_FAST_C2),
+                  _mm_set1_ps(CGLM_SINCOS_FAST_C1));
+  pc = glmm_fmadd(pc, z, _mm_set1_ps(1.0f));
+
+  glmm_sincos_quadrant(q, ps, pc, s, c);
+}
+
+/*!
+ * @brief acos of 4 floats in [-1, 1], ~2 ulp
+ *
+ * acos(a) = 2 asin(sqrt((1 - a) / 2)) for a > 0.5, pi/2 - asin(a) otherwise
+ */
+static inline
+__m128
+glmm_acos(__m128 x) {
+  __m128 a, z, v, p, big;
+
+  a   = glmm_abs(x);
+  big = _mm_cmpgt_ps(a, _mm_set1_ps(0.5f));
+  z   = glmm_blendv(_mm_mul_ps(a, a),
+                    glmm_fnmadd(a, _mm_set1_ps(0.5f), _mm_set1_ps(0.5f)), big);
+  v   = glmm_blendv(a, _mm_sqrt_ps(z), big);
+
+  p = glmm_fmadd(z, _mm_set1_ps(CGLM_ASIN_P0), _mm_set1_ps(CGLM_ASIN_P1));
+  p = glmm_fmadd(p, z, _mm_set1_ps(CGLM_ASIN_P2));
+  p = glmm_fmadd(p, z, _mm_set1_ps(CGLM_ASIN_P3));
+  p = glmm_fmadd(p, z, _mm_set1_ps(CGLM_ASIN_P4));
+  p = glmm_fmadd(p, _mm_mul_ps(z, v), v);                 /* asin(v) */
+
+  p = glmm_blendv(_mm_sub_ps(_mm_set1_ps(GLM_PI_2f), p), _mm_add_ps(p, p), big);
+
+  /* acos(-a) = pi - acos(a) */
+  return glmm_blendv(p, _mm_sub_ps(_mm_set1_ps(GLM_PIf), p),
+                     _mm_cmplt_ps(x, _mm_setzero_ps()));
+}
+
+#endif
+#endif /* cglm_sincos_sse2_h */
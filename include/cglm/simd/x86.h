@@ -230,6 +230,17 @@ glmm_norm_inf(__m128 a) {
   return _mm_cvtss_f32(glmm_vhmax(glmm_abs(a)));
 }
 
+/* lanes of b where mask is set, otherwise a */
+static inline
+__m128
+glmm_blendv(__m128 a, __m128 b, __m128 mask) {
+#ifdef __SSE4_1__
+  return _mm_blendv_ps(a, b, mask);
+#else
+  return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+#endif
+}
+
 #if defined(__SSE2__)
 static inline
 __m128
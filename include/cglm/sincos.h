@@ -0,0 +1,143 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*!
+ * @brief sin and cos of many angles at once
+ *
+ * SSE2 computes 4 lanes and AVX2 8 lanes per step, otherwise sinf / cosf
+ * are called. Two accuracy targets:
+ *   glm_sincos_batch       ~1 ulp for |x| < 8192 (like sinf / cosf)
+ *   glm_sincos_batch_fast  ~2e-5 absolute error for |x| < 100, enough for
+ *                          building render transforms
+ * Batch builders (glm_rotate_make_batch, glm_euler_xyz_quat_batch ...) use
+ * the first one unless CGLM_SINCOS_FAST is defined.
+ */
+
+/*
+ Functions:
+   CGLM_INLINE void glm_sincos_batch(const float *x, float *s, float *c,
+                                     size_t count);
+   CGLM_INLINE void glm_sincos_batch_fast(const float *x, float *s, float *c,
+                                          size_t count);
+ */
+
+#ifndef cglm_sincos_h
+#define cglm_sincos_h
+
+#include "common.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/sincos.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/sincos.h"
+#endif
+
+#ifdef CGLM_SINCOS_FAST
+#  define glm__sincos_batch_default(x, s, c, n) glm_sincos_batch_fast(x, s, c, n)
+#else
+#  define glm__sincos_batch_default(x, s, c, n) glm_sincos_batch(x, s, c, n)
+#endif
+
+CGLM_INLINE
+void
+glm__sincos_batch(const float *x, float *s, float *c, size_t count, bool fast) {
+  size_t i;
+
+  i = 0;
+
+#if defined(__AVX2__)
+  {
+    __m256 ys, yc;
+    for (; i + 8 <= count; i += 8) {
+      if (fast)
+        glmm256_sincos_fast(_mm256_loadu_ps(x + i), &ys, &yc);
+      else
+        glmm256_sincos(_mm256_loadu_ps(x + i), &ys, &yc);
+
+      _mm256_storeu_ps(s + i, ys);
+      _mm256_storeu_ps(c + i, yc);
+    }
+  }
+#endif
+
+#if defined( __SSE__ ) || defined( __SSE2__ )
+  {
+    CGLM_ALIGN(16) float t[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    __m128 xs, xc;
+    size_t j, n;
+
+    for (; i + 4 <= count; i += 4) {
+      if (fast)
+        glmm_sincos_fast(_mm_loadu_ps(x + i), &xs, &xc);
+      else
+        glmm_sincos(_mm_loadu_ps(x + i), &xs, &xc);
+
+      _mm_storeu_ps(s + i, xs);
+      _mm_storeu_ps(c + i, xc);
+    }
+
+    /* the tail goes through the same kernel to give the same results */
+    if (i < count) {
+      n = count - i;
+      for (j = 0; j < n; j++)
+        t[j] = x[i + j];
+
+      if (fast)
+        glmm_sincos_fast(glmm_load(t), &xs, &xc);
+      else
+        glmm_sincos(glmm_load(t), &xs, &xc);
+
+      glmm_store(t, xs);
+      for (j = 0; j < n; j++)
+        s[i + j] = t[j];
+
+      glmm_store(t, xc);
+      for (j = 0; j < n; j++)
+        c[i + j] = t[j];
+    }
+  }
+#else
+  (void)fast;
+  for (; i < count; i++) {
+    float a = x[i];
+    s[i] = sinf(a);
+    c[i] = cosf(a);
+  }
+#endif
+}
+
+/*!
+ * @brief s[i] = sin(x[i]), c[i] = cos(x[i])
+ *
+ * @param[in]  x     angles in radians
+ * @param[out] s     sines, s or c may be x
+ * @param[out] c     cosines
+ * @param[in]  count number of angles
+ */
+CGLM_INLINE
+void
+glm_sincos_batch(const float *x, float *s, float *c, size_t count) {
+  glm__sincos_batch(x, s, c, count, false);
+}
+
+/*!
+ * @brief s[i] = sin(x[i]), c[i] = cos(x[i]) with less accuracy, see above
+ *
+ * @param[in]  x     angles in radians
+ * @param[out] s     sines, s or c may be x
+ * @param[out] c     cosines
+ * @param[in]  count number of angles
+ */
+CGLM_INLINE
+void
+glm_sincos_batch_fast(const float *x, float *s, float *c, size_t count) {
+  glm__sincos_batch(x, s, c, count, true);
+}
+
+#endif /* cglm_sincos_h */
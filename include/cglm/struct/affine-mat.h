@@ -10,6 +10,7 @@
    CGLM_INLINE mat4s glms_mul(mat4 m1, mat4 m2);
    CGLM_INLINE mat4s glms_mul_rot(mat4 m1, mat4 m2);
    CGLM_INLINE mat4s glms_inv_tr();
+   CGLM_INLINE mat4s glms_inv_affine(mat4s m);
  */
 
 #ifndef cglms_affine_mat_h
@@ -87,4 +88,18 @@ glms_inv_tr(mat4s m){
   glm_inv_tr(m.raw);
   return m;
 }
+
+/*!
+ * @brief inverse affine matrix (any invertible 3x3 part + translation)
+ *
+ * @param[in]  m  affine matrix
+ * @returns       inverse matrix
+ */
+CGLM_INLINE
+mat4s
+glms_inv_affine(mat4s m) {
+  mat4s r;
+  glm_inv_affine(m.raw, r.raw);
+  return r;
+}
 #endif /* cglms_affine_mat_h */
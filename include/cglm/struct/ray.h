@@ -11,6 +11,7 @@
 #include "../common.h"
 #include "../types-struct.h"
 #include "../ray.h"
+#include "vec3.h"
 
 /* api definition */
 #define glms_ray_(NAME) CGLM_STRUCTAPI(ray, NAME)
@@ -83,4 +84,31 @@ glms_ray_(at)(vec3s orig, vec3s dir, float t) {
   return r;
 }
 
+/*!
+ * @brief ray AABB intersection (slab test)
+ *
+ * tmin and tmax are where the ray enters and leaves the box, in units of
+ * dir. tmin < 0 means the ray starts inside the box.
+ *
+ * @param[in]  origin ray origin
+ * @param[in]  dir    ray direction
+ * @param[in]  box    bounding box
+ * @param[out] tmin   entry distance, can be NULL
+ * @param[out] tmax   exit distance, can be NULL
+ *
+ * @returns whether the ray hits the box ahead of its origin
+ */
+CGLM_INLINE
+bool
+glms_ray_(aabb)(vec3s origin,
+                vec3s dir,
+                vec3s box[2],
+                float * __restrict tmin,
+                float * __restrict tmax) {
+  vec3 rawBox[2];
+
+  glms_vec3_(unpack)(rawBox, box, 2);
+  return glm_ray_aabb(origin.raw, dir.raw, rawBox, tmin, tmax);
+}
+
 #endif /* cglms_ray_h */
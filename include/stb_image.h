@@ -431,6 +431,19 @@ STBIDEF stbi_uc *stbi_load_from_file  (FILE *f, int *x, int *y, int *channels_in
 
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp);
+
+// frame-by-frame animated GIF decoding. open reports the size and the number
+// of frames (found by walking the block structure, without decompressing),
+// so storage for every frame can be created up front. each call to next
+// composes one more frame and returns it as 4-channel RGBA, valid until the
+// following call, or NULL once the animation is done or on error. memory use
+// is a few frames regardless of animation length. 'buffer' must outlive the
+// stream. the output conversion flags apply to each returned frame.
+typedef struct stbi_gif_stream stbi_gif_stream;
+
+STBIDEF stbi_gif_stream *stbi_gif_stream_open_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *frames);
+STBIDEF stbi_uc         *stbi_gif_stream_next(stbi_gif_stream *gs, int *delay_ms);
+STBIDEF void             stbi_gif_stream_close(stbi_gif_stream *gs);
 #endif
 
 #ifdef STBI_WINDOWS_UTF8
@@ -464,6 +477,24 @@ STBIDEF stbi_us *stbi_load_from_file_16(FILE *f, int *x, int *y, int *channels_i
    #endif
 #endif
 
+////////////////////////////////////
+//
+// half-float interface
+//
+// returns IEEE 754 binary16 bit patterns, ready for a GL_HALF_FLOAT upload at
+// half the size of the float interface. HDR files are converted a scanline
+// at a time and never exist as 32-bit floats; LDR files get the same
+// gamma/scale as stbi_loadf, through a 256-entry table.
+#ifndef STBI_NO_LINEAR
+   STBIDEF stbi_us *stbi_loadh_from_memory   (stbi_uc const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels);
+   STBIDEF stbi_us *stbi_loadh_from_callbacks(stbi_io_callbacks const *clbk, void *user, int *x, int *y,  int *channels_in_file, int desired_channels);
+
+   #ifndef STBI_NO_STDIO
+   STBIDEF stbi_us *stbi_loadh          (char const *filename, int *x, int *y, int *channels_in_file, int desired_channels);
+   STBIDEF stbi_us *stbi_loadh_from_file(FILE *f, int *x, int *y, int *channels_in_file, int desired_channels);
+   #endif
+#endif
+
 #ifndef STBI_NO_HDR
    STBIDEF void   stbi_hdr_to_ldr_gamma(float gamma);
    STBIDEF void   stbi_hdr_to_ldr_scale(float scale);
@@ -524,6 +555,61 @@ STBIDEF void stbi_set_unpremultiply_on_load_thread(int flag_true_if_should_unpre
 STBIDEF void stbi_convert_iphone_png_to_rgb_thread(int flag_true_if_should_convert);
 STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+// output conversions for the 8-bit interface, performed while the decoder
+// writes its final rows rather than as separate passes over the image. flags
+// are OR'd together; STBI_CONVERT_FLIP_VERTICALLY is the same as
+// stbi_set_flip_vertically_on_load and, like it, also applies to the 16-bit,
+// float, half and animated GIF loaders. sRGB-to-linear is done with an 8-bit
+// table (so dark tones lose precision) and happens before premultiplication.
+enum
+{
+   STBI_CONVERT_FLIP_VERTICALLY   = 1,
+   STBI_CONVERT_PREMULTIPLY_ALPHA = 2,
+   STBI_CONVERT_SRGB_TO_LINEAR    = 4
+};
+
+STBIDEF void stbi_set_output_conversion(int flags);
+STBIDEF void stbi_set_output_conversion_thread(int flags);
+
+// bump-pointer arena for decoder allocations. while an arena is bound, every
+// allocation stb_image makes (including the returned image) comes from it;
+// growing or freeing the most recent block is done in place and everything
+// else is reclaimed at once by stbi_arena_reset, so a decode does no malloc
+// churn. allocations that don't fit fall back to STBI_MALLOC and are counted
+// in 'spills'. 'peak' is the high-water mark since the last reset, i.e. the
+// bytes one decode needed if you reset after each image. free images with
+// stbi_image_free (or not at all) while the arena is still bound; pass NULL
+// to unbind.
+typedef struct
+{
+   unsigned char *base;
+   size_t size;
+   size_t used;
+   size_t peak;
+   int    spills;
+} stbi_arena;
+
+STBIDEF void stbi_arena_init(stbi_arena *a, void *memory, size_t size);
+STBIDEF void stbi_arena_reset(stbi_arena *a);
+STBIDEF void stbi_set_arena(stbi_arena *a);
+STBIDEF void stbi_set_arena_thread(stbi_arena *a);
+
+// optional task runner for decode work that splits into independent pieces
+// (currently the seven Adam7 passes of interlaced PNGs). 'run' must call
+// task(data, i) for every i in [0,count), possibly concurrently, and return
+// once all of them have finished. without one, the pieces run serially.
+typedef void stbi_task(void *data, int index);
+typedef void stbi_parallel_for(void *user, stbi_task *task, void *data, int count);
+
+STBIDEF void stbi_set_parallel_for(stbi_parallel_for *run, void *user);
+
+// decode JPEGs at 1/(1<<shift) of their size, shift 0..3 (full, 1/2, 1/4,
+// 1/8), using reduced-size inverse DCTs so the full image is never built.
+// the returned size is the scaled one, rounded up; stbi_info still reports
+// the size stored in the file. other formats ignore this.
+STBIDEF void stbi_set_jpeg_scale_shift(int shift);
+STBIDEF void stbi_set_jpeg_scale_shift_thread(int shift);
+
 // ZLIB client - used by PNG, available for other purposes
 
 STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int initial_size, int *outlen);
@@ -725,6 +811,13 @@ typedef unsigned char validate_uint32[sizeof(stbi__uint32)==4 ? 1 : -1];
 #define STBI_SSE2
 #include <emmintrin.h>
 
+// float->half uses the F16C instruction when the compiler is allowed to
+// (e.g. -mf16c or -march=native), and an SSE2 bit-twiddling kernel otherwise
+#ifdef __F16C__
+#define STBI__F16C
+#include <immintrin.h>
+#endif
+
 #ifdef _MSC_VER
 
 #if _MSC_VER >= 1400  // not VC6
@@ -817,6 +910,8 @@ typedef struct
 
    stbi_uc *img_buffer, *img_buffer_end;
    stbi_uc *img_buffer_original, *img_buffer_original_end;
+
+   int output_conversion; // STBI_CONVERT_* flags the decoder may fuse into its final row writes
 } stbi__context;
 
 
@@ -828,6 +923,7 @@ static void stbi__start_mem(stbi__context *s, stbi_uc const *buffer, int len)
    s->io.read = NULL;
    s->read_from_callbacks = 0;
    s->callback_already_read = 0;
+   s->output_conversion = 0;
    s->img_buffer = s->img_buffer_original = (stbi_uc *) buffer;
    s->img_buffer_end = s->img_buffer_original_end = (stbi_uc *) buffer+len;
 }
@@ -840,6 +936,7 @@ static void stbi__start_callbacks(stbi__context *s, stbi_io_callbacks *c, void *
    s->buflen = sizeof(s->buffer_start);
    s->read_from_callbacks = 1;
    s->callback_already_read = 0;
+   s->output_conversion = 0;
    s->img_buffer = s->img_buffer_original = s->buffer_start;
    stbi__refill_buffer(s);
    s->img_buffer_original_end = s->img_buffer_end;
@@ -903,6 +1000,7 @@ typedef struct
    int bits_per_channel;
    int num_channels;
    int channel_order;
+   int conversions_done; // STBI_CONVERT_* flags the decoder already applied
 } stbi__result_info;
 
 #ifndef STBI_NO_JPEG
@@ -940,6 +1038,7 @@ static int      stbi__psd_is16(stbi__context *s);
 #ifndef STBI_NO_HDR
 static int      stbi__hdr_test(stbi__context *s);
 static float   *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri);
+static void    *stbi__hdr_load_main(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri, int half);
 static int      stbi__hdr_info(stbi__context *s, int *x, int *y, int *comp);
 #endif
 
@@ -982,9 +1081,139 @@ static int stbi__err(const char *str)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//  arena allocation
+//
+//  when an arena is bound, every allocation the decoders make is bumped off
+//  it; freeing or growing the most recent block happens in place, anything
+//  else is left for stbi_arena_reset. requests that don't fit spill to
+//  STBI_MALLOC, and frees are routed by address, so mixing is safe.
+
+#define STBI__ARENA_HEADER 16 // keeps blocks 16-byte aligned for the SIMD paths
+
+static stbi_arena *stbi__arena_global;
+
+STBIDEF void stbi_set_arena(stbi_arena *a)
+{
+   stbi__arena_global = a;
+}
+
+#ifndef STBI_THREAD_LOCAL
+#define stbi__arena  stbi__arena_global
+#else
+static STBI_THREAD_LOCAL stbi_arena *stbi__arena_local;
+static STBI_THREAD_LOCAL int stbi__arena_set;
+
+STBIDEF void stbi_set_arena_thread(stbi_arena *a)
+{
+   stbi__arena_local = a;
+   stbi__arena_set = 1;
+}
+
+#define stbi__arena  (stbi__arena_set ? stbi__arena_local : stbi__arena_global)
+#endif // STBI_THREAD_LOCAL
+
+STBIDEF void stbi_arena_init(stbi_arena *a, void *memory, size_t size)
+{
+   size_t skew = (size_t) memory & 15;
+   a->base  = (unsigned char *) memory + (skew ? 16 - skew : 0);
+   a->size  = size > (size_t) (a->base - (unsigned char *) memory) ? size - (size_t) (a->base - (unsigned char *) memory) : 0;
+   a->used  = 0;
+   a->peak  = 0;
+   a->spills = 0;
+}
+
+STBIDEF void stbi_arena_reset(stbi_arena *a)
+{
+   a->used = 0;
+   a->peak = 0;
+   a->spills = 0;
+}
+
+static int stbi__arena_owns(stbi_arena *a, void *p)
+{
+   return a && (unsigned char *) p >= a->base && (unsigned char *) p < a->base + a->size;
+}
+
+static size_t stbi__arena_blocksize(void *p)
+{
+   return *(size_t *) ((unsigned char *) p - STBI__ARENA_HEADER);
+}
+
+// block footprint including header, rounded to keep the next block aligned
+static size_t stbi__arena_footprint(size_t size)
+{
+   return STBI__ARENA_HEADER + ((size + 15) & ~(size_t) 15);
+}
+
+static int stbi__arena_is_top(stbi_arena *a, void *p)
+{
+   return (unsigned char *) p + ((stbi__arena_blocksize(p) + 15) & ~(size_t) 15) == a->base + a->used;
+}
+
+static void *stbi__arena_alloc(stbi_arena *a, size_t size)
+{
+   unsigned char *block;
+   size_t need = stbi__arena_footprint(size);
+   if (need < size || need > a->size - a->used) return NULL;
+   block = a->base + a->used + STBI__ARENA_HEADER;
+   *(size_t *) (block - STBI__ARENA_HEADER) = size;
+   a->used += need;
+   if (a->used > a->peak) a->peak = a->used;
+   return block;
+}
+
 static void *stbi__malloc(size_t size)
 {
-    return STBI_MALLOC(size);
+   stbi_arena *a = stbi__arena;
+   if (a) {
+      void *p = stbi__arena_alloc(a, size);
+      if (p) return p;
+      ++a->spills;
+   }
+   return STBI_MALLOC(size);
+}
+
+static void stbi__free(void *p)
+{
+   stbi_arena *a = stbi__arena;
+   if (p == NULL) return;
+   if (stbi__arena_owns(a, p)) {
+      // only the most recent block can be given back; the rest waits for reset
+      if (stbi__arena_is_top(a, p))
+         a->used -= stbi__arena_footprint(stbi__arena_blocksize(p));
+      return;
+   }
+   STBI_FREE(p);
+}
+
+static void *stbi__realloc_sized(void *p, size_t oldsz, size_t newsz)
+{
+   stbi_arena *a = stbi__arena;
+   if (p && stbi__arena_owns(a, p)) {
+      void *q;
+      size_t cur = stbi__arena_blocksize(p);
+      if (stbi__arena_is_top(a, p)) {
+         // grow or shrink in place: the common case for IDAT and zlib output
+         size_t base = a->used - stbi__arena_footprint(cur);
+         size_t need = stbi__arena_footprint(newsz);
+         if (need >= newsz && need <= a->size - base) {
+            *(size_t *) ((unsigned char *) p - STBI__ARENA_HEADER) = newsz;
+            a->used = base + need;
+            if (a->used > a->peak) a->peak = a->used;
+            return p;
+         }
+      }
+      q = stbi__malloc(newsz);
+      if (q == NULL) return NULL;
+      memcpy(q, p, cur < newsz ? cur : newsz);
+      stbi__free(p);
+      return q;
+   }
+   if (p == NULL) return stbi__malloc(newsz);
+   STBI_NOTUSED(oldsz);
+   return STBI_REALLOC_SIZED(p, oldsz, newsz);
 }
 
 // stb_image uses ints pervasively, including for offset calculations.
@@ -1100,11 +1329,13 @@ static int stbi__mul2shorts_valid(int a, int b)
 
 STBIDEF void stbi_image_free(void *retval_from_stbi_load)
 {
-   STBI_FREE(retval_from_stbi_load);
+   stbi__free(retval_from_stbi_load);
 }
 
 #ifndef STBI_NO_LINEAR
 static float   *stbi__ldr_to_hdr(stbi_uc *data, int x, int y, int comp);
+static stbi_us *stbi__ldr_to_half(stbi_uc *data, int x, int y, int comp);
+static void     stbi__float_to_half(stbi_us *out, const float *in, int n);
 #endif
 
 #ifndef STBI_NO_HDR
@@ -1134,6 +1365,66 @@ STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_fli
                                          : stbi__vertically_flip_on_load_global)
 #endif // STBI_THREAD_LOCAL
 
+static int stbi__output_conversion_global = 0;
+
+STBIDEF void stbi_set_output_conversion(int flags)
+{
+   stbi__output_conversion_global = flags;
+}
+
+#ifndef STBI_THREAD_LOCAL
+#define stbi__output_conversion  stbi__output_conversion_global
+#else
+static STBI_THREAD_LOCAL int stbi__output_conversion_local, stbi__output_conversion_set;
+
+STBIDEF void stbi_set_output_conversion_thread(int flags)
+{
+   stbi__output_conversion_local = flags;
+   stbi__output_conversion_set = 1;
+}
+
+#define stbi__output_conversion  (stbi__output_conversion_set          \
+                                   ? stbi__output_conversion_local     \
+                                   : stbi__output_conversion_global)
+#endif // STBI_THREAD_LOCAL
+
+static stbi_parallel_for *stbi__parallel_for_func;
+static void *stbi__parallel_for_user;
+
+STBIDEF void stbi_set_parallel_for(stbi_parallel_for *run, void *user)
+{
+   stbi__parallel_for_func = run;
+   stbi__parallel_for_user = user;
+}
+
+static int stbi__jpeg_scale_shift_global = 0;
+
+STBIDEF void stbi_set_jpeg_scale_shift(int shift)
+{
+   stbi__jpeg_scale_shift_global = shift < 0 ? 0 : shift > 3 ? 3 : shift;
+}
+
+#ifndef STBI_THREAD_LOCAL
+#define stbi__jpeg_scale_shift  stbi__jpeg_scale_shift_global
+#else
+static STBI_THREAD_LOCAL int stbi__jpeg_scale_shift_local, stbi__jpeg_scale_shift_set;
+
+STBIDEF void stbi_set_jpeg_scale_shift_thread(int shift)
+{
+   stbi__jpeg_scale_shift_local = shift < 0 ? 0 : shift > 3 ? 3 : shift;
+   stbi__jpeg_scale_shift_set = 1;
+}
+
+#define stbi__jpeg_scale_shift  (stbi__jpeg_scale_shift_set          \
+                                  ? stbi__jpeg_scale_shift_local     \
+                                  : stbi__jpeg_scale_shift_global)
+#endif // STBI_THREAD_LOCAL
+
+static int stbi__output_flags(void)
+{
+   return stbi__output_conversion | (stbi__vertically_flip_on_load ? STBI_CONVERT_FLIP_VERTICALLY : 0);
+}
+
 static void *stbi__load_main(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri, int bpc)
 {
    memset(ri, 0, sizeof(*ri)); // make sure it's initialized if we add new fields
@@ -1199,7 +1490,7 @@ static stbi_uc *stbi__convert_16_to_8(stbi__uint16 *orig, int w, int h, int chan
    for (i = 0; i < img_len; ++i)
       reduced[i] = (stbi_uc)((orig[i] >> 8) & 0xFF); // top half of each byte is sufficient approx of 16->8 bit scaling
 
-   STBI_FREE(orig);
+   stbi__free(orig);
    return reduced;
 }
 
@@ -1215,7 +1506,7 @@ static stbi__uint16 *stbi__convert_8_to_16(stbi_uc *orig, int w, int h, int chan
    for (i = 0; i < img_len; ++i)
       enlarged[i] = (stbi__uint16)((orig[i] << 8) + orig[i]); // replicate to high and low byte, maps 0->0, 255->0xffff
 
-   STBI_FREE(orig);
+   stbi__free(orig);
    return enlarged;
 }
 
@@ -1257,10 +1548,97 @@ static void stbi__vertical_flip_slices(void *image, int w, int h, int z, int byt
 }
 #endif
 
+// sRGB-encoded 8-bit value -> linear 8-bit value, rounded
+static const stbi_uc stbi__srgb_to_linear8[256] =
+{
+     0,  0,  0,  0,  0,  0,  0,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+     1,  1,  2,  2,  2,  2,  2,  2,  2,  2,  3,  3,  3,  3,  3,  3,
+     4,  4,  4,  4,  4,  5,  5,  5,  5,  6,  6,  6,  6,  7,  7,  7,
+     8,  8,  8,  8,  9,  9,  9, 10, 10, 10, 11, 11, 12, 12, 12, 13,
+    13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 17, 18, 18, 19, 19, 20,
+    20, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 27, 27, 28, 29, 29,
+    30, 30, 31, 32, 32, 33, 34, 35, 35, 36, 37, 37, 38, 39, 40, 41,
+    41, 42, 43, 44, 45, 45, 46, 47, 48, 49, 50, 51, 51, 52, 53, 54,
+    55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70,
+    71, 72, 73, 74, 76, 77, 78, 79, 80, 81, 82, 84, 85, 86, 87, 88,
+    90, 91, 92, 93, 95, 96, 97, 99,100,101,103,104,105,107,108,109,
+   111,112,114,115,116,118,119,121,122,124,125,127,128,130,131,133,
+   134,136,138,139,141,142,144,146,147,149,151,152,154,156,157,159,
+   161,163,164,166,168,170,171,173,175,177,179,181,183,184,186,188,
+   190,192,194,196,198,200,202,204,206,208,210,212,214,216,218,220,
+   222,224,226,229,231,233,235,237,239,242,244,246,248,250,253,255,
+};
+
+// apply the per-pixel STBI_CONVERT_* flags to one row of n-channel pixels.
+// this is meant to run on a row the decoder has just written, while it is
+// still in cache; flipping is the caller's business (it picks the row)
+static void stbi__convert_row(stbi_uc *row, int w, int n, int flags)
+{
+   int i, c, nc = (n == 1 || n == 2) ? 1 : 3; // colour channels
+   int has_alpha = (n == 2 || n == 4);
+
+   if (flags & STBI_CONVERT_SRGB_TO_LINEAR) {
+      stbi_uc *p = row;
+      for (i=0; i < w; ++i, p += n)
+         for (c=0; c < nc; ++c)
+            p[c] = stbi__srgb_to_linear8[p[c]];
+   }
+   if ((flags & STBI_CONVERT_PREMULTIPLY_ALPHA) && has_alpha) {
+      stbi_uc *p = row;
+      for (i=0; i < w; ++i, p += n) {
+         unsigned int a = p[n-1];
+         if (a == 255) continue;
+         for (c=0; c < nc; ++c) {
+            unsigned int t = p[c]*a + 128;
+            p[c] = (stbi_uc) ((t + (t >> 8)) >> 8);
+         }
+      }
+   }
+}
+
+// flip and convert in a single pass: each pair of mirrored rows is converted
+// and swapped while both are hot, instead of one full pass per operation
+static void stbi__apply_output_conversion(stbi_uc *image, int w, int h, int n, int flags)
+{
+   int row;
+   size_t bytes_per_row = (size_t)w * n;
+   stbi_uc temp[2048];
+
+   if (!(flags & STBI_CONVERT_FLIP_VERTICALLY)) {
+      if (flags)
+         for (row = 0; row < h; row++)
+            stbi__convert_row(image + row*bytes_per_row, w, n, flags);
+      return;
+   }
+
+   for (row = 0; row < (h>>1); row++) {
+      stbi_uc *row0 = image + row*bytes_per_row;
+      stbi_uc *row1 = image + (h - row - 1)*bytes_per_row;
+      size_t bytes_left = bytes_per_row;
+      stbi__convert_row(row0, w, n, flags);
+      stbi__convert_row(row1, w, n, flags);
+      while (bytes_left) {
+         size_t bytes_copy = (bytes_left < sizeof(temp)) ? bytes_left : sizeof(temp);
+         memcpy(temp, row0, bytes_copy);
+         memcpy(row0, row1, bytes_copy);
+         memcpy(row1, temp, bytes_copy);
+         row0 += bytes_copy;
+         row1 += bytes_copy;
+         bytes_left -= bytes_copy;
+      }
+   }
+   if (h & 1)
+      stbi__convert_row(image + (h>>1)*bytes_per_row, w, n, flags);
+}
+
 static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x, int *y, int *comp, int req_comp)
 {
    stbi__result_info ri;
-   void *result = stbi__load_main(s, x, y, comp, req_comp, &ri, 8);
+   int flags = stbi__output_flags();
+   void *result;
+
+   s->output_conversion = flags;
+   result = stbi__load_main(s, x, y, comp, req_comp, &ri, 8);
 
    if (result == NULL)
       return NULL;
@@ -1275,9 +1653,12 @@ static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x,
 
    // @TODO: move stbi__convert_format to here
 
-   if (stbi__vertically_flip_on_load) {
+   // whatever the decoder couldn't fuse into its row writes is done here,
+   // still in a single pass
+   flags &= ~ri.conversions_done;
+   if (flags && result) {
       int channels = req_comp ? req_comp : *comp;
-      stbi__vertical_flip(result, *x, *y, channels * sizeof(stbi_uc));
+      stbi__apply_output_conversion((stbi_uc *) result, *x, *y, channels, flags);
    }
 
    return (unsigned char *) result;
@@ -1302,7 +1683,7 @@ static stbi__uint16 *stbi__load_and_postprocess_16bit(stbi__context *s, int *x,
    // @TODO: move stbi__convert_format16 to here
    // @TODO: special case RGB-to-Y (and RGBA-to-YA) for 8-bit-to-16-bit case to keep more precision
 
-   if (stbi__vertically_flip_on_load) {
+   if (stbi__output_flags() & STBI_CONVERT_FLIP_VERTICALLY) {
       int channels = req_comp ? req_comp : *comp;
       stbi__vertical_flip(result, *x, *y, channels * sizeof(stbi__uint16));
    }
@@ -1313,7 +1694,7 @@ static stbi__uint16 *stbi__load_and_postprocess_16bit(stbi__context *s, int *x,
 #if !defined(STBI_NO_HDR) && !defined(STBI_NO_LINEAR)
 static void stbi__float_postprocess(float *result, int *x, int *y, int *comp, int req_comp)
 {
-   if (stbi__vertically_flip_on_load && result != NULL) {
+   if ((stbi__output_flags() & STBI_CONVERT_FLIP_VERTICALLY) && result != NULL) {
       int channels = req_comp ? req_comp : *comp;
       stbi__vertical_flip(result, *x, *y, channels * sizeof(float));
    }
@@ -1448,7 +1829,7 @@ STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int *
    stbi__start_mem(&s,buffer,len);
 
    result = (unsigned char*) stbi__load_gif_main(&s, delays, x, y, z, comp, req_comp);
-   if (stbi__vertically_flip_on_load) {
+   if (result && (stbi__output_flags() & STBI_CONVERT_FLIP_VERTICALLY)) {
       stbi__vertical_flip_slices( result, *x, *y, *z, *comp );
    }
 
@@ -1508,6 +1889,59 @@ STBIDEF float *stbi_loadf_from_file(FILE *f, int *x, int *y, int *comp, int req_
 }
 #endif // !STBI_NO_STDIO
 
+static stbi_us *stbi__loadh_main(stbi__context *s, int *x, int *y, int *comp, int req_comp)
+{
+   unsigned char *data;
+   #ifndef STBI_NO_HDR
+   if (stbi__hdr_test(s)) {
+      stbi__result_info ri;
+      stbi_us *hdr_data = (stbi_us *) stbi__hdr_load_main(s,x,y,comp,req_comp, &ri, 1);
+      if (hdr_data && (stbi__output_flags() & STBI_CONVERT_FLIP_VERTICALLY)) {
+         int channels = req_comp ? req_comp : *comp;
+         stbi__vertical_flip(hdr_data, *x, *y, channels * sizeof(stbi_us));
+      }
+      return hdr_data;
+   }
+   #endif
+   data = stbi__load_and_postprocess_8bit(s, x, y, comp, req_comp);
+   if (data)
+      return stbi__ldr_to_half(data, *x, *y, req_comp ? req_comp : *comp);
+   return (stbi_us *) stbi__errpuc("unknown image type", "Image not of any known type, or corrupt");
+}
+
+STBIDEF stbi_us *stbi_loadh_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *comp, int req_comp)
+{
+   stbi__context s;
+   stbi__start_mem(&s,buffer,len);
+   return stbi__loadh_main(&s,x,y,comp,req_comp);
+}
+
+STBIDEF stbi_us *stbi_loadh_from_callbacks(stbi_io_callbacks const *clbk, void *user, int *x, int *y, int *comp, int req_comp)
+{
+   stbi__context s;
+   stbi__start_callbacks(&s, (stbi_io_callbacks *) clbk, user);
+   return stbi__loadh_main(&s,x,y,comp,req_comp);
+}
+
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_us *stbi_loadh(char const *filename, int *x, int *y, int *comp, int req_comp)
+{
+   stbi_us *result;
+   FILE *f = stbi__fopen(filename, "rb");
+   if (!f) return (stbi_us *) stbi__errpuc("can't fopen", "Unable to open file");
+   result = stbi_loadh_from_file(f,x,y,comp,req_comp);
+   fclose(f);
+   return result;
+}
+
+STBIDEF stbi_us *stbi_loadh_from_file(FILE *f, int *x, int *y, int *comp, int req_comp)
+{
+   stbi__context s;
+   stbi__start_file(&s,f);
+   return stbi__loadh_main(&s,x,y,comp,req_comp);
+}
+#endif // !STBI_NO_STDIO
+
 #endif // !STBI_NO_LINEAR
 
 // these is-hdr-or-not is defined independent of whether STBI_NO_LINEAR is
@@ -1752,7 +2186,11 @@ static stbi_uc stbi__compute_y(int r, int g, int b)
 #if defined(STBI_NO_PNG) && defined(STBI_NO_BMP) && defined(STBI_NO_PSD) && defined(STBI_NO_TGA) && defined(STBI_NO_GIF) && defined(STBI_NO_PIC) && defined(STBI_NO_PNM)
 // nothing
 #else
-static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int req_comp, unsigned int x, unsigned int y)
+// as stbi__convert_format, but also applies the STBI_CONVERT_* flags while
+// writing each destination row, so a decoder that has to convert anyway gets
+// flip/premultiply/linearize for free. the caller must only pass flags when
+// req_comp != img_n, otherwise nothing is written and nothing is applied
+static unsigned char *stbi__convert_format_flags(unsigned char *data, int img_n, int req_comp, unsigned int x, unsigned int y, int flags)
 {
    int i,j;
    unsigned char *good;
@@ -1762,13 +2200,15 @@ static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int r
 
    good = (unsigned char *) stbi__malloc_mad3(req_comp, x, y, 0);
    if (good == NULL) {
-      STBI_FREE(data);
+      stbi__free(data);
       return stbi__errpuc("outofmem", "Out of memory");
    }
 
    for (j=0; j < (int) y; ++j) {
+      unsigned int out_row = (flags & STBI_CONVERT_FLIP_VERTICALLY) ? y - 1 - j : (unsigned int) j;
       unsigned char *src  = data + j * x * img_n   ;
-      unsigned char *dest = good + j * x * req_comp;
+      unsigned char *dest = good + out_row * x * req_comp;
+      unsigned char *dest_row = dest;
 
       #define STBI__COMBO(a,b)  ((a)*8+(b))
       #define STBI__CASE(a,b)   case STBI__COMBO(a,b): for(i=x-1; i >= 0; --i, src += a, dest += b)
@@ -1787,14 +2227,21 @@ static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int r
          STBI__CASE(4,1) { dest[0]=stbi__compute_y(src[0],src[1],src[2]);                   } break;
          STBI__CASE(4,2) { dest[0]=stbi__compute_y(src[0],src[1],src[2]); dest[1] = src[3]; } break;
          STBI__CASE(4,3) { dest[0]=src[0];dest[1]=src[1];dest[2]=src[2];                    } break;
-         default: STBI_ASSERT(0); STBI_FREE(data); STBI_FREE(good); return stbi__errpuc("unsupported", "Unsupported format conversion");
+         default: STBI_ASSERT(0); stbi__free(data); stbi__free(good); return stbi__errpuc("unsupported", "Unsupported format conversion");
       }
       #undef STBI__CASE
+      if (flags & ~STBI_CONVERT_FLIP_VERTICALLY)
+         stbi__convert_row(dest_row, x, req_comp, flags);
    }
 
-   STBI_FREE(data);
+   stbi__free(data);
    return good;
 }
+
+static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int req_comp, unsigned int x, unsigned int y)
+{
+   return stbi__convert_format_flags(data, img_n, req_comp, x, y, 0);
+}
 #endif
 
 #if defined(STBI_NO_PNG) && defined(STBI_NO_PSD)
@@ -1819,7 +2266,7 @@ static stbi__uint16 *stbi__convert_format16(stbi__uint16 *data, int img_n, int r
 
    good = (stbi__uint16 *) stbi__malloc(req_comp * x * y * 2);
    if (good == NULL) {
-      STBI_FREE(data);
+      stbi__free(data);
       return (stbi__uint16 *) stbi__errpuc("outofmem", "Out of memory");
    }
 
@@ -1844,37 +2291,148 @@ static stbi__uint16 *stbi__convert_format16(stbi__uint16 *data, int img_n, int r
          STBI__CASE(4,1) { dest[0]=stbi__compute_y_16(src[0],src[1],src[2]);                   } break;
          STBI__CASE(4,2) { dest[0]=stbi__compute_y_16(src[0],src[1],src[2]); dest[1] = src[3]; } break;
          STBI__CASE(4,3) { dest[0]=src[0];dest[1]=src[1];dest[2]=src[2];                       } break;
-         default: STBI_ASSERT(0); STBI_FREE(data); STBI_FREE(good); return (stbi__uint16*) stbi__errpuc("unsupported", "Unsupported format conversion");
+         default: STBI_ASSERT(0); stbi__free(data); stbi__free(good); return (stbi__uint16*) stbi__errpuc("unsupported", "Unsupported format conversion");
       }
       #undef STBI__CASE
    }
 
-   STBI_FREE(data);
+   stbi__free(data);
    return good;
 }
 #endif
 
 #ifndef STBI_NO_LINEAR
+// float -> IEEE half, round to nearest even; overflow goes to inf, NaN stays
+// NaN. this is the scalar version of the SSE2 kernel below (after ryg's
+// float_to_half_fast3_rtne)
+static stbi_us stbi__float_to_half1(float fl)
+{
+   union { stbi__uint32 u; float f; } f, denorm_magic;
+   stbi__uint32 sign;
+   stbi_us o;
+   denorm_magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+   f.f = fl;
+   sign = f.u & 0x80000000u;
+   f.u ^= sign;
+   if (f.u >= (stbi__uint32) (127 + 16) << 23) { // too big for half: inf, or NaN
+      o = (f.u > 0x7f800000u) ? 0x7e00 : 0x7c00;
+   } else if (f.u < (stbi__uint32) (127 - 14) << 23) { // result is subnormal or zero
+      // let the float adder do the rounding by aligning to a magic exponent
+      f.f += denorm_magic.f;
+      o = (stbi_us) (f.u - denorm_magic.u);
+   } else {
+      stbi__uint32 mant_odd = (f.u >> 13) & 1;
+      f.u += 0xfff - ((stbi__uint32) (127 - 15) << 23); // rebias exponent, round
+      f.u += mant_odd;
+      o = (stbi_us) (f.u >> 13);
+   }
+   return (stbi_us) (o | (sign >> 16));
+}
+
+#if defined(STBI_SSE2) && !defined(STBI__F16C)
+static __m128i stbi__float_to_half_sse2(__m128 f)
+{
+   __m128i c_sign        = _mm_set1_epi32((int) 0x80000000u);
+   __m128i c_f16max      = _mm_set1_epi32((127 + 16) << 23);
+   __m128i c_min_normal  = _mm_set1_epi32((127 - 14) << 23);
+   __m128i c_denorm      = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+   __m128i c_normal_bias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+   __m128  justsign      = _mm_and_ps(_mm_castsi128_ps(c_sign), f);
+   __m128  absf          = _mm_xor_ps(f, justsign);
+   __m128i absf_int      = _mm_castps_si128(absf);
+   __m128i is_nan        = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+   __m128i is_regular    = _mm_cmpgt_epi32(c_f16max, absf_int);
+   __m128i inf_or_nan    = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+   __m128i is_sub        = _mm_cmpgt_epi32(c_min_normal, absf_int);
+   __m128i subnorm       = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(c_denorm))), c_denorm);
+   __m128i mant_odd      = _mm_srai_epi32(_mm_slli_epi32(absf_int, 31 - 13), 31);
+   __m128i normal        = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absf_int, c_normal_bias), mant_odd), 13);
+   __m128i nonspecial    = _mm_or_si128(_mm_and_si128(subnorm, is_sub), _mm_andnot_si128(is_sub, normal));
+   __m128i joined        = _mm_or_si128(_mm_and_si128(nonspecial, is_regular), _mm_andnot_si128(is_regular, inf_or_nan));
+   // sign lands in bit 15 with the upper half all ones, so the signed
+   // saturating pack the caller uses keeps every bit intact
+   return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justsign), 16));
+}
+#endif
+
+// convert n floats to halves, 8 at a time where SIMD is available
+static void stbi__float_to_half(stbi_us *out, const float *in, int n)
+{
+   int i = 0;
+#if defined(STBI__F16C)
+   for (; i+8 <= n; i += 8) {
+      __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(in+i  ), 0);
+      __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(in+i+4), 0);
+      _mm_storeu_si128((__m128i *) (out+i), _mm_unpacklo_epi64(lo, hi));
+   }
+#elif defined(STBI_SSE2)
+   for (; i+8 <= n; i += 8) {
+      __m128i lo = stbi__float_to_half_sse2(_mm_loadu_ps(in+i  ));
+      __m128i hi = stbi__float_to_half_sse2(_mm_loadu_ps(in+i+4));
+      _mm_storeu_si128((__m128i *) (out+i), _mm_packs_epi32(lo, hi));
+   }
+#endif
+   for (; i < n; ++i)
+      out[i] = stbi__float_to_half1(in[i]);
+}
+
+// the ldr->hdr mapping only has 256 possible inputs per channel kind, so
+// build those once per image instead of calling pow() per sample
+static void stbi__ldr_to_hdr_table(float table[256], float alpha_table[256])
+{
+   int i;
+   for (i=0; i < 256; ++i) {
+      table[i] = (float) (pow(i/255.0f, stbi__l2h_gamma) * stbi__l2h_scale);
+      alpha_table[i] = i/255.0f;
+   }
+}
+
 static float   *stbi__ldr_to_hdr(stbi_uc *data, int x, int y, int comp)
 {
    int i,k,n;
    float *output;
+   float table[256], alpha_table[256];
    if (!data) return NULL;
    output = (float *) stbi__malloc_mad4(x, y, comp, sizeof(float), 0);
-   if (output == NULL) { STBI_FREE(data); return stbi__errpf("outofmem", "Out of memory"); }
+   if (output == NULL) { stbi__free(data); return stbi__errpf("outofmem", "Out of memory"); }
+   stbi__ldr_to_hdr_table(table, alpha_table);
    // compute number of non-alpha components
    if (comp & 1) n = comp; else n = comp-1;
    for (i=0; i < x*y; ++i) {
       for (k=0; k < n; ++k) {
-         output[i*comp + k] = (float) (pow(data[i*comp+k]/255.0f, stbi__l2h_gamma) * stbi__l2h_scale);
+         output[i*comp + k] = table[data[i*comp+k]];
       }
    }
    if (n < comp) {
       for (i=0; i < x*y; ++i) {
-         output[i*comp + n] = data[i*comp + n]/255.0f;
+         output[i*comp + n] = alpha_table[data[i*comp + n]];
       }
    }
-   STBI_FREE(data);
+   stbi__free(data);
+   return output;
+}
+
+static stbi_us *stbi__ldr_to_half(stbi_uc *data, int x, int y, int comp)
+{
+   int i,k,n;
+   stbi_us *output;
+   float table[256], alpha_table[256];
+   stbi_us htable[256], halpha_table[256];
+   if (!data) return NULL;
+   output = (stbi_us *) stbi__malloc_mad4(x, y, comp, sizeof(stbi_us), 0);
+   if (output == NULL) { stbi__free(data); return (stbi_us *) stbi__errpuc("outofmem", "Out of memory"); }
+   stbi__ldr_to_hdr_table(table, alpha_table);
+   stbi__float_to_half(htable, table, 256);
+   stbi__float_to_half(halpha_table, alpha_table, 256);
+   // compute number of non-alpha components
+   if (comp & 1) n = comp; else n = comp-1;
+   for (i=0; i < x*y; ++i) {
+      for (k=0; k < n; ++k)
+         output[i*comp + k] = htable[data[i*comp+k]];
+      if (n < comp)
+         output[i*comp + n] = halpha_table[data[i*comp + n]];
+   }
+   stbi__free(data);
    return output;
 }
 #endif
@@ -1887,7 +2445,7 @@ static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp)
    stbi_uc *output;
    if (!data) return NULL;
    output = (stbi_uc *) stbi__malloc_mad3(x, y, comp, 0);
-   if (output == NULL) { STBI_FREE(data); return stbi__errpuc("outofmem", "Out of memory"); }
+   if (output == NULL) { stbi__free(data); return stbi__errpuc("outofmem", "Out of memory"); }
    // compute number of non-alpha components
    if (comp & 1) n = comp; else n = comp-1;
    for (i=0; i < x*y; ++i) {
@@ -1904,7 +2462,7 @@ static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp)
          output[i*comp + k] = (stbi_uc) stbi__float2int(z);
       }
    }
-   STBI_FREE(data);
+   stbi__free(data);
    return output;
 }
 #endif
@@ -1993,6 +2551,7 @@ typedef struct
 
    int scan_n, order[4];
    int restart_interval, todo;
+   int scale_shift; // decode at 1/(1<<scale_shift) size, 0..3
 
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
@@ -2523,6 +3082,61 @@ static void stbi__idct_block(stbi_uc *out, int out_stride, short data[64])
    }
 }
 
+// reduced-size IDCTs for decoding at 1/2, 1/4 and 1/8 scale: only the low
+// n x n coefficients are used, run through an n-point IDCT, so each 8x8 block
+// produces n x n pixels directly. the tables hold 0.5*C(u)*cos((2x+1)u*pi/2n),
+// indexed [x*n+u], in the same 1<<12 fixed point as stbi__idct_block.
+#define stbi__f2fa stbi__f2f(0.353553391f)
+#define stbi__f2fb stbi__f2f(0.461939766f)
+#define stbi__f2fc stbi__f2f(0.191341716f)
+static const int stbi__idct_scaled4[16] =
+{
+   stbi__f2fa,  stbi__f2fb,  stbi__f2fa,  stbi__f2fc,
+   stbi__f2fa,  stbi__f2fc, -stbi__f2fa, -stbi__f2fb,
+   stbi__f2fa, -stbi__f2fc, -stbi__f2fa,  stbi__f2fb,
+   stbi__f2fa, -stbi__f2fb,  stbi__f2fa, -stbi__f2fc,
+};
+static const int stbi__idct_scaled2[4] =
+{
+   stbi__f2fa,  stbi__f2fa,
+   stbi__f2fa, -stbi__f2fa,
+};
+#undef stbi__f2fa
+#undef stbi__f2fb
+#undef stbi__f2fc
+
+static void stbi__idct_block_scaled(stbi_uc *out, int out_stride, short data[64], int n)
+{
+   int i,j,k,val[16];
+   const int *t = n == 4 ? stbi__idct_scaled4 : stbi__idct_scaled2;
+
+   if (n == 1) {
+      // DC term / 8 is the block average
+      out[0] = stbi__clamp(((data[0] + 4) >> 3) + 128);
+      return;
+   }
+
+   // rows: val[v*n+x] = sum_u t[x][u] * data[v][u], keeping 2 extra bits
+   for (j=0; j < n; ++j) {
+      for (i=0; i < n; ++i) {
+         int sum = 512;
+         for (k=0; k < n; ++k)
+            sum += t[i*n+k] * data[j*8+k];
+         val[j*n+i] = sum >> 10;
+      }
+   }
+
+   // columns: 1<<12 from the table plus 1<<2 from above, so remove 1<<14
+   for (j=0; j < n; ++j, out += out_stride) {
+      for (i=0; i < n; ++i) {
+         int sum = 8192 + (128 << 14);
+         for (k=0; k < n; ++k)
+            sum += t[j*n+k] * val[k*n+i];
+         out[i] = stbi__clamp(sum >> 14);
+      }
+   }
+}
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2946,6 +3560,18 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
+// IDCT one block into the component buffer; scaled decodes write an
+// (8>>scale_shift)-pixel square instead of the full 8x8
+static void stbi__jpeg_idct_store(stbi__jpeg *z, int n, int bx, int by, short data[64])
+{
+   int bs = 8 >> z->scale_shift;
+   stbi_uc *out = z->img_comp[n].data + z->img_comp[n].w2*by*bs + bx*bs;
+   if (bs == 8)
+      z->idct_block_kernel(out, z->img_comp[n].w2, data);
+   else
+      stbi__idct_block_scaled(out, z->img_comp[n].w2, data, bs);
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
    stbi__jpeg_reset(z);
@@ -2964,7 +3590,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
                if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               stbi__jpeg_idct_store(z, n, i, j, data);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -2988,11 +3614,11 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                   // by the basic H and V specified for the component
                   for (y=0; y < z->img_comp[n].v; ++y) {
                      for (x=0; x < z->img_comp[n].h; ++x) {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
+                        int x2 = i*z->img_comp[n].h + x;
+                        int y2 = j*z->img_comp[n].v + y;
                         int ha = z->img_comp[n].ha;
                         if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
+                        stbi__jpeg_idct_store(z, n, x2, y2, data);
                      }
                   }
                }
@@ -3089,7 +3715,7 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               stbi__jpeg_idct_store(z, n, i, j, data);
             }
          }
       }
@@ -3244,17 +3870,17 @@ static int stbi__free_jpeg_components(stbi__jpeg *z, int ncomp, int why)
    int i;
    for (i=0; i < ncomp; ++i) {
       if (z->img_comp[i].raw_data) {
-         STBI_FREE(z->img_comp[i].raw_data);
+         stbi__free(z->img_comp[i].raw_data);
          z->img_comp[i].raw_data = NULL;
          z->img_comp[i].data = NULL;
       }
       if (z->img_comp[i].raw_coeff) {
-         STBI_FREE(z->img_comp[i].raw_coeff);
+         stbi__free(z->img_comp[i].raw_coeff);
          z->img_comp[i].raw_coeff = 0;
          z->img_comp[i].coeff = 0;
       }
       if (z->img_comp[i].linebuf) {
-         STBI_FREE(z->img_comp[i].linebuf);
+         stbi__free(z->img_comp[i].linebuf);
          z->img_comp[i].linebuf = NULL;
       }
    }
@@ -3329,8 +3955,10 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       //
       // img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
       // so these muls can't overflow with 32-bit ints (which we require)
-      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+      //
+      // scaled decodes only need (8>>scale_shift) pixels per block
+      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * (8 >> z->scale_shift);
+      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * (8 >> z->scale_shift);
       z->img_comp[i].coeff = 0;
       z->img_comp[i].raw_coeff = 0;
       z->img_comp[i].linebuf = NULL;
@@ -3340,10 +3968,10 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       // align blocks for idct using mmx/sse
       z->img_comp[i].data = (stbi_uc*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
       if (z->progressive) {
-         // w2, h2 are multiples of 8 (see above)
-         z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-         z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+         // one 64-coefficient block per 8x8 block, regardless of scale
+         z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 8, z->img_comp[i].coeff_h * 8, sizeof(short), 15);
          if (z->img_comp[i].raw_coeff == NULL)
             return stbi__free_jpeg_components(z, i+1, stbi__err("outofmem", "Out of memory"));
          z->img_comp[i].coeff = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3873,6 +4501,18 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    // load a jpeg image from whichever source, but leave in YCbCr format
    if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
 
+   // the component buffers now hold scaled pixels, so from here on every
+   // size is the scaled one, rounded up
+   if (z->scale_shift) {
+      int k, round = (1 << z->scale_shift) - 1;
+      z->s->img_x = (z->s->img_x + round) >> z->scale_shift;
+      z->s->img_y = (z->s->img_y + round) >> z->scale_shift;
+      for (k=0; k < z->s->img_n; ++k) {
+         z->img_comp[k].x = (z->img_comp[k].x + round) >> z->scale_shift;
+         z->img_comp[k].y = (z->img_comp[k].y + round) >> z->scale_shift;
+      }
+   }
+
    // determine actual number of components to generate
    n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
 
@@ -3893,6 +4533,8 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
       unsigned int i,j;
       stbi_uc *output;
       stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
+      int flip = z->s->output_conversion & STBI_CONVERT_FLIP_VERTICALLY;
+      int row_flags = z->s->output_conversion & ~STBI_CONVERT_FLIP_VERTICALLY;
 
       stbi__resample res_comp[4];
 
@@ -3922,9 +4564,16 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
       output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
       if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
 
-      // now go ahead and resample
+      // now go ahead and resample; requested output conversions are applied
+      // to each row right after it's written, and flipping just picks the row
       for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
+         unsigned int out_row = flip ? z->s->img_y - 1 - j : j;
+         stbi_uc *out = output + n * z->s->img_x * out_row;
+         stbi_uc *out_start = out;
+         // the n==3 row writers store a 4th byte past the last pixel; that
+         // lands on an already written row when flipping, so keep it safe
+         stbi_uc *row_end = out + n * z->s->img_x;
+         stbi_uc saved = (flip && out_row + 1 < z->s->img_y) ? *row_end : 0;
          for (k=0; k < decode_n; ++k) {
             stbi__resample *r = &res_comp[k];
             int y_bot = r->ystep >= (r->vs >> 1);
@@ -4016,6 +4665,10 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
                   for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
             }
          }
+         if (flip && out_row + 1 < z->s->img_y)
+            *row_end = saved;
+         if (row_flags)
+            stbi__convert_row(out_start, z->s->img_x, n, row_flags);
       }
       stbi__cleanup_jpeg(z);
       *out_x = z->s->img_x;
@@ -4031,11 +4684,12 @@ static void *stbi__jpeg_load(stbi__context *s, int *x, int *y, int *comp, int re
    stbi__jpeg* j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
    if (!j) return stbi__errpuc("outofmem", "Out of memory");
    memset(j, 0, sizeof(stbi__jpeg));
-   STBI_NOTUSED(ri);
    j->s = s;
+   j->scale_shift = stbi__jpeg_scale_shift;
    stbi__setup_jpeg(j);
    result = load_jpeg_image(j, x,y,comp,req_comp);
-   STBI_FREE(j);
+   if (result) ri->conversions_done = s->output_conversion;
+   stbi__free(j);
    return result;
 }
 
@@ -4049,7 +4703,7 @@ static int stbi__jpeg_test(stbi__context *s)
    stbi__setup_jpeg(j);
    r = stbi__decode_jpeg_header(j, STBI__SCAN_type);
    stbi__rewind(s);
-   STBI_FREE(j);
+   stbi__free(j);
    return r;
 }
 
@@ -4073,7 +4727,7 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
    memset(j, 0, sizeof(stbi__jpeg));
    j->s = s;
    result = stbi__jpeg_info_raw(j, x, y, comp);
-   STBI_FREE(j);
+   stbi__free(j);
    return result;
 }
 #endif
@@ -4283,7 +4937,7 @@ static int stbi__zexpand(stbi__zbuf *z, char *zout, int n)  // need to make room
       if(limit > UINT_MAX / 2) return stbi__err("outofmem", "Out of memory");
       limit *= 2;
    }
-   q = (char *) STBI_REALLOC_SIZED(z->zout_start, old_limit, limit);
+   q = (char *) stbi__realloc_sized(z->zout_start, old_limit, limit);
    STBI_NOTUSED(old_limit);
    if (q == NULL) return stbi__err("outofmem", "Out of memory");
    z->zout_start = q;
@@ -4528,7 +5182,7 @@ STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int
       if (outlen) *outlen = (int) (a.zout - a.zout_start);
       return a.zout_start;
    } else {
-      STBI_FREE(a.zout_start);
+      stbi__free(a.zout_start);
       return NULL;
    }
 }
@@ -4549,7 +5203,7 @@ STBIDEF char *stbi_zlib_decode_malloc_guesssize_headerflag(const char *buffer, i
       if (outlen) *outlen = (int) (a.zout - a.zout_start);
       return a.zout_start;
    } else {
-      STBI_FREE(a.zout_start);
+      stbi__free(a.zout_start);
       return NULL;
    }
 }
@@ -4576,7 +5230,7 @@ STBIDEF char *stbi_zlib_decode_noheader_malloc(char const *buffer, int len, int
       if (outlen) *outlen = (int) (a.zout - a.zout_start);
       return a.zout_start;
    } else {
-      STBI_FREE(a.zout_start);
+      stbi__free(a.zout_start);
       return NULL;
    }
 }
@@ -4692,32 +5346,42 @@ static void stbi__create_png_alpha_expand8(stbi_uc *dest, stbi_uc *src, stbi__ui
    }
 }
 
-// create the png data from post-deflated data
-static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
+// one run of scanlines to unfilter: the whole image, or one Adam7 pass
+typedef struct
 {
-   int bytes = (depth == 16 ? 2 : 1);
-   stbi__context *s = a->s;
-   stbi__uint32 i,j,stride = x*out_n*bytes;
-   stbi__uint32 img_len, img_width_bytes;
-   stbi_uc *filter_buf;
-   int all_ok = 1;
-   int k;
-   int img_n = s->img_n; // copy it into a local for later
+   stbi_uc *raw;          // filtered scanlines, already checked to be long enough
+   stbi_uc *out;          // where this pass's first pixel goes in the final image
+   stbi__uint32 x, y;     // pass size in pixels
+   size_t out_row_stride; // bytes between consecutive pass rows in the output
+   int out_pixel_step;    // bytes between consecutive pass pixels in the output
+   stbi_uc *filter_buf;   // two filter rows, plus a row to expand into if strided
+   int ok;
+} stbi__png_pass;
 
-   int output_bytes = out_n*bytes;
-   int filter_bytes = img_n*bytes;
-   int width = x;
+typedef struct
+{
+   stbi__png_pass pass[7];
+   int img_n, out_n, depth, color;
+} stbi__png_passes;
 
-   STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
-   a->out = (stbi_uc *) stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
-   if (!a->out) return stbi__err("outofmem", "Out of memory");
+static stbi__uint32 stbi__png_width_bytes(int img_n, stbi__uint32 x, int depth)
+{
+   return (((img_n * x * depth) + 7) >> 3);
+}
 
-   // note: error exits here don't need to clean up a->out individually,
-   // stbi__do_png always does on error.
-   if (!stbi__mad3sizes_valid(img_n, x, depth, 7)) return stbi__err("too large", "Corrupt PNG");
-   img_width_bytes = (((img_n * x * depth) + 7) >> 3);
-   if (!stbi__mad2sizes_valid(img_width_bytes, y, img_width_bytes)) return stbi__err("too large", "Corrupt PNG");
-   img_len = (img_width_bytes + 1) * y;
+// validate a pass and allocate its workspace; done on the decoding thread so
+// the unfilter itself needs no allocation and can run anywhere
+static int stbi__png_setup_pass(stbi__png_passes *ps, stbi__png_pass *pass, stbi_uc *raw, stbi__uint32 raw_len)
+{
+   int bytes = (ps->depth == 16 ? 2 : 1);
+   int output_bytes = ps->out_n*bytes;
+   int strided = pass->out_pixel_step != output_bytes;
+   stbi__uint32 img_len, img_width_bytes;
+
+   if (!stbi__mad3sizes_valid(ps->img_n, pass->x, ps->depth, 7)) return stbi__err("too large", "Corrupt PNG");
+   img_width_bytes = stbi__png_width_bytes(ps->img_n, pass->x, ps->depth);
+   if (!stbi__mad2sizes_valid(img_width_bytes, pass->y, img_width_bytes)) return stbi__err("too large", "Corrupt PNG");
+   img_len = (img_width_bytes + 1) * pass->y;
 
    // we used to check for exact match between raw_len and img_len on non-interlaced PNGs,
    // but issue #276 reported a PNG in the wild that had extra data at the end (all zeros),
@@ -4725,8 +5389,39 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    if (raw_len < img_len) return stbi__err("not enough pixels","Corrupt PNG");
 
    // Allocate two scan lines worth of filter workspace buffer.
-   filter_buf = (stbi_uc *) stbi__malloc_mad2(img_width_bytes, 2, 0);
-   if (!filter_buf) return stbi__err("outofmem", "Out of memory");
+   if (strided) {
+      if (!stbi__mad3sizes_valid(pass->x, output_bytes, 1, img_width_bytes*2)) return stbi__err("too large", "Corrupt PNG");
+      pass->filter_buf = (stbi_uc *) stbi__malloc(img_width_bytes*2 + pass->x*output_bytes);
+   } else
+      pass->filter_buf = (stbi_uc *) stbi__malloc_mad2(img_width_bytes, 2, 0);
+   if (!pass->filter_buf) return stbi__err("outofmem", "Out of memory");
+
+   pass->raw = raw;
+   pass->ok = 1;
+   return 1;
+}
+
+// unfilter one pass; touches nothing but the pass's own buffers and output
+// pixels, so the seven Adam7 passes can run concurrently
+static void stbi__png_unfilter_pass(void *data, int index)
+{
+   stbi__png_passes *ps = (stbi__png_passes *) data;
+   stbi__png_pass *pass = &ps->pass[index];
+   int depth = ps->depth, color = ps->color;
+   int out_n = ps->out_n;
+   int bytes = (depth == 16 ? 2 : 1);
+   stbi__uint32 i,j;
+   stbi__uint32 x = pass->x, y = pass->y;
+   stbi__uint32 img_width_bytes = stbi__png_width_bytes(ps->img_n, x, depth);
+   stbi_uc *raw = pass->raw;
+   stbi_uc *filter_buf = pass->filter_buf;
+   int k;
+   int img_n = ps->img_n;
+
+   int output_bytes = out_n*bytes;
+   int filter_bytes = img_n*bytes;
+   int width = x;
+   int strided = pass->out_pixel_step != output_bytes;
 
    // Filtering for low-bit-depth images
    if (depth < 8) {
@@ -4738,14 +5433,14 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       // cur/prior filter buffers alternate
       stbi_uc *cur = filter_buf + (j & 1)*img_width_bytes;
       stbi_uc *prior = filter_buf + (~j & 1)*img_width_bytes;
-      stbi_uc *dest = a->out + stride*j;
+      stbi_uc *dest = strided ? filter_buf + 2*img_width_bytes : pass->out + pass->out_row_stride*j;
       int nk = width * filter_bytes;
       int filter = *raw++;
 
       // check filter type
       if (filter > 4) {
-         all_ok = stbi__err("invalid filter","Corrupt PNG");
-         break;
+         pass->ok = 0;
+         return;
       }
 
       // if first row, use special filter that doesn't sample previous row
@@ -4850,54 +5545,106 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
             }
          }
       }
+
+      // interlaced passes scatter the finished row straight into the final
+      // image while it's still in cache
+      if (strided) {
+         stbi_uc *o = pass->out + pass->out_row_stride*j;
+         for (i=0; i < x; ++i, o += pass->out_pixel_step)
+            for (k=0; k < output_bytes; ++k)
+               o[k] = dest[i*output_bytes + k];
+      }
    }
+}
+
+// create the png data from post-deflated data
+static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
+{
+   int bytes = (depth == 16 ? 2 : 1);
+   stbi__png_passes ps;
+   stbi__png_pass *pass = &ps.pass[0];
+
+   STBI_ASSERT(out_n == a->s->img_n || out_n == a->s->img_n+1);
+   a->out = (stbi_uc *) stbi__malloc_mad3(x, y, out_n*bytes, 0); // extra bytes to write off the end into
+   if (!a->out) return stbi__err("outofmem", "Out of memory");
 
-   STBI_FREE(filter_buf);
-   if (!all_ok) return 0;
+   // note: error exits here don't need to clean up a->out individually,
+   // stbi__do_png always does on error.
+   ps.img_n = a->s->img_n;
+   ps.out_n = out_n;
+   ps.depth = depth;
+   ps.color = color;
+   pass->out = a->out;
+   pass->x = x;
+   pass->y = y;
+   pass->out_row_stride = (size_t) x*out_n*bytes;
+   pass->out_pixel_step = out_n*bytes;
+   if (!stbi__png_setup_pass(&ps, pass, raw, raw_len)) return 0;
+
+   stbi__png_unfilter_pass(&ps, 0);
+   stbi__free(pass->filter_buf);
+   if (!pass->ok) return stbi__err("invalid filter","Corrupt PNG");
 
    return 1;
 }
 
 static int stbi__create_png_image(stbi__png *a, stbi_uc *image_data, stbi__uint32 image_data_len, int out_n, int depth, int color, int interlaced)
 {
+   static const int xorig[] = { 0,4,0,2,0,1,0 };
+   static const int yorig[] = { 0,0,4,0,2,0,1 };
+   static const int xspc[]  = { 8,8,4,4,2,2,1 };
+   static const int yspc[]  = { 8,8,8,4,4,2,2 };
    int bytes = (depth == 16 ? 2 : 1);
    int out_bytes = out_n * bytes;
+   size_t row_bytes;
    stbi_uc *final;
-   int p;
+   stbi__png_passes ps;
+   int p, n = 0, all_ok = 1;
    if (!interlaced)
       return stbi__create_png_image_raw(a, image_data, image_data_len, out_n, a->s->img_x, a->s->img_y, depth, color);
 
-   // de-interlacing
+   // de-interlacing: each pass unfilters straight into its pixels of the
+   // final image, and since inflate is done the passes are independent
+   STBI_ASSERT(out_n == a->s->img_n || out_n == a->s->img_n+1);
    final = (stbi_uc *) stbi__malloc_mad3(a->s->img_x, a->s->img_y, out_bytes, 0);
    if (!final) return stbi__err("outofmem", "Out of memory");
+   row_bytes = (size_t) a->s->img_x * out_bytes;
+   ps.img_n = a->s->img_n;
+   ps.out_n = out_n;
+   ps.depth = depth;
+   ps.color = color;
    for (p=0; p < 7; ++p) {
-      int xorig[] = { 0,4,0,2,0,1,0 };
-      int yorig[] = { 0,0,4,0,2,0,1 };
-      int xspc[]  = { 8,8,4,4,2,2,1 };
-      int yspc[]  = { 8,8,8,4,4,2,2 };
-      int i,j,x,y;
+      stbi__png_pass *pass = &ps.pass[n];
       // pass1_x[4] = 0, pass1_x[5] = 1, pass1_x[12] = 1
-      x = (a->s->img_x - xorig[p] + xspc[p]-1) / xspc[p];
-      y = (a->s->img_y - yorig[p] + yspc[p]-1) / yspc[p];
-      if (x && y) {
-         stbi__uint32 img_len = ((((a->s->img_n * x * depth) + 7) >> 3) + 1) * y;
-         if (!stbi__create_png_image_raw(a, image_data, image_data_len, out_n, x, y, depth, color)) {
-            STBI_FREE(final);
-            return 0;
-         }
-         for (j=0; j < y; ++j) {
-            for (i=0; i < x; ++i) {
-               int out_y = j*yspc[p]+yorig[p];
-               int out_x = i*xspc[p]+xorig[p];
-               memcpy(final + out_y*a->s->img_x*out_bytes + out_x*out_bytes,
-                      a->out + (j*x+i)*out_bytes, out_bytes);
-            }
-         }
-         STBI_FREE(a->out);
+      pass->x = (a->s->img_x - xorig[p] + xspc[p]-1) / xspc[p];
+      pass->y = (a->s->img_y - yorig[p] + yspc[p]-1) / yspc[p];
+      if (pass->x && pass->y) {
+         stbi__uint32 img_len = (stbi__png_width_bytes(a->s->img_n, pass->x, depth) + 1) * pass->y;
+         pass->out = final + yorig[p]*row_bytes + xorig[p]*out_bytes;
+         pass->out_row_stride = yspc[p]*row_bytes;
+         pass->out_pixel_step = xspc[p]*out_bytes;
+         if (!stbi__png_setup_pass(&ps, pass, image_data, image_data_len)) { all_ok = 0; break; }
+         ++n;
          image_data += img_len;
          image_data_len -= img_len;
       }
    }
+
+   if (all_ok) {
+      if (stbi__parallel_for_func && n > 1)
+         stbi__parallel_for_func(stbi__parallel_for_user, stbi__png_unfilter_pass, &ps, n);
+      else
+         for (p=0; p < n; ++p)
+            stbi__png_unfilter_pass(&ps, p);
+      for (p=0; p < n; ++p)
+         if (!ps.pass[p].ok) all_ok = stbi__err("invalid filter","Corrupt PNG");
+   }
+   for (p=0; p < n; ++p)
+      stbi__free(ps.pass[p].filter_buf);
+   if (!all_ok) {
+      stbi__free(final);
+      return 0;
+   }
    a->out = final;
 
    return 1;
@@ -4982,7 +5729,7 @@ static int stbi__expand_png_palette(stbi__png *a, stbi_uc *palette, int len, int
          p += 4;
       }
    }
-   STBI_FREE(a->out);
+   stbi__free(a->out);
    a->out = temp_out;
 
    STBI_NOTUSED(len);
@@ -5188,7 +5935,7 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
                while (ioff + c.length > idata_limit)
                   idata_limit *= 2;
                STBI_NOTUSED(idata_limit_old);
-               p = (stbi_uc *) STBI_REALLOC_SIZED(z->idata, idata_limit_old, idata_limit); if (p == NULL) return stbi__err("outofmem", "Out of memory");
+               p = (stbi_uc *) stbi__realloc_sized(z->idata, idata_limit_old, idata_limit); if (p == NULL) return stbi__err("outofmem", "Out of memory");
                z->idata = p;
             }
             if (!stbi__getn(s, z->idata+ioff,c.length)) return stbi__err("outofdata","Corrupt PNG");
@@ -5206,7 +5953,7 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
             raw_len = bpl * s->img_y * s->img_n /* pixels */ + s->img_y /* filter mode per row */;
             z->expanded = (stbi_uc *) stbi_zlib_decode_malloc_guesssize_headerflag((char *) z->idata, ioff, raw_len, (int *) &raw_len, !is_iphone);
             if (z->expanded == NULL) return 0; // zlib should set error
-            STBI_FREE(z->idata); z->idata = NULL;
+            stbi__free(z->idata); z->idata = NULL;
             if ((req_comp == s->img_n+1 && req_comp != 3 && !pal_img_n) || has_trans)
                s->img_out_n = s->img_n+1;
             else
@@ -5232,7 +5979,7 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
                // non-paletted image with tRNS -> source image has (constant) alpha
                ++s->img_n;
             }
-            STBI_FREE(z->expanded); z->expanded = NULL;
+            stbi__free(z->expanded); z->expanded = NULL;
             // end of PNG chunk, read and skip CRC
             stbi__get32be(s);
             return 1;
@@ -5274,9 +6021,10 @@ static void *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req_comp, st
       result = p->out;
       p->out = NULL;
       if (req_comp && req_comp != p->s->img_out_n) {
-         if (ri->bits_per_channel == 8)
-            result = stbi__convert_format((unsigned char *) result, p->s->img_out_n, req_comp, p->s->img_x, p->s->img_y);
-         else
+         if (ri->bits_per_channel == 8) {
+            result = stbi__convert_format_flags((unsigned char *) result, p->s->img_out_n, req_comp, p->s->img_x, p->s->img_y, p->s->output_conversion);
+            ri->conversions_done = p->s->output_conversion;
+         } else
             result = stbi__convert_format16((stbi__uint16 *) result, p->s->img_out_n, req_comp, p->s->img_x, p->s->img_y);
          p->s->img_out_n = req_comp;
          if (result == NULL) return result;
@@ -5285,9 +6033,9 @@ static void *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req_comp, st
       *y = p->s->img_y;
       if (n) *n = p->s->img_n;
    }
-   STBI_FREE(p->out);      p->out      = NULL;
-   STBI_FREE(p->expanded); p->expanded = NULL;
-   STBI_FREE(p->idata);    p->idata    = NULL;
+   stbi__free(p->out);      p->out      = NULL;
+   stbi__free(p->expanded); p->expanded = NULL;
+   stbi__free(p->idata);    p->idata    = NULL;
 
    return result;
 }
@@ -5598,7 +6346,7 @@ static void *stbi__bmp_load(stbi__context *s, int *x, int *y, int *comp, int req
    if (!out) return stbi__errpuc("outofmem", "Out of memory");
    if (info.bpp < 16) {
       int z=0;
-      if (psize == 0 || psize > 256) { STBI_FREE(out); return stbi__errpuc("invalid", "Corrupt BMP"); }
+      if (psize == 0 || psize > 256) { stbi__free(out); return stbi__errpuc("invalid", "Corrupt BMP"); }
       for (i=0; i < psize; ++i) {
          pal[i][2] = stbi__get8(s);
          pal[i][1] = stbi__get8(s);
@@ -5610,7 +6358,7 @@ static void *stbi__bmp_load(stbi__context *s, int *x, int *y, int *comp, int req
       if (info.bpp == 1) width = (s->img_x + 7) >> 3;
       else if (info.bpp == 4) width = (s->img_x + 1) >> 1;
       else if (info.bpp == 8) width = s->img_x;
-      else { STBI_FREE(out); return stbi__errpuc("bad bpp", "Corrupt BMP"); }
+      else { stbi__free(out); return stbi__errpuc("bad bpp", "Corrupt BMP"); }
       pad = (-width)&3;
       if (info.bpp == 1) {
          for (j=0; j < (int) s->img_y; ++j) {
@@ -5667,13 +6415,13 @@ static void *stbi__bmp_load(stbi__context *s, int *x, int *y, int *comp, int req
             easy = 2;
       }
       if (!easy) {
-         if (!mr || !mg || !mb) { STBI_FREE(out); return stbi__errpuc("bad masks", "Corrupt BMP"); }
+         if (!mr || !mg || !mb) { stbi__free(out); return stbi__errpuc("bad masks", "Corrupt BMP"); }
          // right shift amt to put high bit in position #7
          rshift = stbi__high_bit(mr)-7; rcount = stbi__bitcount(mr);
          gshift = stbi__high_bit(mg)-7; gcount = stbi__bitcount(mg);
          bshift = stbi__high_bit(mb)-7; bcount = stbi__bitcount(mb);
          ashift = stbi__high_bit(ma)-7; acount = stbi__bitcount(ma);
-         if (rcount > 8 || gcount > 8 || bcount > 8 || acount > 8) { STBI_FREE(out); return stbi__errpuc("bad masks", "Corrupt BMP"); }
+         if (rcount > 8 || gcount > 8 || bcount > 8 || acount > 8) { stbi__free(out); return stbi__errpuc("bad masks", "Corrupt BMP"); }
       }
       for (j=0; j < (int) s->img_y; ++j) {
          if (easy) {
@@ -5941,7 +6689,7 @@ static void *stbi__tga_load(stbi__context *s, int *x, int *y, int *comp, int req
       if ( tga_indexed)
       {
          if (tga_palette_len == 0) {  /* you have to have at least one entry! */
-            STBI_FREE(tga_data);
+            stbi__free(tga_data);
             return stbi__errpuc("bad palette", "Corrupt TGA");
          }
 
@@ -5950,7 +6698,7 @@ static void *stbi__tga_load(stbi__context *s, int *x, int *y, int *comp, int req
          //   load the palette
          tga_palette = (unsigned char*)stbi__malloc_mad2(tga_palette_len, tga_comp, 0);
          if (!tga_palette) {
-            STBI_FREE(tga_data);
+            stbi__free(tga_data);
             return stbi__errpuc("outofmem", "Out of memory");
          }
          if (tga_rgb16) {
@@ -5961,8 +6709,8 @@ static void *stbi__tga_load(stbi__context *s, int *x, int *y, int *comp, int req
                pal_entry += tga_comp;
             }
          } else if (!stbi__getn(s, tga_palette, tga_palette_len * tga_comp)) {
-               STBI_FREE(tga_data);
-               STBI_FREE(tga_palette);
+               stbi__free(tga_data);
+               stbi__free(tga_palette);
                return stbi__errpuc("bad palette", "Corrupt TGA");
          }
       }
@@ -6043,7 +6791,7 @@ static void *stbi__tga_load(stbi__context *s, int *x, int *y, int *comp, int req
       //   clear my palette, if I had one
       if ( tga_palette != NULL )
       {
-         STBI_FREE( tga_palette );
+         stbi__free( tga_palette );
       }
    }
 
@@ -6235,7 +6983,7 @@ static void *stbi__psd_load(stbi__context *s, int *x, int *y, int *comp, int req
          } else {
             // Read the RLE data.
             if (!stbi__psd_decode_rle(s, p, pixelCount)) {
-               STBI_FREE(out);
+               stbi__free(out);
                return stbi__errpuc("corrupt", "bad RLE data");
             }
          }
@@ -6527,7 +7275,7 @@ static void *stbi__pic_load(stbi__context *s,int *px,int *py,int *comp,int req_c
    memset(result, 0xff, x*y*4);
 
    if (!stbi__pic_load_core(s,x,y,comp, result)) {
-      STBI_FREE(result);
+      stbi__free(result);
       result=0;
    }
    *px = x;
@@ -6641,13 +7389,13 @@ static int stbi__gif_info_raw(stbi__context *s, int *x, int *y, int *comp)
    stbi__gif* g = (stbi__gif*) stbi__malloc(sizeof(stbi__gif));
    if (!g) return stbi__err("outofmem", "Out of memory");
    if (!stbi__gif_header(s, g, comp, 1)) {
-      STBI_FREE(g);
+      stbi__free(g);
       stbi__rewind( s );
       return 0;
    }
    if (x) *x = g->w;
    if (y) *y = g->h;
-   STBI_FREE(g);
+   stbi__free(g);
    return 1;
 }
 
@@ -6951,12 +7699,12 @@ static stbi_uc *stbi__gif_load_next(stbi__context *s, stbi__gif *g, int *comp, i
 
 static void *stbi__load_gif_main_outofmem(stbi__gif *g, stbi_uc *out, int **delays)
 {
-   STBI_FREE(g->out);
-   STBI_FREE(g->history);
-   STBI_FREE(g->background);
+   stbi__free(g->out);
+   stbi__free(g->history);
+   stbi__free(g->background);
 
-   if (out) STBI_FREE(out);
-   if (delays && *delays) STBI_FREE(*delays);
+   if (out) stbi__free(out);
+   if (delays && *delays) stbi__free(*delays);
    return stbi__errpuc("outofmem", "Out of memory");
 }
 
@@ -6991,7 +7739,7 @@ static void *stbi__load_gif_main(stbi__context *s, int **delays, int *x, int *y,
             stride = g.w * g.h * 4;
 
             if (out) {
-               void *tmp = (stbi_uc*) STBI_REALLOC_SIZED( out, out_size, layers * stride );
+               void *tmp = (stbi_uc*) stbi__realloc_sized( out, out_size, layers * stride );
                if (!tmp)
                   return stbi__load_gif_main_outofmem(&g, out, delays);
                else {
@@ -7000,7 +7748,7 @@ static void *stbi__load_gif_main(stbi__context *s, int **delays, int *x, int *y,
                }
 
                if (delays) {
-                  int *new_delays = (int*) STBI_REALLOC_SIZED( *delays, delays_size, sizeof(int) * layers );
+                  int *new_delays = (int*) stbi__realloc_sized( *delays, delays_size, sizeof(int) * layers );
                   if (!new_delays)
                      return stbi__load_gif_main_outofmem(&g, out, delays);
                   *delays = new_delays;
@@ -7020,7 +7768,7 @@ static void *stbi__load_gif_main(stbi__context *s, int **delays, int *x, int *y,
             }
             memcpy( out + ((layers - 1) * stride), u, stride );
             if (layers >= 2) {
-               two_back = out - 2 * stride;
+               two_back = out + (layers - 2) * stride;
             }
 
             if (delays) {
@@ -7030,9 +7778,9 @@ static void *stbi__load_gif_main(stbi__context *s, int **delays, int *x, int *y,
       } while (u != 0);
 
       // free temp buffer;
-      STBI_FREE(g.out);
-      STBI_FREE(g.history);
-      STBI_FREE(g.background);
+      stbi__free(g.out);
+      stbi__free(g.history);
+      stbi__free(g.background);
 
       // do the final conversion after loading everything;
       if (req_comp && req_comp != 4)
@@ -7064,12 +7812,12 @@ static void *stbi__gif_load(stbi__context *s, int *x, int *y, int *comp, int req
          u = stbi__convert_format(u, 4, req_comp, g.w, g.h);
    } else if (g.out) {
       // if there was an error and we allocated an image buffer, free it!
-      STBI_FREE(g.out);
+      stbi__free(g.out);
    }
 
    // free buffers needed for multiple frame loading;
-   STBI_FREE(g.history);
-   STBI_FREE(g.background);
+   stbi__free(g.history);
+   stbi__free(g.background);
 
    return u;
 }
@@ -7078,6 +7826,119 @@ static int stbi__gif_info(stbi__context *s, int *x, int *y, int *comp)
 {
    return stbi__gif_info_raw(s,x,y,comp);
 }
+
+// count frames by walking the block structure; no LZW decoding
+static int stbi__gif_count_frames(stbi__context *s)
+{
+   int frames = 0, flags, len;
+   stbi__skip(s, 10); // signature, width, height
+   flags = stbi__get8(s);
+   stbi__skip(s, 2);
+   if (flags & 0x80) stbi__skip(s, 3 * (2 << (flags & 7)));
+   while (!stbi__at_eof(s)) {
+      int tag = stbi__get8(s);
+      if (tag == 0x2C) { // Image Descriptor
+         stbi__skip(s, 8);
+         flags = stbi__get8(s);
+         if (flags & 0x80) stbi__skip(s, 3 * (2 << (flags & 7)));
+         stbi__get8(s); // lzw code size
+         while ((len = stbi__get8(s)) != 0) stbi__skip(s, len);
+         ++frames;
+      } else if (tag == 0x21) { // extension
+         stbi__get8(s);
+         while ((len = stbi__get8(s)) != 0) stbi__skip(s, len);
+      } else {
+         break; // trailer, or garbage the decoder will complain about
+      }
+   }
+   stbi__rewind(s);
+   return frames;
+}
+
+struct stbi_gif_stream
+{
+   stbi__context s;
+   stbi__gif g;
+   stbi_uc *prev[2]; // the last two composed frames, for "restore previous" disposal
+   stbi_uc *frame;   // flipped/converted copy handed out when conversions are on
+   int frames;       // frames composed so far
+   int done;
+};
+
+STBIDEF stbi_gif_stream *stbi_gif_stream_open_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *frames)
+{
+   int w, h;
+   stbi_gif_stream *gs = (stbi_gif_stream *) stbi__malloc(sizeof(stbi_gif_stream));
+   if (!gs) return (stbi_gif_stream *) stbi__errpuc("outofmem", "Out of memory");
+   memset(gs, 0, sizeof(*gs));
+   stbi__start_mem(&gs->s, buffer, len);
+   if (!stbi__gif_test(&gs->s) || !stbi__gif_info_raw(&gs->s, &w, &h, NULL)) {
+      stbi__free(gs);
+      return (stbi_gif_stream *) stbi__errpuc("not GIF", "Image was not as a gif type.");
+   }
+   stbi__rewind(&gs->s);
+   if (frames) *frames = stbi__gif_count_frames(&gs->s);
+   if (x) *x = w;
+   if (y) *y = h;
+   return gs;
+}
+
+STBIDEF stbi_uc *stbi_gif_stream_next(stbi_gif_stream *gs, int *delay_ms)
+{
+   stbi__gif *g = &gs->g;
+   stbi_uc *u, *two_back;
+   int stride, flags;
+
+   if (gs->done) return NULL;
+   two_back = gs->frames >= 2 ? gs->prev[gs->frames & 1] : NULL;
+   u = stbi__gif_load_next(&gs->s, g, NULL, 4, two_back);
+   if (u == (stbi_uc *) &gs->s) u = 0; // end of animated gif marker
+   if (!u) {
+      gs->done = 1;
+      return NULL;
+   }
+
+   // keep a copy in the slot that held frame n-2; it becomes "two back" for
+   // frame n+2. only two slots are ever needed
+   stride = g->w * g->h * 4;
+   if (!gs->prev[gs->frames & 1]) {
+      gs->prev[gs->frames & 1] = (stbi_uc *) stbi__malloc(stride);
+      if (!gs->prev[gs->frames & 1]) { gs->done = 1; return stbi__errpuc("outofmem", "Out of memory"); }
+   }
+   memcpy(gs->prev[gs->frames & 1], u, stride);
+   ++gs->frames;
+   if (delay_ms) *delay_ms = g->delay;
+
+   // g->out is the base for the next frame, so conversions go into a copy
+   flags = stbi__output_flags();
+   if (flags) {
+      int j;
+      if (!gs->frame) {
+         gs->frame = (stbi_uc *) stbi__malloc(stride);
+         if (!gs->frame) { gs->done = 1; return stbi__errpuc("outofmem", "Out of memory"); }
+      }
+      for (j=0; j < g->h; ++j) {
+         int out_row = (flags & STBI_CONVERT_FLIP_VERTICALLY) ? g->h - 1 - j : j;
+         stbi_uc *dest = gs->frame + out_row * g->w * 4;
+         memcpy(dest, u + j * g->w * 4, g->w * 4);
+         stbi__convert_row(dest, g->w, 4, flags);
+      }
+      return gs->frame;
+   }
+   return u;
+}
+
+STBIDEF void stbi_gif_stream_close(stbi_gif_stream *gs)
+{
+   if (!gs) return;
+   stbi__free(gs->frame);
+   stbi__free(gs->prev[1]);
+   stbi__free(gs->prev[0]);
+   stbi__free(gs->g.history);
+   stbi__free(gs->g.background);
+   stbi__free(gs->g.out);
+   stbi__free(gs);
+}
 #endif
 
 // *************************************************************************************************
@@ -7155,14 +8016,40 @@ static void stbi__hdr_convert(float *output, stbi_uc *input, int req_comp)
    }
 }
 
+// store one decoded rgbe pixel as floats, or as halves via a small float
+// temporary when decoding to half
+static void stbi__hdr_store(void *output, int half, size_t index, stbi_uc *rgbe, int req_comp)
+{
+#ifndef STBI_NO_LINEAR
+   if (half) {
+      float tmp[4];
+      stbi__hdr_convert(tmp, rgbe, req_comp);
+      stbi__float_to_half((stbi_us *) output + index, tmp, req_comp);
+      return;
+   }
+#else
+   STBI_NOTUSED(half);
+#endif
+   stbi__hdr_convert((float *) output + index, rgbe, req_comp);
+}
+
 static float *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri)
+{
+   return (float *) stbi__hdr_load_main(s, x, y, comp, req_comp, ri, 0);
+}
+
+// decode to floats, or with 'half' set, to IEEE halves one scanline at a time
+// so no full-size float image is ever allocated
+static void *stbi__hdr_load_main(stbi__context *s, int *x, int *y, int *comp, int req_comp, stbi__result_info *ri, int half)
 {
    char buffer[STBI__HDR_BUFLEN];
    char *token;
    int valid = 0;
    int width, height;
    stbi_uc *scanline;
-   float *hdr_data;
+   void *hdr_data;
+   float *row = NULL;
+   int bytes = half ? 2 : 4;
    int len;
    unsigned char count, value;
    int i, j, k, c1,c2, z;
@@ -7207,7 +8094,7 @@ static float *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int re
       return stbi__errpf("too large", "HDR image is too large");
 
    // Read data
-   hdr_data = (float *) stbi__malloc_mad4(width, height, req_comp, sizeof(float), 0);
+   hdr_data = stbi__malloc_mad4(width, height, req_comp, bytes, 0);
    if (!hdr_data)
       return stbi__errpf("outofmem", "Out of memory");
 
@@ -7220,7 +8107,7 @@ static float *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int re
             stbi_uc rgbe[4];
            main_decode_loop:
             stbi__getn(s, rgbe, 4);
-            stbi__hdr_convert(hdr_data + j * width * req_comp + i * req_comp, rgbe, req_comp);
+            stbi__hdr_store(hdr_data, half, (size_t) j * width * req_comp + i * req_comp, rgbe, req_comp);
          }
       }
    } else {
@@ -7239,19 +8126,24 @@ static float *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int re
             rgbe[1] = (stbi_uc) c2;
             rgbe[2] = (stbi_uc) len;
             rgbe[3] = (stbi_uc) stbi__get8(s);
-            stbi__hdr_convert(hdr_data, rgbe, req_comp);
+            stbi__hdr_store(hdr_data, half, 0, rgbe, req_comp);
             i = 1;
             j = 0;
-            STBI_FREE(scanline);
+            stbi__free(scanline);
+            stbi__free(row);
             goto main_decode_loop; // yes, this makes no sense
          }
          len <<= 8;
          len |= stbi__get8(s);
-         if (len != width) { STBI_FREE(hdr_data); STBI_FREE(scanline); return stbi__errpf("invalid decoded scanline length", "corrupt HDR"); }
+         if (len != width) { stbi__free(hdr_data); stbi__free(scanline); stbi__free(row); return stbi__errpf("invalid decoded scanline length", "corrupt HDR"); }
          if (scanline == NULL) {
             scanline = (stbi_uc *) stbi__malloc_mad2(width, 4, 0);
-            if (!scanline) {
-               STBI_FREE(hdr_data);
+            if (half)
+               row = (float *) stbi__malloc_mad3(width, req_comp, sizeof(float), 0);
+            if (!scanline || (half && !row)) {
+               stbi__free(hdr_data);
+               stbi__free(scanline);
+               stbi__free(row);
                return stbi__errpf("outofmem", "Out of memory");
             }
          }
@@ -7265,22 +8157,32 @@ static float *stbi__hdr_load(stbi__context *s, int *x, int *y, int *comp, int re
                   // Run
                   value = stbi__get8(s);
                   count -= 128;
-                  if ((count == 0) || (count > nleft)) { STBI_FREE(hdr_data); STBI_FREE(scanline); return stbi__errpf("corrupt", "bad RLE data in HDR"); }
+                  if ((count == 0) || (count > nleft)) { stbi__free(hdr_data); stbi__free(scanline); stbi__free(row); return stbi__errpf("corrupt", "bad RLE data in HDR"); }
                   for (z = 0; z < count; ++z)
                      scanline[i++ * 4 + k] = value;
                } else {
                   // Dump
-                  if ((count == 0) || (count > nleft)) { STBI_FREE(hdr_data); STBI_FREE(scanline); return stbi__errpf("corrupt", "bad RLE data in HDR"); }
+                  if ((count == 0) || (count > nleft)) { stbi__free(hdr_data); stbi__free(scanline); stbi__free(row); return stbi__errpf("corrupt", "bad RLE data in HDR"); }
                   for (z = 0; z < count; ++z)
                      scanline[i++ * 4 + k] = stbi__get8(s);
                }
             }
          }
+#ifndef STBI_NO_LINEAR
+         if (half) {
+            // whole scanline to floats, then one vectorized half conversion
+            for (i=0; i < width; ++i)
+               stbi__hdr_convert(row + i*req_comp, scanline + i*4, req_comp);
+            stbi__float_to_half((stbi_us *) hdr_data + (size_t) j*width*req_comp, row, width*req_comp);
+            continue;
+         }
+#endif
          for (i=0; i < width; ++i)
-            stbi__hdr_convert(hdr_data+(j*width + i)*req_comp, scanline + i*4, req_comp);
+            stbi__hdr_convert((float *) hdr_data+(j*width + i)*req_comp, scanline + i*4, req_comp);
       }
       if (scanline)
-         STBI_FREE(scanline);
+         stbi__free(scanline);
+      stbi__free(row);
    }
 
    return hdr_data;
@@ -7525,7 +8427,7 @@ static void *stbi__pnm_load(stbi__context *s, int *x, int *y, int *comp, int req
    out = (stbi_uc *) stbi__malloc_mad4(s->img_n, s->img_x, s->img_y, ri->bits_per_channel / 8, 0);
    if (!out) return stbi__errpuc("outofmem", "Out of memory");
    if (!stbi__getn(s, out, s->img_n * s->img_x * s->img_y * (ri->bits_per_channel / 8))) {
-      STBI_FREE(out);
+      stbi__free(out);
       return stbi__errpuc("bad PNM", "PNM file truncated");
    }
 
@@ -14,8 +14,14 @@
 #define GLFW_INCLUDE_GLEXT
 #include <GLFW/glfw3.h>
 
+#include "./src/bvh.h"
 #include "./src/callback.h"
+#include "./src/jobs.h"
+#include "./src/lod.h"
+#include "./src/occlusion_query.h"
+#include "./src/scene.h"
 #include "./src/shader.h"
+#include "./src/vertex_layout.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "./include/stb_image.h"
@@ -57,7 +63,7 @@ float vertices[] = {
     -0.5f, 0.5f,  0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f  // top left
 };
 
-unsigned int indices[] = {
+unsigned short indices[] = {
     0, 1, 3, // triangle
     1, 2, 3  // triangle
 };
@@ -67,29 +73,34 @@ GLuint ebo;
 GLuint vbo;
 GLuint vao;
 void process_buffers() {
+  // 20 bytes per vertex instead of the 32 of vertices[]
+  static const struct vertex_attrib attribs[] = {
+      {0, VERTEX_FLOAT3, 0},   // 3 point vertex
+      {1, VERTEX_UNORM8X3, 3}, // 3 color vertex
+      {2, VERTEX_HALF2, 6}     // 2 texture vertex
+  };
+  struct vertex_layout layout;
+  vertex_layout_init(&layout, attribs, 3);
+  size_t vertex_count = sizeof(vertices) / (8 * sizeof(float));
+  void* packed = malloc(vertex_count * layout.stride);
+  if(!packed) {
+    fprintf(stderr, "[Error] Could not allocate vertex buffer\n");
+    exit(1);
+  }
+  vertex_layout_pack(&layout, vertices, 8, vertex_count, packed);
+
   // vertex buffer object
   glGenBuffers(1, &vbo);
   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+  glBufferData(
+      GL_ARRAY_BUFFER, vertex_count * layout.stride, packed, GL_DYNAMIC_DRAW
+  );
+  free(packed);
 
   // vertex array object
   glGenVertexArrays(1, &vao);
   glBindVertexArray(vao);
-
-  glVertexAttribPointer(
-      0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0
-  ); // 3 point vertex
-  glEnableVertexAttribArray(0);
-
-  glVertexAttribPointer(
-      1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float))
-  ); // 3 color vertex
-  glEnableVertexAttribArray(1);
-
-  glVertexAttribPointer(
-      2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float))
-  ); // 2 texture vertex
-  glEnableVertexAttribArray(2);
+  process_vertex_layout(&layout, 0);
 
   // element buffer object
   glGenBuffers(1, &ebo);
@@ -103,11 +114,14 @@ void process_texture(
     char const* path, int texture_index, GLuint channel, bool flip
 ) {
   int width, height, nr_channels;
-  if(flip) {
-    stbi_set_flip_vertically_on_load(true);
-  }
-
-  unsigned char* data = stbi_load(path, &width, &height, &nr_channels, 0);
+  // flip while the decoder writes its rows instead of in a separate pass
+  stbi_set_output_conversion(flip ? STBI_CONVERT_FLIP_VERTICALLY : 0);
+
+  // hdr images are decoded straight to half floats, half the size of the
+  // 32-bit float path
+  bool is_hdr = stbi_is_hdr(path);
+  void* data = is_hdr ? (void*)stbi_loadh(path, &width, &height, &nr_channels, 3)
+                      : (void*)stbi_load(path, &width, &height, &nr_channels, 0);
   if(!data) {
     fprintf(stderr, "[Error] Could not load %s", path);
     exit(1);
@@ -123,15 +137,59 @@ void process_texture(
       GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR
   );
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexImage2D(
-      GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, channel, GL_UNSIGNED_BYTE,
-      data
-  );
+  if(is_hdr) {
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_HALF_FLOAT,
+        data
+    );
+  } else {
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, channel, GL_UNSIGNED_BYTE,
+        data
+    );
+  }
   glGenerateMipmap(GL_TEXTURE_2D);
 
   stbi_image_free(data);
 }
 
+float x_deg = 0.0f;
+struct scene scene;
+uint32_t quad_node;
+struct bvh bvh;
+struct occlusion_queries queries;
+struct lod quad_lod;
+int quad_level = 0;
+
+// exact hit against the quad's two triangles, in world space
+float quad_intersect(void* user, uint32_t object, vec3 origin, vec3 dir) {
+  (void)user;
+  (void)object;
+  vec4* world = scene_world(&scene, quad_node);
+  vec3 corners[4];
+  for(int i = 0; i < 4; i++) {
+    glm_mat4_mulv3(world, &vertices[i * 8], 1.0f, corners[i]);
+  }
+
+  float best = FLT_MAX, dist;
+  for(int i = 0; i < 6; i += 3) {
+    if(glm_ray_triangle(
+           origin, dir, corners[indices[i]], corners[indices[i + 1]],
+           corners[indices[i + 2]], &dist
+       ) &&
+       dist < best) {
+      best = dist;
+    }
+  }
+  return best;
+}
+
+// world box of the quad, the only object in the bvh
+void quad_box(vec3 dest[2]) {
+  vec3 local[2] = {{-0.5f, -0.5f, 0.0f}, {0.5f, 0.5f, 0.0f}};
+  glm_aabb_transform(local, scene_world(&scene, quad_node), dest);
+}
+
 // input handling on screen
 void process_mouse(GLFWwindow* window) {
   int width, height;
@@ -140,18 +198,45 @@ void process_mouse(GLFWwindow* window) {
   glfwGetCursorPos(window, &xpos, &ypos);
   xpos = xpos - width * 0.5f;
   ypos = (height - ypos) - height * 0.5f;
-}
 
-float x_deg = 0.0f;
+  // pick on press; the viewport is centered like xpos / ypos and there is no
+  // camera yet, so clip space is world space
+  static int last_state = GLFW_RELEASE;
+  int state = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
+  if(state == GLFW_PRESS && last_state == GLFW_RELEASE) {
+    mat4 view_proj = GLM_MAT4_IDENTITY_INIT;
+    vec4 viewport = {-width * 0.5f, -height * 0.5f, width, height};
+    float dist;
+    uint32_t hit = bvh_pick(
+        &bvh, view_proj, viewport, (float)xpos, (float)ypos, quad_intersect,
+        NULL, &dist
+    );
+    if(hit != BVH_EMPTY) {
+      printf("[Info] Picked object %u at distance %f\n", hit, dist);
+    }
+  }
+  last_state = state;
+}
 void process_math(GLuint program_id, double time) {
-  mat4 res;
-  glm_mat4_identity(res); // load identity matrix
-  glm_rotate(
-      res, glm_rad(x_deg), (vec3){1.0f, 0.0f, 0.0f}
-  ); // rotate 90deg along z-axis
-
-  GLuint transform_loc = glGetUniformLocation(program_id, "transform");
-  glUniformMatrix4fv(transform_loc, 1, GL_FALSE, *res);
+  // only touch the node when the angle moved, the uniform keeps its value
+  static float applied_deg = NAN;
+  if(x_deg != applied_deg) {
+    versor rotation;
+    glm_quatv(rotation, glm_rad(x_deg), (vec3){1.0f, 0.0f, 0.0f});
+    scene_set_rotation(&scene, quad_node, rotation);
+    applied_deg = x_deg;
+  }
+
+  if(scene_update(&scene) > 0) {
+    vec3 box[2];
+    quad_box(box);
+    bvh_refit(&bvh, &box);
+
+    GLuint transform_loc = glGetUniformLocation(program_id, "transform");
+    glUniformMatrix4fv(
+        transform_loc, 1, GL_FALSE, *scene_world(&scene, quad_node)
+    );
+  }
 }
 
 int main() {
@@ -183,6 +268,13 @@ int main() {
 
   printf("[Info] Using OpenGL %s\n", glGetString(GL_VERSION));
 
+#ifdef CGLM_RUNTIME_DISPATCH
+  // pick cglm kernels for this cpu once, before any math runs
+  static const char* const isa_names[] = {"generic", "sse2", "avx", "avx2",
+                                          "avx512"};
+  printf("[Info] Using cglm %s kernels\n", isa_names[glm_dispatch_init()]);
+#endif
+
   // check for ogl supported features that are used
   if(glDrawArraysInstanced == NULL) {
     fprintf(stderr, "[Error] Support for EXT_draw_instanced is required!\n");
@@ -196,6 +288,9 @@ int main() {
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  // occlusion queries test boxes against the depth of what was drawn
+  glEnable(GL_DEPTH_TEST);
+
   // wireframe mode
 
   // callbacks
@@ -209,23 +304,52 @@ int main() {
   glUniform1i(glGetUniformLocation(program, "texture1"), 0);
   glUniform1i(glGetUniformLocation(program, "texture2"), 1);
   process_buffers();
+  jobs_init(jobs_default_threads());
+  scene_init(&scene, 1);
+  quad_node = scene_add(&scene, SCENE_NO_PARENT);
+  scene_update(&scene);
+  vec3 box[2];
+  quad_box(box);
+  bvh_build(&bvh, &box, 1);
+  occlusion_queries_init(&queries, 1);
+  // the quad has a single level, bigger meshes append coarser ranges of
+  // their element buffer with smaller screen sizes
+  lod_init(&quad_lod, (vec4){0.0f, 0.0f, 0.0f, 0.7072f}, GL_UNSIGNED_SHORT);
+  lod_add_level(&quad_lod, 0, 6, 0.0f);
+  glUseProgram(program);
 
   // loop
   while(!glfwWindowShouldClose(window)) {
     double time = glfwGetTime();
 
     process_mouse(window);
+    occlusion_queries_poll(&queries);
 
     // clear frame before rendering
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // render
     process_math(program, time);
 
+    // there is no camera yet, so clip space is world space
+    mat4 view_proj = GLM_MAT4_IDENTITY_INIT;
+
     // glDrawArrays(GL_TRIANGLES, 0, 3); // render with vertex buffer object
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); // render with
-    // element buffer object indices and vertex buffer object
+    if(occlusion_queries_begin_draw(&queries, quad_node)) {
+      float size = lod_screen_size(
+          &quad_lod, scene_world(&scene, quad_node), view_proj, view_proj
+      );
+      quad_level =
+          lod_select(&quad_lod, quad_level, size, LOD_DEFAULT_HYSTERESIS);
+      lod_draw(&quad_lod, quad_level); // render with element buffer object
+      // indices and vertex buffer object
+      occlusion_queries_end_draw(&queries);
+    }
+
+    // query the boxes against this frame's depth, read back next frame
+    uint32_t object = 0;
+    occlusion_queries_issue(&queries, view_proj, bvh.boxes, &object, 1);
 
     // poll for events, call the registered callbacks & finally swap buffers on
     // window
@@ -233,6 +357,10 @@ int main() {
     glfwSwapBuffers(window);
   }
 
+  occlusion_queries_destroy(&queries);
+  bvh_destroy(&bvh);
+  scene_destroy(&scene);
+  jobs_shutdown();
   glfwTerminate();
   return 0;
 }
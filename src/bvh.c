@@ -0,0 +1,425 @@
+#include <float.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "bvh.h"
+
+#define BVH_BINS 16
+#define BVH_MAX_LEAF 4
+// past this depth splits fall back to halving, which keeps stacks bounded
+#define BVH_MAX_DEPTH 48
+#define BVH_STACK_SIZE 256
+
+// binary tree the SAH build makes, collapsed to 4-wide nodes afterwards
+struct bvh_build_node {
+  vec3 box[2];
+  uint32_t left, right; // inner nodes
+  uint32_t first, count; // leaves, count is 0 for inner nodes
+};
+
+struct bvh_builder {
+  struct bvh_build_node* nodes;
+  size_t count;
+  vec3 (*boxes)[2];
+  vec3* centers;
+  uint32_t* objects;
+};
+
+static void* bvh_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate bvh storage\n");
+    exit(1);
+  }
+  return p;
+}
+
+// half the surface area, the constant does not matter for SAH
+static float bvh_area(vec3 box[2]) {
+  vec3 d;
+  glm_vec3_sub(box[1], box[0], d);
+  return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+
+static void bvh_lane_set(struct bvh_node* node, int lane, vec3 box[2]) {
+  for(int k = 0; k < 3; k++) {
+    node->bounds[k][lane] = (box[1][k] + box[0][k]) * 0.5f;
+    node->bounds[k + 3][lane] = (box[1][k] - box[0][k]) * 0.5f;
+  }
+}
+
+static void bvh_lane_clear(struct bvh_node* node, int lane) {
+  // an inverted box is never visible, the slab test still needs the
+  // BVH_EMPTY check since it does not care about min / max order
+  for(int k = 0; k < 3; k++) {
+    node->bounds[k][lane] = 0.0f;
+    node->bounds[k + 3][lane] = -FLT_MAX;
+  }
+  node->child[lane] = BVH_EMPTY;
+  node->count[lane] = 0;
+}
+
+// union of the used lanes of a node
+static void bvh_node_box(struct bvh_node* node, vec3 dest[2]) {
+  glm_aabb_invalidate(dest);
+  for(int l = 0; l < 4; l++) {
+    if(node->child[l] == BVH_EMPTY) {
+      continue;
+    }
+    for(int k = 0; k < 3; k++) {
+      float c = node->bounds[k][l], e = node->bounds[k + 3][l];
+      dest[0][k] = glm_min(dest[0][k], c - e);
+      dest[1][k] = glm_max(dest[1][k], c + e);
+    }
+  }
+}
+
+static uint32_t bvh_build_node(
+    struct bvh_builder* b, uint32_t first, uint32_t count, int depth
+) {
+  uint32_t index = (uint32_t)b->count++;
+
+  vec3 box[2], centers[2];
+  glm_aabb_invalidate(box);
+  glm_aabb_invalidate(centers);
+  for(uint32_t i = first; i < first + count; i++) {
+    uint32_t o = b->objects[i];
+    glm_aabb_merge(box, b->boxes[o], box);
+    glm_vec3_minv(centers[0], b->centers[o], centers[0]);
+    glm_vec3_maxv(centers[1], b->centers[o], centers[1]);
+  }
+  glm_vec3_copy(box[0], b->nodes[index].box[0]);
+  glm_vec3_copy(box[1], b->nodes[index].box[1]);
+
+  // best binned split over all three axes
+  float best_cost = FLT_MAX;
+  int best_axis = -1, best_bin = 0;
+  for(int axis = 0; axis < 3 && depth < BVH_MAX_DEPTH && count > 1; axis++) {
+    float lo = centers[0][axis], extent = centers[1][axis] - lo;
+    if(extent <= 0.0f) {
+      continue;
+    }
+    float scale = BVH_BINS / extent;
+
+    vec3 bin_box[BVH_BINS][2];
+    uint32_t bin_count[BVH_BINS] = {0};
+    for(int k = 0; k < BVH_BINS; k++) {
+      glm_aabb_invalidate(bin_box[k]);
+    }
+    for(uint32_t i = first; i < first + count; i++) {
+      uint32_t o = b->objects[i];
+      int k = (int)((b->centers[o][axis] - lo) * scale);
+      k = k < BVH_BINS ? k : BVH_BINS - 1;
+      bin_count[k]++;
+      glm_aabb_merge(bin_box[k], b->boxes[o], bin_box[k]);
+    }
+
+    // left sweep stores, right sweep evaluates the split after bin k
+    float left_area[BVH_BINS];
+    uint32_t left_count[BVH_BINS];
+    vec3 acc[2];
+    uint32_t n = 0;
+    glm_aabb_invalidate(acc);
+    for(int k = 0; k < BVH_BINS - 1; k++) {
+      glm_aabb_merge(acc, bin_box[k], acc);
+      n += bin_count[k];
+      left_count[k] = n;
+      left_area[k] = n ? bvh_area(acc) : 0.0f;
+    }
+    glm_aabb_invalidate(acc);
+    n = 0;
+    for(int k = BVH_BINS - 1; k > 0; k--) {
+      glm_aabb_merge(acc, bin_box[k], acc);
+      n += bin_count[k];
+      if(n == 0 || left_count[k - 1] == 0) {
+        continue;
+      }
+      float cost = left_count[k - 1] * left_area[k - 1] + n * bvh_area(acc);
+      if(cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = k;
+      }
+    }
+  }
+
+  float area = bvh_area(box);
+  bool small = count <= BVH_MAX_LEAF;
+  bool no_gain = best_axis < 0 || area + best_cost >= count * area;
+  if(count == 1 || (small && no_gain)) {
+    b->nodes[index].first = first;
+    b->nodes[index].count = count;
+    return index;
+  }
+
+  uint32_t mid = count / 2;
+  if(best_axis >= 0) {
+    float lo = centers[0][best_axis];
+    float scale = BVH_BINS / (centers[1][best_axis] - lo);
+    uint32_t i = first, j = first + count;
+    while(i < j) {
+      int k = (int)((b->centers[b->objects[i]][best_axis] - lo) * scale);
+      if(k < best_bin) {
+        i++;
+      } else {
+        uint32_t t = b->objects[i];
+        b->objects[i] = b->objects[--j];
+        b->objects[j] = t;
+      }
+    }
+    if(i > first && i < first + count) {
+      mid = i - first;
+    }
+  }
+
+  uint32_t left = bvh_build_node(b, first, mid, depth + 1);
+  uint32_t right = bvh_build_node(b, first + mid, count - mid, depth + 1);
+  b->nodes[index].left = left;
+  b->nodes[index].right = right;
+  b->nodes[index].count = 0;
+  return index;
+}
+
+// 4-wide node from a binary one: keep opening the largest inner child until
+// there are four lanes
+static uint32_t bvh_collapse(
+    struct bvh* bvh, struct bvh_builder* b, uint32_t from
+) {
+  uint32_t index = (uint32_t)bvh->node_count++;
+  struct bvh_build_node* nodes = b->nodes;
+  uint32_t lanes[4];
+  int n = 0;
+
+  if(nodes[from].count) {
+    lanes[n++] = from;
+  } else {
+    lanes[n++] = nodes[from].left;
+    lanes[n++] = nodes[from].right;
+  }
+  while(n < 4) {
+    int open = -1;
+    float open_area = -1.0f;
+    for(int l = 0; l < n; l++) {
+      float area = bvh_area(nodes[lanes[l]].box);
+      if(nodes[lanes[l]].count == 0 && area > open_area) {
+        open = l;
+        open_area = area;
+      }
+    }
+    if(open < 0) {
+      break;
+    }
+    uint32_t c = lanes[open];
+    lanes[open] = nodes[c].left;
+    lanes[n++] = nodes[c].right;
+  }
+
+  for(int l = 0; l < 4; l++) {
+    struct bvh_node* node = &bvh->nodes[index];
+    if(l >= n) {
+      bvh_lane_clear(node, l);
+      continue;
+    }
+    struct bvh_build_node* c = &nodes[lanes[l]];
+    bvh_lane_set(node, l, c->box);
+    node->count[l] = c->count;
+    node->child[l] = c->count ? c->first : bvh_collapse(bvh, b, lanes[l]);
+  }
+  return index;
+}
+
+void bvh_build(struct bvh* bvh, vec3 (*boxes)[2], size_t count) {
+  bvh_destroy(bvh);
+  bvh->object_count = count;
+  bvh->boxes = bvh_alloc(count * sizeof(*bvh->boxes));
+  bvh->objects = bvh_alloc(count * sizeof(uint32_t));
+  memcpy(bvh->boxes, boxes, count * sizeof(*bvh->boxes));
+  if(count == 0) {
+    return;
+  }
+
+  // a binary tree with at most count leaves has fewer than 2 * count nodes
+  struct bvh_builder b = {
+      .boxes = bvh->boxes,
+      .objects = bvh->objects,
+  };
+  b.nodes = bvh_alloc(2 * count * sizeof(*b.nodes));
+  b.centers = bvh_alloc(count * sizeof(vec3));
+  for(size_t i = 0; i < count; i++) {
+    bvh->objects[i] = (uint32_t)i;
+    glm_aabb_center(boxes[i], b.centers[i]);
+  }
+  bvh_build_node(&b, 0, (uint32_t)count, 0);
+
+  // a 4-wide node replaces at least one binary inner node, or the root leaf
+  bvh->nodes = bvh_alloc(b.count * sizeof(struct bvh_node));
+  bvh_collapse(bvh, &b, 0);
+
+  free(b.nodes);
+  free(b.centers);
+}
+
+void bvh_refit(struct bvh* bvh, vec3 (*boxes)[2]) {
+  memcpy(bvh->boxes, boxes, bvh->object_count * sizeof(*bvh->boxes));
+
+  // children have higher indices than their parents
+  for(size_t i = bvh->node_count; i-- > 0;) {
+    struct bvh_node* node = &bvh->nodes[i];
+    for(int l = 0; l < 4; l++) {
+      vec3 box[2];
+      if(node->child[l] == BVH_EMPTY) {
+        continue;
+      }
+      if(node->count[l] == 0) {
+        bvh_node_box(&bvh->nodes[node->child[l]], box);
+      } else {
+        glm_aabb_invalidate(box);
+        for(uint32_t j = 0; j < node->count[l]; j++) {
+          uint32_t o = bvh->objects[node->child[l] + j];
+          glm_aabb_merge(box, bvh->boxes[o], box);
+        }
+      }
+      bvh_lane_set(node, l, box);
+    }
+  }
+}
+
+void bvh_destroy(struct bvh* bvh) {
+  free(bvh->nodes);
+  free(bvh->objects);
+  free(bvh->boxes);
+  memset(bvh, 0, sizeof(*bvh));
+}
+
+size_t bvh_frustum(struct bvh* bvh, vec4 planes[6], uint32_t* visible) {
+  uint32_t stack[BVH_STACK_SIZE];
+  size_t top = 0, n = 0;
+
+  if(bvh->node_count) {
+    stack[top++] = 0;
+  }
+  while(top > 0) {
+    struct bvh_node* node = &bvh->nodes[stack[--top]];
+    uint32_t lanes[4];
+    size_t hits =
+        glm_aabb_frustum_soa(node->bounds[0], 4, 0, 4, planes, lanes);
+
+    for(size_t h = 0; h < hits; h++) {
+      uint32_t l = lanes[h], child = node->child[l], count = node->count[l];
+      if(child == BVH_EMPTY) {
+        continue;
+      } else if(count == 0) {
+        stack[top++] = child;
+      } else if(count == 1) {
+        // the lane box is the object box
+        visible[n++] = bvh->objects[child];
+      } else {
+        for(uint32_t j = child; j < child + count; j++) {
+          if(glm_aabb_frustum(bvh->boxes[bvh->objects[j]], planes)) {
+            visible[n++] = bvh->objects[j];
+          }
+        }
+      }
+    }
+  }
+  return n;
+}
+
+uint32_t bvh_raycast(
+    struct bvh* bvh, vec3 origin, vec3 dir, bvh_intersect_fn intersect,
+    void* user, float* dist
+) {
+  struct {
+    uint32_t node;
+    float t;
+  } stack[BVH_STACK_SIZE];
+  size_t top = 0;
+  float best = FLT_MAX;
+  uint32_t hit = BVH_EMPTY;
+
+  if(bvh->node_count) {
+    stack[top].node = 0;
+    stack[top++].t = 0.0f;
+  }
+  while(top > 0) {
+    top--;
+    if(stack[top].t >= best) {
+      continue;
+    }
+    struct bvh_node* node = &bvh->nodes[stack[top].node];
+
+    // slab test wants min / max planes
+    float minmax[6][4], d[4];
+    for(int k = 0; k < 3; k++) {
+      for(int l = 0; l < 4; l++) {
+        minmax[k][l] = node->bounds[k][l] - node->bounds[k + 3][l];
+        minmax[k + 3][l] = node->bounds[k][l] + node->bounds[k + 3][l];
+      }
+    }
+    if(!glm_ray_aabbs_soa(origin, dir, minmax[0], 4, 4, d)) {
+      continue;
+    }
+
+    // nearest lane first, so leaves shrink best early and inner nodes are
+    // pushed far to near
+    int order[4], n = 0;
+    for(int l = 0; l < 4; l++) {
+      if(d[l] >= best || node->child[l] == BVH_EMPTY) {
+        continue;
+      }
+      int j = n++;
+      for(; j > 0 && d[order[j - 1]] > d[l]; j--) {
+        order[j] = order[j - 1];
+      }
+      order[j] = l;
+    }
+
+    for(int i = 0; i < n; i++) {
+      int l = order[i];
+      uint32_t child = node->child[l], count = node->count[l];
+      for(uint32_t j = child; j < child + count; j++) {
+        uint32_t o = bvh->objects[j];
+        float t;
+        if(!glm_ray_aabb(origin, dir, bvh->boxes[o], &t, NULL) || t >= best) {
+          continue;
+        }
+        t = intersect ? intersect(user, o, origin, dir) : glm_max(t, 0.0f);
+        if(t < best) {
+          best = t;
+          hit = o;
+        }
+      }
+    }
+    for(int i = n; i-- > 0;) {
+      int l = order[i];
+      if(node->count[l] == 0 && d[l] < best) {
+        stack[top].node = node->child[l];
+        stack[top++].t = d[l];
+      }
+    }
+  }
+
+  if(dist) {
+    *dist = best;
+  }
+  return hit;
+}
+
+uint32_t bvh_pick(
+    struct bvh* bvh, mat4 view_proj, vec4 viewport, float x, float y,
+    bvh_intersect_fn intersect, void* user, float* dist
+) {
+  mat4 inv;
+  vec3 near, far, dir;
+
+  glm_mat4_inv(view_proj, inv);
+  glm_unprojecti((vec3){x, y, 0.0f}, inv, viewport, near);
+  glm_unprojecti((vec3){x, y, 1.0f}, inv, viewport, far);
+  glm_vec3_sub(far, near, dir);
+  glm_vec3_normalize(dir);
+  return bvh_raycast(bvh, near, dir, intersect, user, dist);
+}
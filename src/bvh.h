@@ -0,0 +1,88 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef BVH_FUNCTIONS
+#define BVH_FUNCTIONS
+
+#define BVH_EMPTY UINT32_MAX
+
+/**
+ * One node of the 4-wide tree. Child boxes are SoA with four lanes,
+ * center.xyz then extent.xyz (the cglm/cull.h layout with stride 4), so a
+ * node is tested with a single SSE step. A lane is an inner node when
+ * count is 0 (child is its node index), a leaf of objects
+ * [child, child + count) of bvh.objects otherwise, or empty when child is
+ * BVH_EMPTY.
+ */
+struct bvh_node {
+  float bounds[6][4];
+  uint32_t child[4];
+  uint32_t count[4];
+};
+
+/**
+ * Bounding volume hierarchy over object boxes (cglm/box.h min / max).
+ * Node 0 is the root and parents always come before their children.
+ */
+struct bvh {
+  struct bvh_node* nodes;
+  size_t node_count;
+  uint32_t* objects; // object ids in leaf order
+  vec3 (*boxes)[2];  // box of each object id
+  size_t object_count;
+};
+
+/**
+ * Returns the distance along the ray to object, or FLT_MAX if it is missed.
+ * Used for exact hits (e.g. glm_ray_triangle over the object's triangles)
+ * once the ray reaches the object's box.
+ */
+typedef float (*bvh_intersect_fn)(
+    void* user, uint32_t object, vec3 origin, vec3 dir
+);
+
+/**
+ * Build the tree over count object boxes with a binned SAH split. Replaces
+ * whatever bvh held before, bvh must be zeroed or built before.
+ */
+void bvh_build(struct bvh* bvh, vec3 (*boxes)[2], size_t count);
+
+/**
+ * Take new boxes for the same objects and recompute node bounds without
+ * changing the tree. Quality drops as objects move far, rebuild then.
+ */
+void bvh_refit(struct bvh* bvh, vec3 (*boxes)[2]);
+
+/**
+ * Free the tree.
+ */
+void bvh_destroy(struct bvh* bvh);
+
+/**
+ * Write ids of objects whose boxes touch the frustum (glm_frustum_planes)
+ * to visible, which needs room for every object, and return how many.
+ */
+size_t bvh_frustum(struct bvh* bvh, vec4 planes[6], uint32_t* visible);
+
+/**
+ * Closest object hit by the ray, BVH_EMPTY if none. With intersect NULL an
+ * object is hit where the ray enters its box. dist (may be NULL) receives
+ * the distance in units of dir.
+ */
+uint32_t bvh_raycast(
+    struct bvh* bvh, vec3 origin, vec3 dir, bvh_intersect_fn intersect,
+    void* user, float* dist
+);
+
+/**
+ * bvh_raycast along the ray under a window position: x, y are relative to
+ * viewport (glm_unproject), view_proj takes bvh space to clip space.
+ */
+uint32_t bvh_pick(
+    struct bvh* bvh, mat4 view_proj, vec4 viewport, float x, float y,
+    bvh_intersect_fn intersect, void* user, float* dist
+);
+
+#endif
@@ -0,0 +1,29 @@
+// Kernel tables for cglm runtime dispatch (see include/cglm/dispatch.h).
+// Built once with the default flags, which also provides the resolver, and
+// once per x86 instruction set with -DCGLM_DISPATCH_KERNELS_ONLY plus the
+// matching -m flags (see Makefile). The compiler's own ISA macros pick the
+// table name, so each object only ever holds one table.
+
+#undef CGLM_RUNTIME_DISPATCH
+
+// callers only align mat4 for their own flags (16 bytes without AVX), so the
+// wider kernels must not use aligned 256-bit loads on them
+#define CGLM_ALL_UNALIGNED
+#include "../include/cglm/cglm.h"
+
+#ifndef CGLM_DISPATCH_KERNELS_ONLY
+#define CGLM_DISPATCH_IMPLEMENTATION
+#endif
+#include "../include/cglm/dispatch.h"
+
+#if !defined(CGLM_DISPATCH_KERNELS_ONLY)
+CGLM_DISPATCH_KERNELS(generic, GLM_ISA_GENERIC);
+#elif defined(__AVX512F__)
+CGLM_DISPATCH_KERNELS(avx512, GLM_ISA_AVX512);
+#elif defined(__AVX2__)
+CGLM_DISPATCH_KERNELS(avx2, GLM_ISA_AVX2);
+#elif defined(__AVX__)
+CGLM_DISPATCH_KERNELS(avx, GLM_ISA_AVX);
+#else
+#error "CGLM_DISPATCH_KERNELS_ONLY needs -mavx, -mavx2 -mfma or -mavx512f"
+#endif
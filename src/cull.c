@@ -0,0 +1,96 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "cull.h"
+#include "jobs.h"
+
+// below this a single thread is faster than waking the pool
+#define CULL_MIN_PER_THREAD 8192
+#define CULL_MAX_CHUNKS 64
+
+struct cull_job {
+  const float* bounds;
+  size_t stride, count, chunk;
+  vec4* planes;
+  uint32_t* visible;
+  size_t counts[CULL_MAX_CHUNKS];
+  bool spheres;
+};
+
+// every chunk writes its indices at its own offset, compacted afterwards
+static void cull_chunk(void* arg, size_t index) {
+  struct cull_job* job = arg;
+  size_t first = index * job->chunk;
+  size_t count = job->count - first < job->chunk ? job->count - first
+                                                 : job->chunk;
+  if(job->spheres) {
+    job->counts[index] = glm_sphere_frustum_soa(
+        job->bounds, job->stride, first, count, job->planes,
+        job->visible + first
+    );
+  } else {
+    job->counts[index] = glm_aabb_frustum_soa(
+        job->bounds, job->stride, first, count, job->planes,
+        job->visible + first
+    );
+  }
+}
+
+static size_t cull(
+    const float* bounds, size_t stride, size_t count, vec4 planes[6],
+    uint32_t* visible, bool spheres
+) {
+  size_t chunks = count / CULL_MIN_PER_THREAD;
+  size_t threads = (size_t)jobs_thread_count();
+  if(chunks > threads) {
+    chunks = threads;
+  }
+  if(chunks > CULL_MAX_CHUNKS) {
+    chunks = CULL_MAX_CHUNKS;
+  }
+  if(chunks <= 1 && spheres) {
+    return glm_sphere_frustum_soa(bounds, stride, 0, count, planes, visible);
+  }
+  if(chunks <= 1) {
+    return glm_aabb_frustum_soa(bounds, stride, 0, count, planes, visible);
+  }
+
+  struct cull_job job = {
+      .bounds = bounds,
+      .stride = stride,
+      .count = count,
+      // whole 16 item steps so only the last chunk has a scalar tail
+      .chunk = ((count + chunks - 1) / chunks + 15) & ~(size_t)15,
+      .planes = planes,
+      .visible = visible,
+      .spheres = spheres,
+  };
+  chunks = (count + job.chunk - 1) / job.chunk;
+  jobs_run(cull_chunk, &job, chunks);
+
+  size_t total = job.counts[0];
+  for(size_t i = 1; i < chunks; i++) {
+    memmove(
+        visible + total, visible + i * job.chunk,
+        job.counts[i] * sizeof(uint32_t)
+    );
+    total += job.counts[i];
+  }
+  return total;
+}
+
+size_t cull_boxes(
+    const float* bounds, size_t stride, size_t count, vec4 planes[6],
+    uint32_t* visible
+) {
+  return cull(bounds, stride, count, planes, visible, false);
+}
+
+size_t cull_spheres(
+    const float* spheres, size_t stride, size_t count, vec4 planes[6],
+    uint32_t* visible
+) {
+  return cull(spheres, stride, count, planes, visible, true);
+}
@@ -0,0 +1,27 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef CULL_FUNCTIONS
+#define CULL_FUNCTIONS
+
+/**
+ * Frustum cull count SoA boxes (center, extent; see cglm/cull.h), split
+ * across the job threads. Writes indices of visible boxes to visible in
+ * ascending order and returns how many there are.
+ */
+size_t cull_boxes(
+    const float* bounds, size_t stride, size_t count, vec4 planes[6],
+    uint32_t* visible
+);
+
+/**
+ * Same as cull_boxes for SoA spheres, planes must be normalized.
+ */
+size_t cull_spheres(
+    const float* spheres, size_t stride, size_t count, vec4 planes[6],
+    uint32_t* visible
+);
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/stb_image.h"
+
+#include "gif_texture.h"
+
+GLuint process_gif_texture(
+    char const* path, int texture_index, int* frame_count
+) {
+  FILE* file = fopen(path, "rb");
+  if(!file) {
+    fprintf(stderr, "[Error] Could not open %s\n", path);
+    exit(1);
+  }
+  fseek(file, 0, SEEK_END);
+  long len = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  unsigned char* buffer = len > 0 ? malloc(len) : NULL;
+  if(!buffer || fread(buffer, 1, len, file) != (size_t)len) {
+    fprintf(stderr, "[Error] Could not read %s\n", path);
+    exit(1);
+  }
+  fclose(file);
+
+  // the stream decodes out of buffer, which must outlive it
+  int width, height, frames;
+  stbi_gif_stream* gif = stbi_gif_stream_open_from_memory(
+      buffer, (int)len, &width, &height, &frames
+  );
+  if(!gif) {
+    fprintf(stderr, "[Error] Could not load %s\n", path);
+    exit(1);
+  }
+
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glActiveTexture(GL_TEXTURE0 + texture_index);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, frames, 0, GL_RGBA,
+      GL_UNSIGNED_BYTE, NULL
+  );
+
+  // each frame is only valid until the next one is composed, upload it now
+  int layer = 0, delay_ms;
+  unsigned char* frame;
+  while(layer < frames && (frame = stbi_gif_stream_next(gif, &delay_ms))) {
+    glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA,
+        GL_UNSIGNED_BYTE, frame
+    );
+    layer++;
+  }
+
+  stbi_gif_stream_close(gif);
+  free(buffer);
+  *frame_count = layer;
+  return texture;
+}
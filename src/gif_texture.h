@@ -0,0 +1,18 @@
+#include <GL/glew.h>
+
+#ifndef GIF_TEXTURE_FUNCTIONS
+#define GIF_TEXTURE_FUNCTIONS
+
+/**
+ * Stream the animated gif at path into a new GL_TEXTURE_2D_ARRAY bound on
+ * texture unit texture_index, one RGBA8 layer per frame. Storage for every
+ * frame is created once with glTexImage3D and each frame is uploaded with
+ * glTexSubImage3D as soon as it is composed, so only a few frames are ever
+ * in memory. The output conversion flags (e.g. a vertical flip) apply to
+ * every frame. frame_count receives the number of layers written.
+ */
+GLuint process_gif_texture(
+    char const* path, int texture_index, int* frame_count
+);
+
+#endif
@@ -0,0 +1,48 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "instance.h"
+
+GLsizei instance_format_size(enum instance_format format) {
+  switch(format) {
+  case INSTANCE_MAT4:
+    return 16 * sizeof(float);
+  case INSTANCE_AFFINE_3X4:
+    return 12 * sizeof(float);
+  case INSTANCE_QTS:
+    return 8 * sizeof(float);
+  case INSTANCE_ROTATION_SNORM16:
+    return 4 * sizeof(int16_t);
+  default:
+    fprintf(stderr, "[Error] Unknown instance format %d\n", format);
+    exit(1);
+  }
+}
+
+GLuint process_instance_attribs(GLuint location, enum instance_format format) {
+  GLsizei stride = instance_format_size(format);
+
+  if(format == INSTANCE_ROTATION_SNORM16) {
+    // normalized shorts, the shader sees floats in [-1, 1]
+    glVertexAttribPointer(location, 4, GL_SHORT, GL_TRUE, stride, (void*)0);
+    glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(location);
+    return 1;
+  }
+
+  // every other format is a run of vec4, one location each
+  GLuint count = (GLuint)(stride / (4 * sizeof(float)));
+  for(GLuint i = 0; i < count; i++) {
+    glVertexAttribPointer(
+        location + i, 4, GL_FLOAT, GL_FALSE, stride,
+        (void*)(i * 4 * sizeof(float))
+    );
+    glVertexAttribDivisor(location + i, 1);
+    glEnableVertexAttribArray(location + i);
+  }
+  return count;
+}
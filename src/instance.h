@@ -0,0 +1,60 @@
+#include <GL/glew.h>
+
+#ifndef INSTANCE_FUNCTIONS
+#define INSTANCE_FUNCTIONS
+
+/**
+ * Per instance transform formats, packed on the cpu with cglm/pack.h.
+ */
+enum instance_format {
+  INSTANCE_MAT4,             // mat4, 64 bytes, 4 locations
+  INSTANCE_AFFINE_3X4,       // glm_mat4_pack3x4, 48 bytes, 3 locations
+  INSTANCE_QTS,              // glm_mat4_pack_qts, 32 bytes, 2 locations
+  INSTANCE_ROTATION_SNORM16  // glm_quat_pack_snorm16, 8 bytes, 1 location
+};
+
+/**
+ * GLSL (330 core) decode snippets, paste into the vertex shader source before
+ * main(). Each one declares the instance attributes and a
+ * `vec3 instance_transform(vec3 p)` (or `instance_rotate`) to call from main.
+ */
+#define INSTANCE_GLSL_AFFINE_3X4(location)                                    \
+  "layout (location = " #location ") in mat3x4 instance_model;\n"             \
+  "vec3 instance_transform(vec3 p) {\n"                                       \
+  "  return vec4(p, 1.0) * instance_model;\n"                                 \
+  "}\n"
+
+#define INSTANCE_GLSL_QTS(rotation_location, translation_scale_location)      \
+  "layout (location = " #rotation_location ") in vec4 instance_rotation;\n"   \
+  "layout (location = " #translation_scale_location ")"                       \
+  " in vec4 instance_translation_scale;\n"                                    \
+  "vec3 instance_transform(vec3 p) {\n"                                       \
+  "  vec4 q = instance_rotation;\n"                                           \
+  "  vec3 t = 2.0 * cross(q.xyz, p);\n"                                       \
+  "  p += q.w * t + cross(q.xyz, t);\n"                                       \
+  "  return p * instance_translation_scale.w +"                               \
+  " instance_translation_scale.xyz;\n"                                        \
+  "}\n"
+
+// normalizing also absorbs the older (2c + 1) / 65535 snorm decode rule
+#define INSTANCE_GLSL_ROTATION_SNORM16(location)                              \
+  "layout (location = " #location ") in vec4 instance_rotation16;\n"          \
+  "vec3 instance_rotate(vec3 p) {\n"                                          \
+  "  vec4 q = normalize(instance_rotation16);\n"                              \
+  "  vec3 t = 2.0 * cross(q.xyz, p);\n"                                       \
+  "  return p + q.w * t + cross(q.xyz, t);\n"                                 \
+  "}\n"
+
+/**
+ * Size in bytes of one instance in the given format.
+ */
+GLsizei instance_format_size(enum instance_format format);
+
+/**
+ * Point the attributes starting at location to the bound GL_ARRAY_BUFFER,
+ * tightly packed instances of the given format advancing once per instance.
+ * Returns the number of attribute locations used.
+ */
+GLuint process_instance_attribs(GLuint location, enum instance_format format);
+
+#endif
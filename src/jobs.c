@@ -0,0 +1,123 @@
+// Small fixed thread pool with a blocking parallel-for, shared by the
+// culling and transform code.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "jobs.h"
+
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobs_done = PTHREAD_COND_INITIALIZER;
+
+static pthread_t* workers;
+static int worker_count;
+static bool quitting;
+
+// current batch, guarded by jobs_lock
+static void (*job_fn)(void* arg, size_t index);
+static void* job_arg;
+static size_t job_count, job_next, job_finished;
+static unsigned job_generation;
+
+// run jobs of the current batch until none are left, called with the lock
+static void jobs_drain(void) {
+  while(job_next < job_count) {
+    size_t index = job_next++;
+    pthread_mutex_unlock(&jobs_lock);
+    job_fn(job_arg, index);
+    pthread_mutex_lock(&jobs_lock);
+    if(++job_finished == job_count) {
+      pthread_cond_broadcast(&jobs_done);
+    }
+  }
+}
+
+static void* jobs_worker(void* unused) {
+  (void)unused;
+  unsigned seen = 0;
+
+  pthread_mutex_lock(&jobs_lock);
+  for(;;) {
+    while(!quitting && job_generation == seen) {
+      pthread_cond_wait(&jobs_wake, &jobs_lock);
+    }
+    if(quitting) {
+      break;
+    }
+    seen = job_generation;
+    jobs_drain();
+  }
+  pthread_mutex_unlock(&jobs_lock);
+  return NULL;
+}
+
+void jobs_init(int threads) {
+  if(threads <= 0) {
+    return;
+  }
+  workers = malloc(sizeof(pthread_t) * threads);
+  if(!workers) {
+    fprintf(stderr, "[Error] Could not allocate job threads\n");
+    exit(1);
+  }
+  for(int i = 0; i < threads; i++) {
+    if(pthread_create(&workers[i], NULL, jobs_worker, NULL) != 0) {
+      fprintf(stderr, "[Error] Could not start job thread %d\n", i);
+      exit(1);
+    }
+  }
+  worker_count = threads;
+}
+
+int jobs_default_threads(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return cpus > 1 ? (int)cpus - 1 : 0;
+}
+
+int jobs_thread_count(void) { return worker_count + 1; }
+
+void jobs_run(void (*fn)(void* arg, size_t index), void* arg, size_t count) {
+  if(worker_count == 0 || count <= 1) {
+    for(size_t i = 0; i < count; i++) {
+      fn(arg, i);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&jobs_lock);
+  job_fn = fn;
+  job_arg = arg;
+  job_count = count;
+  job_next = 0;
+  job_finished = 0;
+  job_generation++;
+  pthread_cond_broadcast(&jobs_wake);
+
+  // the caller works too, then waits for jobs still running elsewhere
+  jobs_drain();
+  while(job_finished < job_count) {
+    pthread_cond_wait(&jobs_done, &jobs_lock);
+  }
+  pthread_mutex_unlock(&jobs_lock);
+}
+
+void jobs_shutdown(void) {
+  pthread_mutex_lock(&jobs_lock);
+  quitting = true;
+  pthread_cond_broadcast(&jobs_wake);
+  pthread_mutex_unlock(&jobs_lock);
+
+  for(int i = 0; i < worker_count; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+  workers = NULL;
+  worker_count = 0;
+  quitting = false;
+}
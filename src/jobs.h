@@ -0,0 +1,36 @@
+#include <stddef.h>
+
+#ifndef JOBS_FUNCTIONS
+#define JOBS_FUNCTIONS
+
+/**
+ * Start threads worker threads for jobs_run, 0 runs everything on the calling
+ * thread. Call once, before any jobs_run.
+ */
+void jobs_init(int threads);
+
+/**
+ * Worker count that keeps every online cpu busy: cpus - 1, since the caller
+ * of jobs_run works too.
+ */
+int jobs_default_threads(void);
+
+/**
+ * Number of threads jobs_run spreads work over, including the caller.
+ */
+int jobs_thread_count(void);
+
+/**
+ * Call fn(arg, index) for every index in [0, count), spread over the worker
+ * threads and the calling thread, and return once all calls are done. Not
+ * reentrant: only one thread may run jobs at a time, and jobs must not call
+ * jobs_run themselves.
+ */
+void jobs_run(void (*fn)(void* arg, size_t index), void* arg, size_t count);
+
+/**
+ * Stop and join the worker threads.
+ */
+void jobs_shutdown(void);
+
+#endif
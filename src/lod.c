@@ -0,0 +1,77 @@
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "lod.h"
+
+void lod_init(struct lod* lod, vec4 sphere, GLenum index_type) {
+  lod->levels = 0;
+  lod->index_type = index_type;
+  glm_vec4_copy(sphere, lod->sphere);
+}
+
+void lod_add_level(
+    struct lod* lod, GLsizei first, GLsizei count, float screen_size
+) {
+  if(lod->levels == LOD_MAX_LEVELS) {
+    fprintf(stderr, "[Error] More than %d detail levels\n", LOD_MAX_LEVELS);
+    exit(1);
+  }
+  struct lod_level* level = &lod->level[lod->levels++];
+  level->first = first;
+  level->count = count;
+  level->screen_size = screen_size;
+}
+
+float lod_screen_size(struct lod* lod, mat4 model, mat4 view_proj, mat4 proj) {
+  // glm_sphere_transform keeps the radius, scale it by the largest axis
+  vec4 sphere;
+  glm_sphere_transform(lod->sphere, model, sphere);
+  float scale = glm_max(
+      glm_vec3_norm2(model[0]),
+      glm_max(glm_vec3_norm2(model[1]), glm_vec3_norm2(model[2]))
+  );
+  float radius = glm_sphere_radii(sphere) * sqrtf(scale);
+
+  // clip w is the view depth for perspective projections and 1 for
+  // orthographic ones, either way the projected radius is r * proj[1][1] / w
+  float w = view_proj[0][3] * sphere[0] + view_proj[1][3] * sphere[1] +
+            view_proj[2][3] * sphere[2] + view_proj[3][3];
+  // only a perspective w is a distance to compare against the radius
+  if(proj[2][3] != 0.0f && w <= radius) {
+    return FLT_MAX;
+  }
+  // a radius over the half height of [-1, 1] is a diameter over the height
+  return radius * fabsf(proj[1][1]) / w;
+}
+
+int lod_select(struct lod* lod, int current, float size, float hysteresis) {
+  int level = current < 0 ? 0 : current;
+  if(level >= lod->levels) {
+    level = lod->levels - 1;
+  }
+  while(level + 1 < lod->levels &&
+        size < lod->level[level].screen_size * (1.0f - hysteresis)) {
+    level++;
+  }
+  while(level > 0 &&
+        size > lod->level[level - 1].screen_size * (1.0f + hysteresis)) {
+    level--;
+  }
+  return level;
+}
+
+void lod_draw(struct lod* lod, int level) {
+  size_t index_size =
+      lod->index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  struct lod_level* l = &lod->level[level];
+  glDrawElements(
+      GL_TRIANGLES, l->count, lod->index_type,
+      (void*)((size_t)l->first * index_size)
+  );
+}
@@ -0,0 +1,66 @@
+#include <GL/glew.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef LOD_FUNCTIONS
+#define LOD_FUNCTIONS
+
+#define LOD_MAX_LEVELS 8
+// fraction of a level's threshold an object must move past before switching
+#define LOD_DEFAULT_HYSTERESIS 0.1f
+
+/**
+ * Detail levels of one renderable: index ranges into its element buffer,
+ * finest first. Level i is drawn while the projected bounding sphere is at
+ * least screen_size tall, as a fraction of the viewport height; the
+ * coarsest level's screen_size is never read.
+ */
+struct lod_level {
+  GLsizei first; // first index, in indices
+  GLsizei count;
+  float screen_size;
+};
+
+struct lod {
+  struct lod_level level[LOD_MAX_LEVELS];
+  int levels;
+  GLenum index_type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  vec4 sphere;       // bounds in model space, center and radius
+};
+
+/**
+ * Start a renderable with no levels, bounded by sphere.
+ */
+void lod_init(struct lod* lod, vec4 sphere, GLenum index_type);
+
+/**
+ * Append the next coarser level, count indices starting at first. Exits
+ * when there are already LOD_MAX_LEVELS.
+ */
+void lod_add_level(
+    struct lod* lod, GLsizei first, GLsizei count, float screen_size
+);
+
+/**
+ * Height of the renderable's bounding sphere on screen as a fraction of the
+ * viewport height, model to world by model, world to clip by view_proj.
+ * proj is only read for its vertical scale and kind. Returns FLT_MAX when
+ * a perspective eye is inside the sphere.
+ */
+float lod_screen_size(struct lod* lod, mat4 model, mat4 view_proj, mat4 proj);
+
+/**
+ * Level to draw at size (from lod_screen_size) given the level drawn last
+ * (0 the first time); the renderable needs at least one level. A switch
+ * only happens once size is more than hysteresis (e.g.
+ * LOD_DEFAULT_HYSTERESIS) of a threshold past it, so objects sitting at a
+ * threshold do not pop back and forth.
+ */
+int lod_select(struct lod* lod, int current, float size, float hysteresis);
+
+/**
+ * glDrawElements the level's range from the bound vertex array.
+ */
+void lod_draw(struct lod* lod, int level);
+
+#endif
@@ -0,0 +1,229 @@
+// Runtime half of the mesh path: cache lookup, mmap and upload.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "jobs.h"
+#include "mesh.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+
+void mesh_vertex_layout(struct vertex_layout* layout, vec3 box[2]) {
+  static const struct vertex_attrib attribs[] = {
+      {0, VERTEX_QUANTIZED_UNORM16, offsetof(struct mesh_vertex, position) / 4},
+      {1, VERTEX_OCT_SNORM16, offsetof(struct mesh_vertex, normal) / 4},
+      {2, VERTEX_HALF2, offsetof(struct mesh_vertex, uv) / 4},
+  };
+  vertex_layout_init(layout, attribs, 3);
+  vertex_layout_set_box(layout, box);
+}
+
+static bool mesh_cache_valid(const struct mesh_cache_header* h, size_t size) {
+  size_t index_size =
+      h->index_type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+  if(size < sizeof(*h) || h->magic != MESH_CACHE_MAGIC ||
+     h->version != MESH_CACHE_VERSION ||
+     (h->index_type != GL_UNSIGNED_SHORT &&
+      h->index_type != GL_UNSIGNED_INT) ||
+     h->level_count == 0 || h->level_count > LOD_MAX_LEVELS ||
+     h->vertex_offset < sizeof(*h) || h->index_offset < h->vertex_offset ||
+     h->vertex_offset + h->payload_size > size ||
+     h->index_offset + (uint64_t)h->index_count * index_size >
+         h->vertex_offset + h->payload_size) {
+    return false;
+  }
+  if(h->meshlet_offset < h->vertex_offset + h->payload_size ||
+     h->meshlet_offset + (uint64_t)h->meshlet_count * sizeof(struct meshlet) >
+         size) {
+    return false;
+  }
+  uint64_t buffer_indices = h->payload_size / index_size;
+  for(uint32_t l = 0; l < h->level_count; l++) {
+    if((uint64_t)h->levels[l].first + h->levels[l].count > buffer_indices ||
+       (uint64_t)h->levels[l].meshlet_first + h->levels[l].meshlet_count >
+           h->meshlet_count) {
+      return false;
+    }
+  }
+  const struct meshlet* meshlets =
+      (const void*)((const char*)h + h->meshlet_offset);
+  for(uint32_t m = 0; m < h->meshlet_count; m++) {
+    if((uint64_t)meshlets[m].first + meshlets[m].count > buffer_indices) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// map path and upload it into mesh, false when it is missing or stale
+static bool mesh_load_cache(struct mesh* mesh, const char* path) {
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 ||
+     st.st_size < (off_t)sizeof(struct mesh_cache_header)) {
+    close(fd);
+    return false;
+  }
+  size_t size = (size_t)st.st_size;
+  void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) {
+    return false;
+  }
+  const struct mesh_cache_header* h = map;
+  memcpy(mesh->box, h->box, sizeof(mesh->box));
+  mesh_vertex_layout(&mesh->layout, mesh->box);
+  if(!mesh_cache_valid(h, size) ||
+     h->vertex_stride != (uint32_t)mesh->layout.stride) {
+    munmap(map, size);
+    return false;
+  }
+
+  // the payload already is the buffer, the driver copies straight from the
+  // page cache
+  GLint vao = 0;
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+  glGenVertexArrays(1, &mesh->vao);
+  glBindVertexArray(mesh->vao);
+  glGenBuffers(1, &mesh->buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh->buffer);
+  glBufferData(
+      GL_ARRAY_BUFFER, h->payload_size, (const char*)map + h->vertex_offset,
+      GL_STATIC_DRAW
+  );
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->buffer);
+  process_vertex_layout(&mesh->layout, 0);
+  glBindVertexArray(vao);
+
+  mesh->vertex_count = (GLsizei)h->vertex_count;
+  // header floats are not vec4 aligned
+  vec4 sphere;
+  memcpy(sphere, h->sphere, sizeof(sphere));
+  lod_init(&mesh->lod, sphere, h->index_type);
+  for(uint32_t l = 0; l < h->level_count; l++) {
+    lod_add_level(
+        &mesh->lod, (GLsizei)h->levels[l].first, (GLsizei)h->levels[l].count,
+        h->levels[l].screen_size
+    );
+    mesh->meshlet_levels[l].first = h->levels[l].meshlet_first;
+    mesh->meshlet_levels[l].count = h->levels[l].meshlet_count;
+  }
+  mesh->meshlet_count = h->meshlet_count;
+  mesh->meshlets = malloc(
+      (mesh->meshlet_count ? mesh->meshlet_count : 1) * sizeof(struct meshlet)
+  );
+  if(!mesh->meshlets) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  memcpy(
+      mesh->meshlets, (const char*)map + h->meshlet_offset,
+      mesh->meshlet_count * sizeof(struct meshlet)
+  );
+
+  munmap(map, size);
+  return true;
+}
+
+// path + MESH_CACHE_SUFFIX, freed by the caller
+static char* mesh_cache_path(const char* path) {
+  size_t length = strlen(path);
+  char* cache = malloc(length + sizeof(MESH_CACHE_SUFFIX));
+  if(!cache) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  memcpy(cache, path, length);
+  memcpy(cache + length, MESH_CACHE_SUFFIX, sizeof(MESH_CACHE_SUFFIX));
+  return cache;
+}
+
+// a cache without its source is fine, shipped builds only carry caches
+static bool mesh_cache_fresh(const char* path, const char* cache) {
+  struct stat source_st, cache_st;
+  bool has_source = stat(path, &source_st) == 0;
+  return stat(cache, &cache_st) == 0 &&
+         (!has_source || cache_st.st_mtime >= source_st.st_mtime);
+}
+
+// import path and write its cache, touches no gl state so it can run on any
+// thread
+static bool mesh_build_cache(const char* path, const char* cache) {
+  struct mesh_data data;
+  if(!mesh_import(path, &data)) {
+    return false;
+  }
+  mesh_generate_lods(&data);
+  struct mesh_cache_stats before, after;
+  mesh_optimize(&data, &before, &after);
+  printf(
+      "[Info] Optimized %s: %d levels, %zu -> %zu triangles, "
+      "ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+      path, data.level_count, data.levels[0].count / 3,
+      data.levels[data.level_count - 1].count / 3, before.acmr, after.acmr,
+      before.atvr, after.atvr
+  );
+  bool written = mesh_write_cache(cache, &data);
+  mesh_data_destroy(&data);
+  return written;
+}
+
+static void mesh_build_job(void* arg, size_t index) {
+  const char* path = ((const char* const*)arg)[index];
+  char* cache = mesh_cache_path(path);
+  if(!mesh_cache_fresh(path, cache)) {
+    mesh_build_cache(path, cache);
+  }
+  free(cache);
+}
+
+void mesh_build_caches(const char* const* paths, size_t count) {
+  jobs_run(mesh_build_job, (void*)paths, count);
+}
+
+void mesh_load(struct mesh* mesh, const char* path) {
+  memset(mesh, 0, sizeof(*mesh));
+  char* cache = mesh_cache_path(path);
+  if(!mesh_cache_fresh(path, cache) || !mesh_load_cache(mesh, cache)) {
+    if(!mesh_build_cache(path, cache)) {
+      fprintf(stderr, "[Error] Could not load %s\n", path);
+      exit(1);
+    }
+    if(!mesh_load_cache(mesh, cache)) {
+      fprintf(stderr, "[Error] Could not load %s\n", cache);
+      exit(1);
+    }
+  }
+  free(cache);
+}
+
+void mesh_destroy(struct mesh* mesh) {
+  free(mesh->meshlets);
+  glDeleteBuffers(1, &mesh->buffer);
+  glDeleteVertexArrays(1, &mesh->vao);
+  memset(mesh, 0, sizeof(*mesh));
+}
+
+void mesh_set_uniforms(struct mesh* mesh, GLuint program) {
+  vertex_layout_set_uniforms(&mesh->layout, program);
+}
+
+void mesh_draw(struct mesh* mesh, int level) {
+  glBindVertexArray(mesh->vao);
+  lod_draw(&mesh->lod, level);
+}
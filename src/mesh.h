@@ -0,0 +1,157 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GL/glew.h>
+
+#include "../include/cglm/types.h"
+#include "lod.h"
+#include "meshlet.h"
+#include "vertex_layout.h"
+
+#ifndef MESH_FUNCTIONS
+#define MESH_FUNCTIONS
+
+#define MESH_CACHE_MAGIC 0x3148534du // "MSH1"
+#define MESH_CACHE_VERSION 4
+#define MESH_CACHE_SUFFIX ".cache"
+
+/**
+ * Vertex of imported meshes while they are processed, 8 floats. Caches and
+ * buffers hold them packed by mesh_vertex_layout.
+ */
+struct mesh_vertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+
+/**
+ * Geometry on its way from a source file to a cache file: deduplicated
+ * vertices and an indexed triangle list. The list holds every detail level
+ * back to back, level 0 is the imported one; error is how far a level
+ * strays from it, relative to the bounding radius. mesh_optimize cuts the
+ * levels into meshlets, whose ranges count from the start of indices.
+ */
+struct mesh_data {
+  struct mesh_vertex* vertices;
+  size_t vertex_count, vertex_capacity;
+  uint32_t* indices;
+  size_t index_count, index_capacity;
+  struct {
+    size_t first, count;
+    float error;
+    size_t meshlet_first, meshlet_count;
+  } levels[LOD_MAX_LEVELS];
+  int level_count;
+  struct meshlet* meshlets;
+  size_t meshlet_count;
+};
+
+/**
+ * Packed vertex of the cache and the gpu, 16 bytes: position quantized to
+ * unorm16 in the mesh box at location 0, octahedral normal at 1, half float
+ * uv at 2. Paste MESH_GLSL_ATTRIBS into the vertex shader and set its
+ * uniforms with mesh_set_uniforms.
+ */
+#define MESH_GLSL_ATTRIBS                                                     \
+  "layout (location = 0) in vec4 mesh_position;\n"                            \
+  "layout (location = 1) in vec2 mesh_normal;\n"                              \
+  "layout (location = 2) in vec2 mesh_uv;\n" VERTEX_GLSL_OCT                  \
+      VERTEX_GLSL_DEQUANTIZE
+
+/**
+ * The packed layout, quantizing positions in box.
+ */
+void mesh_vertex_layout(struct vertex_layout* layout, vec3 box[2]);
+
+/**
+ * Start of a cache file. payload_size bytes at vertex_offset follow it: the
+ * vertices, then at index_offset the indices, exactly as the one buffer
+ * object of the mesh holds them. Level and meshlet ranges count indices
+ * from the start of that buffer. The meshlets of every level, each level's
+ * in a row, are at meshlet_offset after the payload.
+ */
+struct mesh_cache_header {
+  uint32_t magic, version;
+  uint32_t vertex_count, index_count;
+  uint32_t index_type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  uint32_t level_count;
+  uint32_t vertex_stride; // of mesh_vertex_layout
+  uint32_t meshlet_count;
+  uint64_t vertex_offset, index_offset, payload_size, meshlet_offset;
+  float sphere[4];
+  float box[2][3];
+  struct {
+    uint32_t first, count;
+    float screen_size;
+    uint32_t meshlet_first, meshlet_count;
+  } levels[LOD_MAX_LEVELS];
+};
+
+/**
+ * A mesh on the gpu: one buffer holding vertices and indices, bound as both
+ * array and element buffer by the vertex array.
+ */
+struct mesh {
+  GLuint vao, buffer;
+  GLsizei vertex_count;
+  struct lod lod; // index ranges of the detail levels and bounding sphere
+  vec3 box[2];
+  struct vertex_layout layout;
+  struct meshlet* meshlets; // of every level, for meshlet_culler
+  size_t meshlet_count;
+  struct {
+    uint32_t first, count;
+  } meshlet_levels[LOD_MAX_LEVELS];
+};
+
+/**
+ * Parse an .obj or .glb file (by extension) into data. Identical vertices
+ * are merged and polygons triangulated; faces without normals get their
+ * flat normal. glTF node transforms are not applied, every triangle
+ * primitive of every mesh lands in data as it is in the buffer. Prints the
+ * problem and returns false on malformed or unsupported files.
+ */
+bool mesh_import(const char* path, struct mesh_data* data);
+
+void mesh_data_destroy(struct mesh_data* data);
+
+/**
+ * Write data as a cache file with its meshlets, vertices packed with
+ * mesh_vertex_layout and 16-bit indices when every index fits.
+ * Each level is switched to the next coarser one once its error falls under
+ * MESH_LOD_PIXEL_ERROR pixels.
+ * Goes through a temporary file, a reader never sees half a cache.
+ */
+bool mesh_write_cache(const char* path, struct mesh_data* data);
+
+/**
+ * Load path into mesh. path + MESH_CACHE_SUFFIX is used when it is newer
+ * than path (or path is gone), otherwise path is imported, run through
+ * mesh_generate_lods and mesh_optimize and the cache rewritten first. The
+ * cache is mmapped and its payload uploaded with a single glBufferData.
+ * Exits when neither can be read.
+ */
+void mesh_load(struct mesh* mesh, const char* path);
+
+/**
+ * Rebuild the stale caches of count source files in parallel on the job
+ * threads, one mesh per job, so a later mesh_load of each only maps its
+ * cache. Missing or broken sources are left for mesh_load to report.
+ */
+void mesh_build_caches(const char* const* paths, size_t count);
+
+void mesh_destroy(struct mesh* mesh);
+
+/**
+ * Set the MESH_GLSL_ATTRIBS uniforms of program, which must be current.
+ */
+void mesh_set_uniforms(struct mesh* mesh, GLuint program);
+
+/**
+ * Bind the mesh's vertex array and draw one of its detail levels.
+ */
+void mesh_draw(struct mesh* mesh, int level);
+
+#endif
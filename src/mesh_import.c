@@ -0,0 +1,838 @@
+// Offline half of the mesh path: .obj and .glb parsing, vertex
+// deduplication and cache file writing.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "mesh.h"
+#include "mesh_simplify.h"
+
+#define GLB_MAGIC 0x46546c67u      // "glTF"
+#define GLB_CHUNK_JSON 0x4e4f534au // "JSON"
+#define GLB_CHUNK_BIN 0x004e4942u  // "BIN\0"
+
+static void* mesh_grow(void* p, size_t* capacity, size_t needed, size_t size) {
+  if(needed <= *capacity) {
+    return p;
+  }
+  size_t capacity2 = *capacity ? *capacity : 64;
+  while(capacity2 < needed) {
+    capacity2 *= 2;
+  }
+  p = realloc(p, capacity2 * size);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  *capacity = capacity2;
+  return p;
+}
+
+static char* mesh_read_file(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  if(!file) {
+    fprintf(stderr, "[Error] Could not open %s\n", path);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long len = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  // zero terminated so the text parsers can run off the end safely
+  char* buffer = len >= 0 ? malloc(len + 1) : NULL;
+  if(!buffer || fread(buffer, 1, len, file) != (size_t)len) {
+    fprintf(stderr, "[Error] Could not read %s\n", path);
+    free(buffer);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  buffer[len] = '\0';
+  *size = (size_t)len;
+  return buffer;
+}
+
+// vertex deduplication, open addressing over indices into data->vertices
+struct mesh_dedup {
+  uint32_t* slots; // vertex index + 1, 0 is empty
+  size_t mask;
+};
+
+static uint32_t mesh_vertex_hash(const struct mesh_vertex* v) {
+  const unsigned char* p = (const unsigned char*)v;
+  uint32_t h = 2166136261u;
+  for(size_t i = 0; i < sizeof(*v); i++) {
+    h = (h ^ p[i]) * 16777619u;
+  }
+  return h;
+}
+
+static void mesh_dedup_insert(
+    struct mesh_dedup* dedup, struct mesh_data* data, uint32_t index
+) {
+  size_t slot = mesh_vertex_hash(&data->vertices[index]) & dedup->mask;
+  while(dedup->slots[slot]) {
+    slot = (slot + 1) & dedup->mask;
+  }
+  dedup->slots[slot] = index + 1;
+}
+
+static uint32_t mesh_dedup_add(
+    struct mesh_dedup* dedup, struct mesh_data* data,
+    const struct mesh_vertex* v
+) {
+  // keep the table at most half full
+  if(2 * (data->vertex_count + 1) > dedup->mask + 1) {
+    size_t size = dedup->mask ? 2 * (dedup->mask + 1) : 1024;
+    free(dedup->slots);
+    dedup->slots = calloc(size, sizeof(uint32_t));
+    if(!dedup->slots) {
+      fprintf(stderr, "[Error] Could not allocate mesh data\n");
+      exit(1);
+    }
+    dedup->mask = size - 1;
+    for(size_t i = 0; i < data->vertex_count; i++) {
+      mesh_dedup_insert(dedup, data, (uint32_t)i);
+    }
+  }
+
+  size_t slot = mesh_vertex_hash(v) & dedup->mask;
+  while(dedup->slots[slot]) {
+    uint32_t index = dedup->slots[slot] - 1;
+    if(!memcmp(&data->vertices[index], v, sizeof(*v))) {
+      return index;
+    }
+    slot = (slot + 1) & dedup->mask;
+  }
+
+  data->vertices = mesh_grow(
+      data->vertices, &data->vertex_capacity, data->vertex_count + 1,
+      sizeof(*v)
+  );
+  uint32_t index = (uint32_t)data->vertex_count++;
+  data->vertices[index] = *v;
+  dedup->slots[slot] = index + 1;
+  return index;
+}
+
+static void mesh_add_triangle(
+    struct mesh_dedup* dedup, struct mesh_data* data, struct mesh_vertex v[3],
+    bool has_normals
+) {
+  if(!has_normals) {
+    vec3 e1, e2, n;
+    glm_vec3_sub(v[1].position, v[0].position, e1);
+    glm_vec3_sub(v[2].position, v[0].position, e2);
+    glm_vec3_crossn(e1, e2, n);
+    for(int c = 0; c < 3; c++) {
+      glm_vec3_copy(n, v[c].normal);
+    }
+  }
+  data->indices = mesh_grow(
+      data->indices, &data->index_capacity, data->index_count + 3,
+      sizeof(uint32_t)
+  );
+  for(int c = 0; c < 3; c++) {
+    data->indices[data->index_count++] = mesh_dedup_add(dedup, data, &v[c]);
+  }
+}
+
+// obj
+
+struct obj_attribs {
+  float* values;
+  size_t count, capacity; // in floats
+};
+
+static void obj_push(struct obj_attribs* a, const char* p, int n) {
+  a->values = mesh_grow(a->values, &a->capacity, a->count + n, sizeof(float));
+  for(int i = 0; i < n; i++) {
+    char* end;
+    a->values[a->count + i] = strtof(p, &end);
+    p = end;
+  }
+  a->count += n;
+}
+
+// 1-based or negative (relative) obj index to 0-based, -1 when absent or
+// out of range
+static long obj_index(long index, size_t count) {
+  if(index < 0) {
+    index += (long)count;
+  } else {
+    index -= 1;
+  }
+  return index >= 0 && (size_t)index < count ? index : -1;
+}
+
+static bool obj_import(
+    const char* path, char* text, struct mesh_data* data,
+    struct mesh_dedup* dedup
+) {
+  struct obj_attribs v = {0}, vt = {0}, vn = {0};
+  struct mesh_vertex face[3];
+  bool ok = true;
+  size_t line = 0;
+
+  for(char* p = text; *p && ok; line++) {
+    char* end = p + strcspn(p, "\n");
+    char* next = *end ? end + 1 : end;
+    *end = '\0';
+    p += strspn(p, " \t");
+
+    if(!strncmp(p, "v ", 2)) {
+      obj_push(&v, p + 2, 3);
+    } else if(!strncmp(p, "vt ", 3)) {
+      obj_push(&vt, p + 3, 2);
+    } else if(!strncmp(p, "vn ", 3)) {
+      obj_push(&vn, p + 3, 3);
+    } else if(!strncmp(p, "f ", 2)) {
+      // corners are v, v/vt, v//vn or v/vt/vn; polygons become fans
+      int corners = 0;
+      bool has_normals = true;
+      char* q = p + 2;
+      while(ok) {
+        q += strspn(q, " \t\r");
+        if(!*q) {
+          break;
+        }
+        long iv = obj_index(strtol(q, &q, 10), v.count / 3), ivt = -1;
+        long ivn = -1;
+        if(*q == '/') {
+          if(q[1] != '/') {
+            ivt = obj_index(strtol(q + 1, &q, 10), vt.count / 2);
+          } else {
+            q++;
+          }
+          if(*q == '/') {
+            ivn = obj_index(strtol(q + 1, &q, 10), vn.count / 3);
+          }
+        }
+        if(iv < 0) {
+          fprintf(stderr, "[Error] %s:%zu: bad face index\n", path, line + 1);
+          ok = false;
+          break;
+        }
+
+        struct mesh_vertex* c = &face[corners < 3 ? corners : 2];
+        memset(c, 0, sizeof(*c));
+        memcpy(c->position, v.values + iv * 3, 3 * sizeof(float));
+        if(ivt >= 0) {
+          memcpy(c->uv, vt.values + ivt * 2, 2 * sizeof(float));
+        }
+        if(ivn >= 0) {
+          memcpy(c->normal, vn.values + ivn * 3, 3 * sizeof(float));
+        }
+        has_normals = has_normals && ivn >= 0;
+        if(++corners >= 3) {
+          struct mesh_vertex tri[3] = {face[0], face[1], face[2]};
+          mesh_add_triangle(dedup, data, tri, has_normals);
+          face[1] = face[2];
+        }
+      }
+    }
+    p = next;
+  }
+
+  free(v.values);
+  free(vt.values);
+  free(vn.values);
+  return ok;
+}
+
+// glb: a minimal json tokenizer, enough for the gltf document
+
+enum json_type { JSON_OBJECT, JSON_ARRAY, JSON_STRING, JSON_PRIMITIVE };
+
+struct json_token {
+  enum json_type type;
+  size_t start, end; // text range, strings without the quotes
+  size_t size;       // members of an object, elements of an array
+  size_t next;       // token after this one's subtree
+};
+
+struct json {
+  const char* text;
+  size_t length, pos;
+  struct json_token* tokens;
+  size_t count, capacity;
+};
+
+static void json_space(struct json* json) {
+  while(json->pos < json->length &&
+        strchr(" \t\r\n", json->text[json->pos])) {
+    json->pos++;
+  }
+}
+
+static bool json_value(struct json* json, int depth) {
+  json_space(json);
+  if(json->pos >= json->length || depth > 64) {
+    return false;
+  }
+  json->tokens = mesh_grow(
+      json->tokens, &json->capacity, json->count + 1, sizeof(*json->tokens)
+  );
+  size_t index = json->count++;
+  struct json_token token = {JSON_PRIMITIVE, json->pos, json->pos, 0, 0};
+  char c = json->text[json->pos];
+
+  if(c == '{' || c == '[') {
+    token.type = c == '{' ? JSON_OBJECT : JSON_ARRAY;
+    char close = c == '{' ? '}' : ']';
+    json->pos++;
+    json_space(json);
+    while(json->pos < json->length && json->text[json->pos] != close) {
+      if(token.size > 0) {
+        if(json->text[json->pos] != ',') {
+          return false;
+        }
+        json->pos++;
+      }
+      if(token.type == JSON_OBJECT) {
+        // keys are string tokens followed by their value's subtree
+        json_space(json);
+        if(json->pos >= json->length || json->text[json->pos] != '"' ||
+           !json_value(json, depth + 1)) {
+          return false;
+        }
+        json_space(json);
+        if(json->pos >= json->length || json->text[json->pos] != ':') {
+          return false;
+        }
+        json->pos++;
+      }
+      if(!json_value(json, depth + 1)) {
+        return false;
+      }
+      token.size++;
+      json_space(json);
+    }
+    if(json->pos >= json->length) {
+      return false;
+    }
+    json->pos++;
+  } else if(c == '"') {
+    token.type = JSON_STRING;
+    token.start = ++json->pos;
+    while(json->pos < json->length && json->text[json->pos] != '"') {
+      json->pos += json->text[json->pos] == '\\' ? 2 : 1;
+    }
+    if(json->pos >= json->length) {
+      return false;
+    }
+    token.end = json->pos++;
+  } else {
+    while(json->pos < json->length &&
+          !strchr(",]} \t\r\n", json->text[json->pos])) {
+      json->pos++;
+    }
+    token.end = json->pos;
+  }
+  token.next = json->count;
+  json->tokens[index] = token;
+  return true;
+}
+
+// token 0 is a placeholder primitive and the document starts at 1, so 0
+// can stand for a missing value and every lookup on it fails
+
+// value of key in object, 0 when missing
+static size_t json_key(struct json* json, size_t object, const char* key) {
+  struct json_token* o = &json->tokens[object];
+  if(o->type != JSON_OBJECT) {
+    return 0;
+  }
+  size_t length = strlen(key);
+  for(size_t i = object + 1, n = 0; n < o->size; n++) {
+    struct json_token* k = &json->tokens[i];
+    size_t value = i + 1;
+    if(k->end - k->start == length &&
+       !memcmp(json->text + k->start, key, length)) {
+      return value;
+    }
+    i = json->tokens[value].next;
+  }
+  return 0;
+}
+
+// element n of array, 0 when out of range
+static size_t json_at(struct json* json, size_t array, size_t n) {
+  struct json_token* a = &json->tokens[array];
+  if(a->type != JSON_ARRAY || n >= a->size) {
+    return 0;
+  }
+  size_t i = array + 1;
+  while(n--) {
+    i = json->tokens[i].next;
+  }
+  return i;
+}
+
+static double json_number(struct json* json, size_t token, double fallback) {
+  if(token == 0 || json->tokens[token].type != JSON_PRIMITIVE) {
+    return fallback;
+  }
+  return strtod(json->text + json->tokens[token].start, NULL);
+}
+
+// a json number used as a size or index: false unless it is neither
+// negative nor past limit (which also rules out NaN), so the cast is safe
+static bool json_size(
+    struct json* json, size_t token, size_t fallback, size_t limit, size_t* n
+) {
+  double d = json_number(json, token, (double)fallback);
+  if(!(d >= 0.0 && d <= (double)limit)) {
+    return false;
+  }
+  *n = (size_t)d;
+  return true;
+}
+
+static bool json_equals(struct json* json, size_t token, const char* s) {
+  struct json_token* t = &json->tokens[token];
+  return token != 0 && t->end - t->start == strlen(s) &&
+         !memcmp(json->text + t->start, s, t->end - t->start);
+}
+
+// a resolved gltf accessor: count elements of components values each
+struct gltf_accessor {
+  const unsigned char* data;
+  size_t count, stride;
+  int components;
+  GLenum component_type;
+  bool normalized;
+};
+
+static int gltf_components(struct json* json, size_t type) {
+  static const char* const names[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+  for(int i = 0; i < 4; i++) {
+    if(json_equals(json, type, names[i])) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+static size_t gltf_component_size(GLenum type) {
+  switch(type) {
+  case GL_BYTE:
+  case GL_UNSIGNED_BYTE:
+    return 1;
+  case GL_SHORT:
+  case GL_UNSIGNED_SHORT:
+    return 2;
+  case GL_UNSIGNED_INT:
+  case GL_FLOAT:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+// the accessor whose index is the number at json token token
+static bool gltf_accessor(
+    struct json* json, size_t root, size_t token, const unsigned char* bin,
+    size_t bin_size, struct gltf_accessor* a
+) {
+  // token indices bound every array index
+  size_t accessor_index, view_index;
+  if(!json_size(json, token, 0, json->count, &accessor_index)) {
+    return false;
+  }
+  size_t accessor =
+      json_at(json, json_key(json, root, "accessors"), accessor_index);
+  if(!accessor ||
+     !json_size(
+         json, json_key(json, accessor, "bufferView"), json->count,
+         json->count, &view_index
+     )) {
+    return false;
+  }
+  size_t view = json_at(json, json_key(json, root, "bufferViews"), view_index);
+  if(!view || json_key(json, accessor, "sparse") ||
+     json_number(json, json_key(json, view, "buffer"), 0) != 0) {
+    return false;
+  }
+  // GL_FLOAT is the largest component type
+  size_t component_type, view_offset, accessor_offset;
+  if(!json_size(
+         json, json_key(json, accessor, "componentType"), 0, GL_FLOAT,
+         &component_type
+     )) {
+    return false;
+  }
+  a->component_type = (GLenum)component_type;
+  a->components = gltf_components(json, json_key(json, accessor, "type"));
+  a->normalized = json_equals(
+      json, json_key(json, accessor, "normalized"), "true"
+  );
+  size_t size = gltf_component_size(a->component_type) * a->components;
+  // every size and offset fits in bin_size, so none of the sums below wrap
+  if(!json_size(
+         json, json_key(json, accessor, "count"), 0, bin_size, &a->count
+     ) ||
+     !json_size(
+         json, json_key(json, view, "byteStride"), size, bin_size, &a->stride
+     ) ||
+     !json_size(
+         json, json_key(json, view, "byteOffset"), 0, bin_size, &view_offset
+     ) ||
+     !json_size(
+         json, json_key(json, accessor, "byteOffset"), 0, bin_size,
+         &accessor_offset
+     )) {
+    return false;
+  }
+  size_t offset = view_offset + accessor_offset;
+  if(size == 0 || a->stride < size || offset > bin_size ||
+     (a->count && (size > bin_size - offset ||
+                   a->count - 1 > (bin_size - offset - size) / a->stride))) {
+    return false;
+  }
+  a->data = bin + offset;
+  return true;
+}
+
+// component c of element i as float, normalized integers mapped to [0, 1]
+// or [-1, 1]
+static float gltf_read(struct gltf_accessor* a, size_t i, int c) {
+  const unsigned char* p =
+      a->data + i * a->stride + c * gltf_component_size(a->component_type);
+  switch(a->component_type) {
+  case GL_FLOAT: {
+    float f;
+    memcpy(&f, p, sizeof(f));
+    return f;
+  }
+  case GL_UNSIGNED_BYTE:
+    return a->normalized ? *p / 255.0f : *p;
+  case GL_BYTE:
+    return a->normalized ? glm_max(*(const int8_t*)p / 127.0f, -1.0f)
+                         : *(const int8_t*)p;
+  case GL_UNSIGNED_SHORT: {
+    uint16_t s;
+    memcpy(&s, p, sizeof(s));
+    return a->normalized ? s / 65535.0f : s;
+  }
+  case GL_SHORT: {
+    int16_t s;
+    memcpy(&s, p, sizeof(s));
+    return a->normalized ? glm_max(s / 32767.0f, -1.0f) : s;
+  }
+  case GL_UNSIGNED_INT: {
+    uint32_t u;
+    memcpy(&u, p, sizeof(u));
+    return (float)u;
+  }
+  default:
+    return 0.0f;
+  }
+}
+
+static uint32_t gltf_read_index(struct gltf_accessor* a, size_t i) {
+  const unsigned char* p = a->data + i * a->stride;
+  uint16_t s;
+  uint32_t u;
+  switch(a->component_type) {
+  case GL_UNSIGNED_BYTE:
+    return *p;
+  case GL_UNSIGNED_SHORT:
+    memcpy(&s, p, sizeof(s));
+    return s;
+  default:
+    memcpy(&u, p, sizeof(u));
+    return u;
+  }
+}
+
+static bool gltf_primitive(
+    struct json* json, size_t root, size_t primitive, const unsigned char* bin,
+    size_t bin_size, struct mesh_data* data, struct mesh_dedup* dedup
+) {
+  // only triangle lists, points and lines have nothing to draw here
+  if(json_number(json, json_key(json, primitive, "mode"), 4) != 4) {
+    return true;
+  }
+  size_t attributes = json_key(json, primitive, "attributes");
+  size_t position = json_key(json, attributes, "POSITION");
+  size_t normal = json_key(json, attributes, "NORMAL");
+  size_t uv = json_key(json, attributes, "TEXCOORD_0");
+  size_t indices = json_key(json, primitive, "indices");
+
+  struct gltf_accessor p, n = {0}, t = {0}, idx = {0};
+  if(!position ||
+     !gltf_accessor(json, root, position, bin, bin_size, &p) ||
+     p.components != 3 ||
+     (normal &&
+      (!gltf_accessor(json, root, normal, bin, bin_size, &n) ||
+       n.components != 3 || n.count != p.count)) ||
+     (uv && (!gltf_accessor(json, root, uv, bin, bin_size, &t) ||
+             t.components != 2 || t.count != p.count)) ||
+     (indices &&
+      (!gltf_accessor(json, root, indices, bin, bin_size, &idx) ||
+       idx.components != 1))) {
+    return false;
+  }
+
+  size_t count = indices ? idx.count : p.count;
+  for(size_t i = 0; i + 3 <= count; i += 3) {
+    struct mesh_vertex tri[3];
+    for(int c = 0; c < 3; c++) {
+      size_t v = indices ? gltf_read_index(&idx, i + c) : i + c;
+      if(v >= p.count) {
+        return false;
+      }
+      memset(&tri[c], 0, sizeof(tri[c]));
+      for(int k = 0; k < 3; k++) {
+        tri[c].position[k] = gltf_read(&p, v, k);
+        tri[c].normal[k] = normal ? gltf_read(&n, v, k) : 0.0f;
+      }
+      for(int k = 0; k < 2 && uv; k++) {
+        tri[c].uv[k] = gltf_read(&t, v, k);
+      }
+    }
+    mesh_add_triangle(dedup, data, tri, normal != 0);
+  }
+  return true;
+}
+
+static uint32_t glb_u32(const unsigned char* p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static bool glb_import(
+    const char* path, const unsigned char* file, size_t size,
+    struct mesh_data* data, struct mesh_dedup* dedup
+) {
+  // 12 byte header, then a JSON chunk and an optional BIN chunk
+  if(size < 20 || glb_u32(file) != GLB_MAGIC || glb_u32(file + 4) != 2 ||
+     glb_u32(file + 8) > size || glb_u32(file + 16) != GLB_CHUNK_JSON ||
+     glb_u32(file + 12) > size - 20) {
+    fprintf(stderr, "[Error] %s is not a glTF 2.0 binary\n", path);
+    return false;
+  }
+  size_t json_size = glb_u32(file + 12);
+  const unsigned char* bin = NULL;
+  size_t bin_size = 0, bin_chunk = 20 + json_size;
+  if(bin_chunk + 8 <= size && glb_u32(file + bin_chunk + 4) == GLB_CHUNK_BIN) {
+    bin = file + bin_chunk + 8;
+    bin_size = glb_u32(file + bin_chunk);
+    if(bin_size > size - bin_chunk - 8) {
+      bin_size = 0;
+    }
+  }
+
+  struct json json = {(const char*)file + 20, json_size, 0, NULL, 1, 0};
+  json.tokens = mesh_grow(NULL, &json.capacity, 64, sizeof(*json.tokens));
+  json.tokens[0] = (struct json_token){JSON_PRIMITIVE, 0, 0, 0, 1};
+  bool ok = json_value(&json, 0) && json.tokens[1].type == JSON_OBJECT;
+  size_t meshes = ok ? json_key(&json, 1, "meshes") : 0;
+  for(size_t m = 0; ok && json_at(&json, meshes, m); m++) {
+    size_t mesh = json_at(&json, meshes, m);
+    size_t primitives = json_key(&json, mesh, "primitives");
+    for(size_t i = 0; ok && json_at(&json, primitives, i); i++) {
+      ok = gltf_primitive(
+          &json, 1, json_at(&json, primitives, i), bin, bin_size, data, dedup
+      );
+    }
+  }
+  if(!ok) {
+    fprintf(stderr, "[Error] %s has malformed or unsupported glTF\n", path);
+  }
+  free(json.tokens);
+  return ok;
+}
+
+bool mesh_import(const char* path, struct mesh_data* data) {
+  memset(data, 0, sizeof(*data));
+  size_t size;
+  char* file = mesh_read_file(path, &size);
+  if(!file) {
+    return false;
+  }
+
+  struct mesh_dedup dedup = {0};
+  const char* ext = strrchr(path, '.');
+  bool ok;
+  if(ext && !strcmp(ext, ".obj")) {
+    ok = obj_import(path, file, data, &dedup);
+  } else if(ext && !strcmp(ext, ".glb")) {
+    ok = glb_import(path, (unsigned char*)file, size, data, &dedup);
+  } else {
+    fprintf(stderr, "[Error] %s is neither .obj nor .glb\n", path);
+    ok = false;
+  }
+  free(dedup.slots);
+  free(file);
+  if(ok && data->index_count == 0) {
+    fprintf(stderr, "[Error] %s has no triangles\n", path);
+    ok = false;
+  }
+  if(!ok) {
+    mesh_data_destroy(data);
+    return false;
+  }
+  data->levels[0].count = data->index_count;
+  data->level_count = 1;
+  return true;
+}
+
+void mesh_data_destroy(struct mesh_data* data) {
+  free(data->meshlets);
+  free(data->vertices);
+  free(data->indices);
+  memset(data, 0, sizeof(*data));
+}
+
+static void mesh_bounds(struct mesh_data* data, struct mesh_cache_header* h) {
+  vec3 box[2] = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+  for(size_t i = 0; i < data->vertex_count; i++) {
+    glm_vec3_minv(box[0], data->vertices[i].position, box[0]);
+    glm_vec3_maxv(box[1], data->vertices[i].position, box[1]);
+  }
+  // centered on the box, wide enough for the farthest vertex
+  vec3 center;
+  glm_vec3_center(box[0], box[1], center);
+  float radius2 = 0.0f;
+  for(size_t i = 0; i < data->vertex_count; i++) {
+    float d2 = glm_vec3_distance2(center, data->vertices[i].position);
+    radius2 = glm_max(radius2, d2);
+  }
+  memcpy(h->box, box, sizeof(box));
+  vec4 sphere;
+  glm_vec4(center, sqrtf(radius2), sphere);
+  memcpy(h->sphere, sphere, sizeof(sphere));
+}
+
+bool mesh_write_cache(const char* path, struct mesh_data* data) {
+  struct mesh_cache_header h;
+  memset(&h, 0, sizeof(h));
+  h.magic = MESH_CACHE_MAGIC;
+  h.version = MESH_CACHE_VERSION;
+  h.vertex_count = (uint32_t)data->vertex_count;
+  h.index_count = (uint32_t)data->index_count;
+  bool short_indices = data->vertex_count <= 65536;
+  h.index_type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  size_t index_size = short_indices ? sizeof(uint16_t) : sizeof(uint32_t);
+
+  // vertices go in packed, positions quantized in the mesh box
+  mesh_bounds(data, &h);
+  struct vertex_layout layout;
+  mesh_vertex_layout(&layout, h.box);
+  h.vertex_stride = (uint32_t)layout.stride;
+  uint64_t vertex_size = data->vertex_count * layout.stride;
+  void* vertices = malloc(vertex_size ? vertex_size : 1);
+  if(!vertices) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  vertex_layout_pack(
+      &layout, data->vertices[0].position,
+      sizeof(struct mesh_vertex) / sizeof(float), data->vertex_count,
+      vertices
+  );
+
+  // vertices start 16 byte aligned in the file, indices 4 byte aligned in
+  // the buffer so level ranges can count indices from its start
+  h.vertex_offset = (sizeof(h) + 15) & ~(uint64_t)15;
+  h.index_offset = h.vertex_offset + ((vertex_size + 3) & ~(uint64_t)3);
+  h.payload_size =
+      h.index_offset - h.vertex_offset + data->index_count * index_size;
+  uint32_t base = (uint32_t)((h.index_offset - h.vertex_offset) / index_size);
+  h.level_count = (uint32_t)data->level_count;
+  for(int l = 0; l < data->level_count; l++) {
+    h.levels[l].first = base + (uint32_t)data->levels[l].first;
+    h.levels[l].count = (uint32_t)data->levels[l].count;
+    // the world space error of the next level, in pixels at distance d, is
+    // error * radius * height / (2 * d * tan(fov / 2)); its screen size
+    // 2 * radius / (2 * d * tan(fov / 2)) is where that hits the limit
+    if(l + 1 == data->level_count) {
+      h.levels[l].screen_size = 0.0f;
+    } else if(data->levels[l + 1].error > 0.0f) {
+      h.levels[l].screen_size =
+          2.0f * MESH_LOD_PIXEL_ERROR /
+          (data->levels[l + 1].error * MESH_LOD_REFERENCE_HEIGHT);
+    } else {
+      h.levels[l].screen_size = FLT_MAX;
+    }
+  }
+
+  // meshlets come after the payload, they stay on the cpu or go to their
+  // own buffer
+  h.meshlet_count = (uint32_t)data->meshlet_count;
+  for(int l = 0; l < data->level_count; l++) {
+    h.levels[l].meshlet_first = (uint32_t)data->levels[l].meshlet_first;
+    h.levels[l].meshlet_count = (uint32_t)data->levels[l].meshlet_count;
+  }
+  struct meshlet* meshlets = malloc(
+      (data->meshlet_count ? data->meshlet_count : 1) * sizeof(*meshlets)
+  );
+  if(!meshlets) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  for(size_t m = 0; m < data->meshlet_count; m++) {
+    meshlets[m] = data->meshlets[m];
+    meshlets[m].first += base;
+  }
+  uint64_t meshlet_size = h.meshlet_count * sizeof(*meshlets);
+  h.meshlet_offset = (h.vertex_offset + h.payload_size + 15) & ~(uint64_t)15;
+
+  size_t length = strlen(path);
+  char* temp = malloc(length + 5);
+  if(!temp) {
+    fprintf(stderr, "[Error] Could not allocate mesh data\n");
+    exit(1);
+  }
+  memcpy(temp, path, length);
+  memcpy(temp + length, ".tmp", 5);
+
+  FILE* file = fopen(temp, "wb");
+  if(!file) {
+    fprintf(stderr, "[Error] Could not create %s\n", temp);
+    free(temp);
+    free(meshlets);
+    free(vertices);
+    return false;
+  }
+  static const char zeros[16];
+  bool ok = fwrite(&h, sizeof(h), 1, file) == 1 &&
+            fwrite(zeros, 1, h.vertex_offset - sizeof(h), file) ==
+                h.vertex_offset - sizeof(h) &&
+            fwrite(vertices, 1, vertex_size, file) == vertex_size &&
+            fwrite(
+                zeros, 1, h.index_offset - h.vertex_offset - vertex_size, file
+            ) == h.index_offset - h.vertex_offset - vertex_size;
+  if(short_indices) {
+    for(size_t i = 0; ok && i < data->index_count; i++) {
+      uint16_t index = (uint16_t)data->indices[i];
+      ok = fwrite(&index, sizeof(index), 1, file) == 1;
+    }
+  } else if(ok) {
+    ok = fwrite(data->indices, index_size, data->index_count, file) ==
+         data->index_count;
+  }
+  uint64_t padding = h.meshlet_offset - h.vertex_offset - h.payload_size;
+  ok = ok && fwrite(zeros, 1, padding, file) == padding &&
+       fwrite(meshlets, 1, meshlet_size, file) == meshlet_size;
+  ok = fclose(file) == 0 && ok;
+  if(ok && rename(temp, path) != 0) {
+    ok = false;
+  }
+  if(!ok) {
+    fprintf(stderr, "[Error] Could not write %s\n", path);
+    remove(temp);
+  }
+  free(temp);
+  free(meshlets);
+  free(vertices);
+  return ok;
+}
@@ -0,0 +1,463 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "mesh_optimize.h"
+
+// Forsyth's scoring constants, from "Linear-Speed Vertex Cache
+// Optimisation"
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_SCALE 2.0f
+#define FORSYTH_VALENCE_POWER 0.5f
+#define FORSYTH_MAX_VALENCE 32
+
+static void* mesh_optimize_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate mesh optimizer buffers\n");
+    exit(1);
+  }
+  return p;
+}
+
+struct mesh_cache_stats mesh_analyze_vertex_cache(
+    const uint32_t* indices, size_t index_count, size_t vertex_count,
+    int cache_size
+) {
+  struct mesh_cache_stats stats = {0.0f, 0.0f};
+  // a vertex is cached while fewer than cache_size misses came after its own
+  uint32_t* time = mesh_optimize_alloc(vertex_count * sizeof(uint32_t));
+  memset(time, 0, vertex_count * sizeof(uint32_t));
+  uint32_t now = (uint32_t)cache_size + 1;
+  size_t misses = 0, referenced = 0;
+
+  for(size_t i = 0; i < index_count; i++) {
+    uint32_t v = indices[i];
+    if(time[v] == 0) {
+      referenced++;
+    }
+    if(now - time[v] > (uint32_t)cache_size) {
+      time[v] = now++;
+      misses++;
+    }
+  }
+  free(time);
+
+  if(index_count >= 3) {
+    stats.acmr = (float)misses / (float)(index_count / 3);
+  }
+  if(referenced > 0) {
+    stats.atvr = (float)misses / (float)referenced;
+  }
+  return stats;
+}
+
+static float forsyth_score(
+    const float* cache_scores, const float* valence_scores, int position,
+    uint32_t live
+) {
+  if(live == 0) {
+    return -1.0f;
+  }
+  float score = position >= 0 ? cache_scores[position] : 0.0f;
+  return score + (live < FORSYTH_MAX_VALENCE
+                      ? valence_scores[live]
+                      : FORSYTH_VALENCE_SCALE *
+                            powf((float)live, -FORSYTH_VALENCE_POWER));
+}
+
+void mesh_optimize_vertex_cache(
+    uint32_t* indices, size_t index_count, size_t vertex_count
+) {
+  size_t triangle_count = index_count / 3;
+  if(triangle_count == 0) {
+    return;
+  }
+
+  float cache_scores[FORSYTH_CACHE_SIZE];
+  float valence_scores[FORSYTH_MAX_VALENCE];
+  for(int i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+    // the last triangle's vertices score flat so its neighbours win by
+    // valence, older entries decay towards eviction
+    cache_scores[i] =
+        i < 3 ? FORSYTH_LAST_TRIANGLE_SCORE
+              : powf(
+                    1.0f - (i - 3) / (float)(FORSYTH_CACHE_SIZE - 3),
+                    FORSYTH_DECAY_POWER
+                );
+  }
+  valence_scores[0] = 0.0f;
+  for(int i = 1; i < FORSYTH_MAX_VALENCE; i++) {
+    valence_scores[i] =
+        FORSYTH_VALENCE_SCALE * powf((float)i, -FORSYTH_VALENCE_POWER);
+  }
+
+  // triangles around each vertex; live[v] of them are not emitted yet and
+  // sit at the front of the vertex's range
+  uint32_t* live = mesh_optimize_alloc(vertex_count * sizeof(uint32_t));
+  uint32_t* offsets =
+      mesh_optimize_alloc((vertex_count + 1) * sizeof(uint32_t));
+  uint32_t* adjacency = mesh_optimize_alloc(index_count * sizeof(uint32_t));
+  memset(live, 0, vertex_count * sizeof(uint32_t));
+  for(size_t i = 0; i < triangle_count * 3; i++) {
+    live[indices[i]]++;
+  }
+  offsets[0] = 0;
+  for(size_t v = 0; v < vertex_count; v++) {
+    offsets[v + 1] = offsets[v] + live[v];
+    live[v] = 0;
+  }
+  for(size_t i = 0; i < triangle_count * 3; i++) {
+    uint32_t v = indices[i];
+    adjacency[offsets[v] + live[v]++] = (uint32_t)(i / 3);
+  }
+
+  int* position = mesh_optimize_alloc(vertex_count * sizeof(int));
+  float* vertex_score = mesh_optimize_alloc(vertex_count * sizeof(float));
+  bool* emitted = mesh_optimize_alloc(triangle_count * sizeof(bool));
+  uint32_t* output = mesh_optimize_alloc(triangle_count * 3 * sizeof(uint32_t));
+  for(size_t v = 0; v < vertex_count; v++) {
+    position[v] = -1;
+    vertex_score[v] = forsyth_score(cache_scores, valence_scores, -1, live[v]);
+  }
+  memset(emitted, 0, triangle_count * sizeof(bool));
+
+  uint32_t cache[FORSYTH_CACHE_SIZE + 3], next_cache[FORSYTH_CACHE_SIZE + 3];
+  int cache_count = 0;
+  size_t cursor = 0;
+  long best = -1;
+
+  for(size_t out = 0; out < triangle_count; out++) {
+    // nothing in the cache has triangles left, start over at the next one
+    // in input order
+    if(best < 0) {
+      while(emitted[cursor]) {
+        cursor++;
+      }
+      best = (long)cursor;
+    }
+    const uint32_t* tri = indices + best * 3;
+    memcpy(output + out * 3, tri, 3 * sizeof(uint32_t));
+    emitted[best] = true;
+
+    int next_count = 0;
+    for(int c = 0; c < 3; c++) {
+      uint32_t v = tri[c];
+      uint32_t* begin = adjacency + offsets[v];
+      for(uint32_t k = 0; k < live[v]; k++) {
+        if(begin[k] == (uint32_t)best) {
+          begin[k] = begin[--live[v]];
+          begin[live[v]] = (uint32_t)best;
+          break;
+        }
+      }
+      bool cached = false;
+      for(int i = 0; i < next_count; i++) {
+        cached = cached || next_cache[i] == v;
+      }
+      if(!cached) {
+        next_cache[next_count++] = v;
+      }
+    }
+    for(int i = 0; i < cache_count; i++) {
+      uint32_t v = cache[i];
+      if(v != tri[0] && v != tri[1] && v != tri[2]) {
+        next_cache[next_count++] = v;
+      }
+    }
+
+    // entries past the cache size were evicted, score them as uncached
+    for(int i = 0; i < next_count; i++) {
+      uint32_t v = next_cache[i];
+      position[v] = i < FORSYTH_CACHE_SIZE ? i : -1;
+      vertex_score[v] =
+          forsyth_score(cache_scores, valence_scores, position[v], live[v]);
+    }
+
+    best = -1;
+    float best_score = -1.0f;
+    for(int i = 0; i < next_count; i++) {
+      uint32_t v = next_cache[i];
+      for(uint32_t k = 0; k < live[v]; k++) {
+        uint32_t t = adjacency[offsets[v] + k];
+        float score = vertex_score[indices[t * 3]] +
+                      vertex_score[indices[t * 3 + 1]] +
+                      vertex_score[indices[t * 3 + 2]];
+        if(score > best_score) {
+          best_score = score;
+          best = (long)t;
+        }
+      }
+    }
+
+    cache_count =
+        next_count < FORSYTH_CACHE_SIZE ? next_count : FORSYTH_CACHE_SIZE;
+    memcpy(cache, next_cache, cache_count * sizeof(uint32_t));
+  }
+
+  memcpy(indices, output, triangle_count * 3 * sizeof(uint32_t));
+  free(output);
+  free(emitted);
+  free(vertex_score);
+  free(position);
+  free(adjacency);
+  free(offsets);
+  free(live);
+}
+
+struct overdraw_cluster {
+  float key;
+  uint32_t first, count; // in triangles
+};
+
+static int overdraw_cluster_compare(const void* a, const void* b) {
+  const struct overdraw_cluster* ca = a;
+  const struct overdraw_cluster* cb = b;
+  // most outward first, input order between equals
+  if(ca->key != cb->key) {
+    return ca->key > cb->key ? -1 : 1;
+  }
+  return ca->first < cb->first ? -1 : ca->first > cb->first;
+}
+
+// FIFO cache misses of one triangle, see mesh_analyze_vertex_cache
+static int overdraw_misses(const uint32_t* tri, uint32_t* time, uint32_t* now) {
+  int misses = 0;
+  for(int c = 0; c < 3; c++) {
+    if(*now - time[tri[c]] > MESH_CACHE_SIZE) {
+      time[tri[c]] = (*now)++;
+      misses++;
+    }
+  }
+  return misses;
+}
+
+void mesh_optimize_overdraw(
+    uint32_t* indices, size_t index_count, const float* positions,
+    size_t stride, size_t vertex_count, float threshold
+) {
+  size_t triangle_count = index_count / 3;
+  if(triangle_count == 0) {
+    return;
+  }
+  uint32_t* time = mesh_optimize_alloc(vertex_count * sizeof(uint32_t));
+  struct overdraw_cluster* clusters =
+      mesh_optimize_alloc(triangle_count * sizeof(*clusters));
+  size_t cluster_count = 0;
+  memset(time, 0, vertex_count * sizeof(uint32_t));
+  uint32_t now = MESH_CACHE_SIZE + 1;
+
+  // hard boundaries: triangles missing on every vertex start a fresh strip
+  // of the cache order anyway
+  for(size_t t = 0; t < triangle_count; t++) {
+    if(overdraw_misses(indices + t * 3, time, &now) == 3 || t == 0) {
+      clusters[cluster_count++] = (struct overdraw_cluster){0.0f, t, 0};
+    }
+    clusters[cluster_count - 1].count++;
+  }
+
+  // soft boundaries: cut a hard cluster as soon as the part so far, from a
+  // cold cache, is within threshold of the whole cluster's ACMR
+  size_t hard_count = cluster_count;
+  struct overdraw_cluster* hard = mesh_optimize_alloc(
+      hard_count * sizeof(*hard)
+  );
+  memcpy(hard, clusters, hard_count * sizeof(*hard));
+  cluster_count = 0;
+  for(size_t h = 0; h < hard_count; h++) {
+    uint32_t first = hard[h].first, end = first + hard[h].count;
+    now += MESH_CACHE_SIZE + 1;
+    int misses = 0;
+    for(uint32_t t = first; t < end; t++) {
+      misses += overdraw_misses(indices + t * 3, time, &now);
+    }
+    float limit = threshold * misses / (float)hard[h].count;
+
+    uint32_t start = first;
+    now += MESH_CACHE_SIZE + 1;
+    misses = 0;
+    for(uint32_t t = first; t < end; t++) {
+      misses += overdraw_misses(indices + t * 3, time, &now);
+      if(t + 1 == end || misses <= limit * (t + 1 - start)) {
+        clusters[cluster_count++] =
+            (struct overdraw_cluster){0.0f, start, t + 1 - start};
+        start = t + 1;
+        now += MESH_CACHE_SIZE + 1;
+        misses = 0;
+      }
+    }
+  }
+  free(hard);
+
+  // sort key: how far the cluster's centroid lies along its own normal,
+  // relative to the mesh centroid
+  vec3 mesh_center = GLM_VEC3_ZERO_INIT;
+  float mesh_area = 0.0f;
+  vec4* cluster_center = mesh_optimize_alloc(cluster_count * sizeof(vec4));
+  vec3* cluster_normal = mesh_optimize_alloc(cluster_count * sizeof(vec3));
+  for(size_t c = 0; c < cluster_count; c++) {
+    glm_vec4_zero(cluster_center[c]);
+    glm_vec3_zero(cluster_normal[c]);
+    for(uint32_t t = clusters[c].first;
+        t < clusters[c].first + clusters[c].count; t++) {
+      const float* p0 = positions + indices[t * 3] * stride;
+      const float* p1 = positions + indices[t * 3 + 1] * stride;
+      const float* p2 = positions + indices[t * 3 + 2] * stride;
+      vec3 e1, e2, n, center;
+      for(int k = 0; k < 3; k++) {
+        e1[k] = p1[k] - p0[k];
+        e2[k] = p2[k] - p0[k];
+        center[k] = (p0[k] + p1[k] + p2[k]) / 3.0f;
+      }
+      glm_vec3_cross(e1, e2, n);
+      float area = glm_vec3_norm(n);
+      glm_vec3_muladds(center, area, cluster_center[c]);
+      cluster_center[c][3] += area;
+      glm_vec3_add(cluster_normal[c], n, cluster_normal[c]);
+    }
+    glm_vec3_add(mesh_center, cluster_center[c], mesh_center);
+    mesh_area += cluster_center[c][3];
+  }
+  if(mesh_area > 0.0f) {
+    glm_vec3_scale(mesh_center, 1.0f / mesh_area, mesh_center);
+  }
+  for(size_t c = 0; c < cluster_count; c++) {
+    float area = cluster_center[c][3];
+    if(area > 0.0f) {
+      vec3 center;
+      glm_vec3_scale(cluster_center[c], 1.0f / area, center);
+      glm_vec3_sub(center, mesh_center, center);
+      glm_vec3_normalize(cluster_normal[c]);
+      clusters[c].key = glm_vec3_dot(center, cluster_normal[c]);
+    }
+  }
+  free(cluster_normal);
+  free(cluster_center);
+
+  qsort(clusters, cluster_count, sizeof(*clusters), overdraw_cluster_compare);
+  uint32_t* output = mesh_optimize_alloc(index_count * sizeof(uint32_t));
+  size_t out = 0;
+  for(size_t c = 0; c < cluster_count; c++) {
+    memcpy(
+        output + out, indices + clusters[c].first * 3,
+        clusters[c].count * 3 * sizeof(uint32_t)
+    );
+    out += clusters[c].count * 3;
+  }
+  memcpy(indices, output, out * sizeof(uint32_t));
+  free(output);
+  free(clusters);
+  free(time);
+}
+
+size_t mesh_optimize_vertex_fetch(
+    struct mesh_vertex* vertices, size_t vertex_count, uint32_t* indices,
+    size_t index_count
+) {
+  uint32_t* remap = mesh_optimize_alloc(vertex_count * sizeof(uint32_t));
+  memset(remap, 0xff, vertex_count * sizeof(uint32_t));
+  struct mesh_vertex* reordered =
+      mesh_optimize_alloc(vertex_count * sizeof(*vertices));
+  uint32_t next = 0;
+
+  for(size_t i = 0; i < index_count; i++) {
+    uint32_t v = indices[i];
+    if(remap[v] == UINT32_MAX) {
+      reordered[next] = vertices[v];
+      remap[v] = next++;
+    }
+    indices[i] = remap[v];
+  }
+  memcpy(vertices, reordered, next * sizeof(*vertices));
+  free(reordered);
+  free(remap);
+  return next;
+}
+
+// vertex cache order inside one meshlet, on its own few vertices so the
+// cost does not grow with the mesh
+static void mesh_optimize_meshlet(uint32_t* indices, size_t index_count) {
+  uint32_t local[MESHLET_MAX_TRIANGLES * 3];
+  uint32_t vertices[MESHLET_MAX_VERTICES];
+  uint32_t vertex_count = 0;
+  for(size_t i = 0; i < index_count; i++) {
+    uint32_t v = 0;
+    while(v < vertex_count && vertices[v] != indices[i]) {
+      v++;
+    }
+    if(v == vertex_count) {
+      vertices[vertex_count++] = indices[i];
+    }
+    local[i] = v;
+  }
+  mesh_optimize_vertex_cache(local, index_count, vertex_count);
+  for(size_t i = 0; i < index_count; i++) {
+    indices[i] = vertices[local[i]];
+  }
+}
+
+void mesh_optimize(
+    struct mesh_data* data, struct mesh_cache_stats* before,
+    struct mesh_cache_stats* after
+) {
+  uint32_t* base = data->indices + data->levels[0].first;
+  if(before) {
+    *before = mesh_analyze_vertex_cache(
+        base, data->levels[0].count, data->vertex_count, MESH_CACHE_SIZE
+    );
+  }
+  // levels are drawn on their own, each gets its own order
+  for(int l = 0; l < data->level_count; l++) {
+    uint32_t* indices = data->indices + data->levels[l].first;
+    mesh_optimize_vertex_cache(
+        indices, data->levels[l].count, data->vertex_count
+    );
+    mesh_optimize_overdraw(
+        indices, data->levels[l].count, data->vertices[0].position,
+        sizeof(struct mesh_vertex) / sizeof(float), data->vertex_count,
+        MESH_OVERDRAW_THRESHOLD
+    );
+  }
+
+  // meshlets last, they keep the order above between themselves
+  size_t capacity = 0;
+  for(int l = 0; l < data->level_count; l++) {
+    capacity += meshlet_max_count(data->levels[l].count);
+  }
+  free(data->meshlets);
+  data->meshlets = mesh_optimize_alloc(capacity * sizeof(struct meshlet));
+  data->meshlet_count = 0;
+  for(int l = 0; l < data->level_count; l++) {
+    struct meshlet* meshlets = data->meshlets + data->meshlet_count;
+    size_t count = meshlet_build(
+        meshlets, data->indices + data->levels[l].first, data->levels[l].count,
+        data->vertices[0].position, sizeof(struct mesh_vertex) / sizeof(float),
+        data->vertex_count
+    );
+    for(size_t m = 0; m < count; m++) {
+      meshlets[m].first += (uint32_t)data->levels[l].first;
+      mesh_optimize_meshlet(
+          data->indices + meshlets[m].first, meshlets[m].count
+      );
+    }
+    data->levels[l].meshlet_first = data->meshlet_count;
+    data->levels[l].meshlet_count = count;
+    data->meshlet_count += count;
+  }
+  // all levels share the vertices, level 0 first so its fetches stay in
+  // order and coarser ones mostly skip forward through them
+  data->vertex_count = mesh_optimize_vertex_fetch(
+      data->vertices, data->vertex_count, data->indices, data->index_count
+  );
+  if(after) {
+    *after = mesh_analyze_vertex_cache(
+        base, data->levels[0].count, data->vertex_count, MESH_CACHE_SIZE
+    );
+  }
+}
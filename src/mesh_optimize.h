@@ -0,0 +1,70 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mesh.h"
+
+#ifndef MESH_OPTIMIZE_FUNCTIONS
+#define MESH_OPTIMIZE_FUNCTIONS
+
+// fifo size the statistics simulate, close to what current gpus keep of
+// post-transform vertices
+#define MESH_CACHE_SIZE 16
+// overdraw ordering may cost this factor of the vertex cache misses
+#define MESH_OVERDRAW_THRESHOLD 1.05f
+
+/**
+ * Post-transform vertex cache efficiency of an index buffer on a FIFO cache
+ * of cache_size vertices. acmr is transformed vertices per triangle (0.5 is
+ * the limit for large regular grids, 3 is no reuse at all), atvr is
+ * transformed vertices per referenced vertex (1 is ideal).
+ */
+struct mesh_cache_stats {
+  float acmr, atvr;
+};
+
+struct mesh_cache_stats mesh_analyze_vertex_cache(
+    const uint32_t* indices, size_t index_count, size_t vertex_count,
+    int cache_size
+);
+
+/**
+ * Reorder triangles for vertex cache hits, Forsyth's greedy scoring on a
+ * 32 entry LRU model. Works for any real cache size.
+ */
+void mesh_optimize_vertex_cache(
+    uint32_t* indices, size_t index_count, size_t vertex_count
+);
+
+/**
+ * Reorder clusters of an already cache optimized index buffer so outward
+ * facing parts come first, which lets the depth test reject more of the
+ * rest (Sander et al. 2007). Clusters are cut so that each, starting from
+ * a cold cache, stays within threshold times its ACMR. positions has
+ * stride floats per vertex, x y z first.
+ */
+void mesh_optimize_overdraw(
+    uint32_t* indices, size_t index_count, const float* positions,
+    size_t stride, size_t vertex_count, float threshold
+);
+
+/**
+ * Renumber vertices in the order the index buffer first uses them, so
+ * vertex fetches walk memory forward, and drop unreferenced ones. Returns
+ * the new vertex count.
+ */
+size_t mesh_optimize_vertex_fetch(
+    struct mesh_vertex* vertices, size_t vertex_count, uint32_t* indices,
+    size_t index_count
+);
+
+/**
+ * All of the above on imported data, the reorderings per detail level
+ * followed by meshlet_build into data's meshlets, filling before and after
+ * (either may be NULL) with level 0's statistics for MESH_CACHE_SIZE.
+ */
+void mesh_optimize(
+    struct mesh_data* data, struct mesh_cache_stats* before,
+    struct mesh_cache_stats* after
+);
+
+#endif
@@ -0,0 +1,540 @@
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "mesh_simplify.h"
+
+// border planes weigh this much more than surface planes
+#define SIMPLIFY_BORDER_WEIGHT 10.0
+// collapses turning a triangle's normal further than this cosine are
+// rejected, small turns add up to folds over a few passes
+#define SIMPLIFY_FLIP_COS 0.25f
+
+enum simplify_kind {
+  SIMPLIFY_MANIFOLD, // free to collapse onto any neighbour
+  SIMPLIFY_BORDER,   // only along its open border
+  SIMPLIFY_SEAM,     // only along its uv or normal seam
+  SIMPLIFY_LOCKED    // seam corners and non-manifold vertices stay
+};
+
+// sum of weighted squared plane distances, p'Ap + 2b.p + c, in doubles since
+// the terms cancel a lot
+struct quadric {
+  double a00, a01, a02, a11, a12, a22;
+  double b0, b1, b2, c;
+  double w;
+};
+
+// from collapses onto to, on seams from2 onto to2 as well
+struct simplify_collapse {
+  float cost;
+  uint32_t from, to;
+  uint32_t from2, to2;
+};
+
+static void* simplify_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate simplifier buffers\n");
+    exit(1);
+  }
+  return p;
+}
+
+static void quadric_add_plane(struct quadric* q, vec3 n, float d, double w) {
+  q->a00 += w * n[0] * n[0];
+  q->a01 += w * n[0] * n[1];
+  q->a02 += w * n[0] * n[2];
+  q->a11 += w * n[1] * n[1];
+  q->a12 += w * n[1] * n[2];
+  q->a22 += w * n[2] * n[2];
+  q->b0 += w * n[0] * d;
+  q->b1 += w * n[1] * d;
+  q->b2 += w * n[2] * d;
+  q->c += w * d * d;
+  q->w += w;
+}
+
+static void quadric_add(struct quadric* q, const struct quadric* r) {
+  q->a00 += r->a00;
+  q->a01 += r->a01;
+  q->a02 += r->a02;
+  q->a11 += r->a11;
+  q->a12 += r->a12;
+  q->a22 += r->a22;
+  q->b0 += r->b0;
+  q->b1 += r->b1;
+  q->b2 += r->b2;
+  q->c += r->c;
+  q->w += r->w;
+}
+
+static double quadric_eval(const struct quadric* q, const float* p) {
+  double x = p[0], y = p[1], z = p[2];
+  double e = q->a00 * x * x + q->a11 * y * y + q->a22 * z * z +
+             2.0 * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z) +
+             2.0 * (q->b0 * x + q->b1 * y + q->b2 * z) + q->c;
+  return e > 0.0 ? e : 0.0;
+}
+
+static int simplify_compare_u64(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return x < y ? -1 : x > y;
+}
+
+static int simplify_compare_collapse(const void* a, const void* b) {
+  const struct simplify_collapse* x = a;
+  const struct simplify_collapse* y = b;
+  if(x->cost != y->cost) {
+    return x->cost < y->cost ? -1 : 1;
+  }
+  return x->from < y->from ? -1 : x->from > y->from;
+}
+
+static uint64_t simplify_edge_key(uint32_t a, uint32_t b) {
+  return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+// number of triangles on the welded edge (a, b), edges sorted
+static size_t simplify_edge_count(
+    const uint64_t* edges, size_t edge_count, uint32_t a, uint32_t b
+) {
+  uint64_t key = simplify_edge_key(a, b);
+  size_t lo = 0, hi = edge_count;
+  while(lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if(edges[mid] < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  size_t n = 0;
+  while(lo + n < edge_count && edges[lo + n] == key) {
+    n++;
+  }
+  return n;
+}
+
+// sorted edge keys of the triangles, of remap[index] unless remap is NULL
+static void simplify_edges(
+    uint64_t* edges, const uint32_t* indices, size_t count,
+    const uint32_t* remap
+) {
+  for(size_t i = 0; i < count; i++) {
+    uint32_t a = indices[i], b = indices[i - i % 3 + (i + 1) % 3];
+    edges[i] = remap ? simplify_edge_key(remap[a], remap[b])
+                     : simplify_edge_key(a, b);
+  }
+  qsort(edges, count, sizeof(uint64_t), simplify_compare_u64);
+}
+
+static double simplify_attrib_error(
+    const struct mesh_vertex* a, const struct mesh_vertex* b
+) {
+  vec3 dn;
+  vec2 duv;
+  glm_vec3_sub((float*)a->normal, (float*)b->normal, dn);
+  glm_vec2_sub((float*)a->uv, (float*)b->uv, duv);
+  return MESH_SIMPLIFY_NORMAL_WEIGHT * glm_vec3_norm2(dn) +
+         MESH_SIMPLIFY_UV_WEIGHT * glm_vec2_norm2(duv);
+}
+
+// whether moving from onto to turns one of from's remaining triangles too far
+static bool simplify_flips(
+    const uint32_t* indices, const uint32_t* offsets,
+    const uint32_t* adjacency, float (*p)[3], uint32_t from, uint32_t to
+) {
+  for(uint32_t k = offsets[from]; k < offsets[from + 1]; k++) {
+    const uint32_t* tri = indices + adjacency[k] * 3;
+    if(tri[0] == to || tri[1] == to || tri[2] == to) {
+      continue;
+    }
+    vec3 q[3], e1, e2, n0, n1;
+    for(int i = 0; i < 3; i++) {
+      glm_vec3_copy(p[tri[i]], q[i]);
+    }
+    glm_vec3_sub(q[1], q[0], e1);
+    glm_vec3_sub(q[2], q[0], e2);
+    glm_vec3_cross(e1, e2, n0);
+    for(int i = 0; i < 3; i++) {
+      if(tri[i] == from) {
+        glm_vec3_copy(p[to], q[i]);
+      }
+    }
+    glm_vec3_sub(q[1], q[0], e1);
+    glm_vec3_sub(q[2], q[0], e2);
+    glm_vec3_cross(e1, e2, n1);
+    if(glm_vec3_dot(n0, n1) <=
+       SIMPLIFY_FLIP_COS * glm_vec3_norm(n0) * glm_vec3_norm(n1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// keep the rest of the pass off v's triangles
+static void simplify_lock(
+    const uint32_t* indices, const uint32_t* offsets,
+    const uint32_t* adjacency, bool* locked, uint32_t v
+) {
+  for(uint32_t k = offsets[v]; k < offsets[v + 1]; k++) {
+    const uint32_t* tri = indices + adjacency[k] * 3;
+    locked[tri[0]] = locked[tri[1]] = locked[tri[2]] = true;
+  }
+}
+
+// vertices sharing a position get the lowest such index as their weld
+static void simplify_weld(
+    const float (*positions)[3], size_t vertex_count, uint32_t* weld
+) {
+  size_t size = 1;
+  while(size < vertex_count * 2) {
+    size *= 2;
+  }
+  uint32_t* slots = simplify_alloc(size * sizeof(uint32_t));
+  memset(slots, 0xff, size * sizeof(uint32_t));
+  for(size_t v = 0; v < vertex_count; v++) {
+    uint32_t bits[3], h = 2166136261u;
+    memcpy(bits, positions[v], sizeof(bits));
+    for(int k = 0; k < 3; k++) {
+      h = (h ^ bits[k]) * 16777619u;
+    }
+    size_t slot = h & (size - 1);
+    while(slots[slot] != UINT32_MAX &&
+          memcmp(positions[slots[slot]], positions[v], sizeof(bits))) {
+      slot = (slot + 1) & (size - 1);
+    }
+    if(slots[slot] == UINT32_MAX) {
+      slots[slot] = (uint32_t)v;
+    }
+    weld[v] = slots[slot];
+  }
+  free(slots);
+}
+
+size_t mesh_simplify(
+    uint32_t* dest, const uint32_t* indices, size_t index_count,
+    const struct mesh_vertex* vertices, size_t vertex_count,
+    size_t target_index_count, float* error
+) {
+  size_t count = index_count - index_count % 3;
+  memcpy(dest, indices, count * sizeof(uint32_t));
+  float max_error = 0.0f;
+  if(count <= target_index_count || vertex_count == 0) {
+    if(error) {
+      *error = 0.0f;
+    }
+    return count;
+  }
+
+  // work on a copy scaled to unit radius, so weights and errors do not
+  // depend on the mesh's units
+  vec3 box[2] = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+  for(size_t v = 0; v < vertex_count; v++) {
+    glm_vec3_minv(box[0], (float*)vertices[v].position, box[0]);
+    glm_vec3_maxv(box[1], (float*)vertices[v].position, box[1]);
+  }
+  vec3 center;
+  glm_vec3_center(box[0], box[1], center);
+  float radius = 0.5f * glm_vec3_distance(box[0], box[1]);
+  float scale = radius > 0.0f ? 1.0f / radius : 1.0f;
+  float (*p)[3] = simplify_alloc(vertex_count * sizeof(*p));
+  for(size_t v = 0; v < vertex_count; v++) {
+    glm_vec3_sub((float*)vertices[v].position, center, p[v]);
+    glm_vec3_scale(p[v], scale, p[v]);
+  }
+
+  // vertices at one position are wedges of it, linked in a ring; quadrics
+  // belong to positions
+  uint32_t* weld = simplify_alloc(vertex_count * sizeof(uint32_t));
+  uint32_t* wedge = simplify_alloc(vertex_count * sizeof(uint32_t));
+  simplify_weld((const float(*)[3])p, vertex_count, weld);
+  for(size_t v = 0; v < vertex_count; v++) {
+    wedge[v] = (uint32_t)v;
+    if(weld[v] != v) {
+      wedge[v] = wedge[weld[v]];
+      wedge[weld[v]] = (uint32_t)v;
+    }
+  }
+
+  // welded edges: a border edge has one triangle, more than two is
+  // non-manifold. Of the vertex edges, a seam edge has one triangle where
+  // its welded edge has two
+  uint64_t* edges = simplify_alloc(count * sizeof(uint64_t));
+  uint64_t* vertex_edges = simplify_alloc(count * sizeof(uint64_t));
+  simplify_edges(edges, dest, count, weld);
+
+  unsigned char* kind = simplify_alloc(vertex_count);
+  memset(kind, SIMPLIFY_MANIFOLD, vertex_count);
+  for(size_t i = 0; i < count; i++) {
+    uint32_t a = dest[i], b = dest[i - i % 3 + (i + 1) % 3];
+    size_t n = simplify_edge_count(edges, count, weld[a], weld[b]);
+    if(n != 2) {
+      unsigned char k = n == 1 ? SIMPLIFY_BORDER : SIMPLIFY_LOCKED;
+      kind[a] = kind[a] > k ? kind[a] : k;
+      kind[b] = kind[b] > k ? kind[b] : k;
+    }
+  }
+  // two wedges make a seam, which moves along itself with both sides
+  // together; corners of several seams, and seams meeting a border, stay
+  for(size_t v = 0; v < vertex_count; v++) {
+    if(wedge[v] == v) {
+      continue;
+    }
+    bool pair = wedge[wedge[v]] == v;
+    kind[v] = pair && kind[v] == SIMPLIFY_MANIFOLD ? SIMPLIFY_SEAM
+                                                   : SIMPLIFY_LOCKED;
+  }
+
+  // area weighted plane quadrics, plus planes through border edges standing
+  // up from the surface so borders keep their shape
+  struct quadric* quadrics = simplify_alloc(vertex_count * sizeof(*quadrics));
+  memset(quadrics, 0, vertex_count * sizeof(*quadrics));
+  for(size_t t = 0; t < count; t += 3) {
+    uint32_t v[3] = {weld[dest[t]], weld[dest[t + 1]], weld[dest[t + 2]]};
+    vec3 e1, e2, n;
+    glm_vec3_sub(p[v[1]], p[v[0]], e1);
+    glm_vec3_sub(p[v[2]], p[v[0]], e2);
+    glm_vec3_cross(e1, e2, n);
+    float area = glm_vec3_norm(n) * 0.5f;
+    if(area <= 0.0f) {
+      continue;
+    }
+    glm_vec3_normalize(n);
+    float d = -glm_vec3_dot(n, p[v[0]]);
+    for(int c = 0; c < 3; c++) {
+      quadric_add_plane(&quadrics[v[c]], n, d, area);
+
+      uint32_t a = v[c], b = v[(c + 1) % 3];
+      if(simplify_edge_count(edges, count, a, b) != 1) {
+        continue;
+      }
+      vec3 edge, side;
+      glm_vec3_sub(p[b], p[a], edge);
+      float length2 = glm_vec3_norm2(edge);
+      glm_vec3_cross(edge, n, side);
+      glm_vec3_normalize(side);
+      float sd = -glm_vec3_dot(side, p[a]);
+      quadric_add_plane(
+          &quadrics[a], side, sd, SIMPLIFY_BORDER_WEIGHT * length2
+      );
+      quadric_add_plane(
+          &quadrics[b], side, sd, SIMPLIFY_BORDER_WEIGHT * length2
+      );
+    }
+  }
+
+  uint32_t* offsets = simplify_alloc((vertex_count + 1) * sizeof(uint32_t));
+  uint32_t* adjacency = simplify_alloc(count * sizeof(uint32_t));
+  float* areas = simplify_alloc(vertex_count * sizeof(float));
+  bool* locked = simplify_alloc(vertex_count * sizeof(bool));
+  uint32_t* target = simplify_alloc(vertex_count * sizeof(uint32_t));
+  struct simplify_collapse* collapses =
+      simplify_alloc(count * 2 * sizeof(*collapses));
+
+  while(count > target_index_count) {
+    // triangles around every vertex, and a third of their area
+    memset(offsets, 0, (vertex_count + 1) * sizeof(uint32_t));
+    memset(areas, 0, vertex_count * sizeof(float));
+    for(size_t i = 0; i < count; i++) {
+      offsets[dest[i] + 1]++;
+    }
+    for(size_t v = 0; v < vertex_count; v++) {
+      offsets[v + 1] += offsets[v];
+    }
+    for(size_t t = 0; t < count; t += 3) {
+      vec3 e1, e2, n;
+      glm_vec3_sub(p[dest[t + 1]], p[dest[t]], e1);
+      glm_vec3_sub(p[dest[t + 2]], p[dest[t]], e2);
+      glm_vec3_cross(e1, e2, n);
+      for(int c = 0; c < 3; c++) {
+        uint32_t v = dest[t + c];
+        adjacency[offsets[v]++] = (uint32_t)(t / 3);
+        areas[v] += glm_vec3_norm(n) / 6.0f;
+      }
+    }
+    for(size_t v = vertex_count; v > 0; v--) {
+      offsets[v] = offsets[v - 1];
+    }
+    offsets[0] = 0;
+    // borders and seams as the collapses so far left them
+    simplify_edges(edges, dest, count, weld);
+    simplify_edges(vertex_edges, dest, count, NULL);
+
+    // every allowed direction of every edge, cheapest first
+    size_t collapse_count = 0;
+    for(size_t i = 0; i < count; i++) {
+      uint32_t a = dest[i], b = dest[i - i % 3 + (i + 1) % 3];
+      for(int dir = 0; dir < 2; dir++) {
+        struct simplify_collapse collapse = {
+            0.0f, dir ? b : a, dir ? a : b, UINT32_MAX, UINT32_MAX
+        };
+        uint32_t from = collapse.from, to = collapse.to;
+        size_t welded = simplify_edge_count(edges, count, weld[from], weld[to]);
+        if(kind[from] == SIMPLIFY_LOCKED || weld[from] == weld[to] ||
+           (kind[from] == SIMPLIFY_BORDER && welded != 1)) {
+          continue;
+        }
+        if(kind[from] == SIMPLIFY_SEAM) {
+          // along the seam, the other wedge follows to a wedge of to's
+          // position it shares a seam edge with
+          if(welded != 2 ||
+             simplify_edge_count(vertex_edges, count, from, to) != 1) {
+            continue;
+          }
+          collapse.from2 = wedge[from];
+          for(uint32_t w = wedge[to]; w != to; w = wedge[w]) {
+            if(simplify_edge_count(vertex_edges, count, collapse.from2, w)) {
+              collapse.to2 = w;
+            }
+          }
+          if(collapse.to2 == UINT32_MAX) {
+            continue;
+          }
+        }
+        struct quadric q = quadrics[weld[from]];
+        quadric_add(&q, &quadrics[weld[to]]);
+        double attribs = areas[from] * simplify_attrib_error(
+                                           &vertices[from], &vertices[to]
+                                       );
+        if(collapse.from2 != UINT32_MAX) {
+          attribs += areas[collapse.from2] *
+                     simplify_attrib_error(
+                         &vertices[collapse.from2], &vertices[collapse.to2]
+                     );
+        }
+        collapse.cost = (float)(quadric_eval(&q, p[to]) + attribs);
+        collapses[collapse_count++] = collapse;
+      }
+    }
+    qsort(
+        collapses, collapse_count, sizeof(*collapses),
+        simplify_compare_collapse
+    );
+
+    // take the cheapest collapses that do not touch each other's triangles;
+    // each removes about two triangles
+    size_t wanted = (count - target_index_count) / 6 + 1;
+    size_t applied = 0;
+    memset(locked, 0, vertex_count * sizeof(bool));
+    for(size_t v = 0; v < vertex_count; v++) {
+      target[v] = (uint32_t)v;
+    }
+    for(size_t c = 0; c < collapse_count && applied < wanted; c++) {
+      struct simplify_collapse* collapse = &collapses[c];
+      uint32_t from = collapse->from, to = collapse->to;
+      bool seam = collapse->from2 != UINT32_MAX;
+      if(locked[from] || locked[to] ||
+         (seam && (locked[collapse->from2] || locked[collapse->to2])) ||
+         simplify_flips(dest, offsets, adjacency, p, from, to) ||
+         (seam && simplify_flips(
+                      dest, offsets, adjacency, p, collapse->from2,
+                      collapse->to2
+                  ))) {
+        continue;
+      }
+
+      struct quadric q = quadrics[weld[from]];
+      quadric_add(&q, &quadrics[weld[to]]);
+      float distance = q.w > 0.0 ? (float)sqrt(quadric_eval(&q, p[to]) / q.w)
+                                 : 0.0f;
+      max_error = glm_max(max_error, distance);
+      quadrics[weld[to]] = q;
+      target[from] = to;
+      simplify_lock(dest, offsets, adjacency, locked, from);
+      if(seam) {
+        target[collapse->from2] = collapse->to2;
+        simplify_lock(dest, offsets, adjacency, locked, collapse->from2);
+      }
+      applied++;
+    }
+    if(applied == 0) {
+      break;
+    }
+
+    // collapsed targets are locked for the pass, one hop resolves them
+    size_t out = 0;
+    for(size_t t = 0; t < count; t += 3) {
+      uint32_t a = target[dest[t]], b = target[dest[t + 1]];
+      uint32_t c = target[dest[t + 2]];
+      if(a != b && b != c && a != c) {
+        dest[out++] = a;
+        dest[out++] = b;
+        dest[out++] = c;
+      }
+    }
+    count = out;
+  }
+
+  free(collapses);
+  free(target);
+  free(locked);
+  free(areas);
+  free(adjacency);
+  free(offsets);
+  free(quadrics);
+  free(kind);
+  free(vertex_edges);
+  free(edges);
+  free(wedge);
+  free(weld);
+  free(p);
+  if(error) {
+    *error = max_error;
+  }
+  return count;
+}
+
+void mesh_generate_lods(struct mesh_data* data) {
+  size_t base_count = data->levels[0].count;
+  size_t target = base_count;
+  uint32_t* scratch = simplify_alloc(base_count * sizeof(uint32_t));
+
+  while(data->level_count < LOD_MAX_LEVELS) {
+    size_t previous = data->levels[data->level_count - 1].count;
+    if(previous / 3 < 2 * MESH_LOD_MIN_TRIANGLES) {
+      break;
+    }
+    target = (size_t)(previous * MESH_LOD_REDUCTION) / 3 * 3;
+
+    // always from level 0, so errors are against the real surface
+    float error;
+    size_t count = mesh_simplify(
+        scratch, data->indices + data->levels[0].first, base_count,
+        data->vertices, data->vertex_count, target, &error
+    );
+    // stuck on seams and borders, another level would barely be cheaper
+    if(count > previous * 0.85 || error > MESH_LOD_MAX_ERROR) {
+      break;
+    }
+
+    if(data->index_count + count > data->index_capacity) {
+      data->index_capacity = data->index_count + count;
+      data->indices = realloc(
+          data->indices, data->index_capacity * sizeof(uint32_t)
+      );
+      if(!data->indices) {
+        fprintf(stderr, "[Error] Could not allocate mesh data\n");
+        exit(1);
+      }
+    }
+    memcpy(
+        data->indices + data->index_count, scratch, count * sizeof(uint32_t)
+    );
+    data->levels[data->level_count].first = data->index_count;
+    data->levels[data->level_count].count = count;
+    // levels are simplified independently, keep errors growing so screen
+    // sizes only shrink
+    data->levels[data->level_count].error =
+        glm_max(error, data->levels[data->level_count - 1].error);
+    data->level_count++;
+    data->index_count += count;
+  }
+  free(scratch);
+}
@@ -0,0 +1,53 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mesh.h"
+
+#ifndef MESH_SIMPLIFY_FUNCTIONS
+#define MESH_SIMPLIFY_FUNCTIONS
+
+// attribute differences are weighted against squared distances on a mesh
+// scaled to unit radius
+#define MESH_SIMPLIFY_NORMAL_WEIGHT 0.05f
+#define MESH_SIMPLIFY_UV_WEIGHT 0.5f
+// each level aims for this fraction of the previous one's triangles
+#define MESH_LOD_REDUCTION 0.5f
+// levels with fewer triangles than this are not worth another level
+#define MESH_LOD_MIN_TRIANGLES 64
+// past this error, relative to the radius, simplification changes the shape
+// rather than dropping detail and the chain ends
+#define MESH_LOD_MAX_ERROR 0.25f
+// a level is drawn until the next coarser one would be off by less than this
+// many pixels on a screen this tall
+#define MESH_LOD_PIXEL_ERROR 1.0f
+#define MESH_LOD_REFERENCE_HEIGHT 1080.0f
+
+/**
+ * Quadric error metric simplification (Garland and Heckbert 1997) by edge
+ * collapses onto existing vertices, so every level can share the vertex
+ * buffer. The error adds area weighted normal and uv differences to the
+ * plane quadrics. Open borders only collapse along themselves and are held
+ * in place by extra quadrics; uv and normal seams too, moving both sides
+ * together so they never crack. Seam corners and non-manifold vertices stay
+ * put, and collapses that would flip or sharply turn a triangle are
+ * skipped.
+ *
+ * Writes at most index_count indices to dest (which must not be indices),
+ * stopping once there are target_index_count or nothing can collapse, and
+ * returns how many were written. error, if not NULL, receives the largest
+ * distance the surface moved, relative to the bounding radius.
+ */
+size_t mesh_simplify(
+    uint32_t* dest, const uint32_t* indices, size_t index_count,
+    const struct mesh_vertex* vertices, size_t vertex_count,
+    size_t target_index_count, float* error
+);
+
+/**
+ * Append coarser levels to data's level 0, each simplified from level 0
+ * to MESH_LOD_REDUCTION of the level before, up to LOD_MAX_LEVELS or
+ * MESH_LOD_MAX_ERROR.
+ */
+void mesh_generate_lods(struct mesh_data* data);
+
+#endif
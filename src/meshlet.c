@@ -0,0 +1,249 @@
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "meshlet.h"
+
+size_t meshlet_max_count(size_t index_count) {
+  // a meshlet is closed early only when the next triangle would take it
+  // past the vertex limit, so every one but the last has at least this many
+  // triangles
+  size_t least = (MESHLET_MAX_VERTICES - 2) / 3;
+  return index_count / 3 / least + 1;
+}
+
+// bounds of the meshlet's triangles; centered on their box like the mesh's
+// own sphere
+static void meshlet_bounds(
+    struct meshlet* meshlet, const uint32_t* indices, const float* positions,
+    size_t stride
+) {
+  const uint32_t* tri = indices + meshlet->first;
+  vec3 box[2] = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+  for(uint32_t i = 0; i < meshlet->count; i++) {
+    const float* p = positions + tri[i] * stride;
+    glm_vec3_minv(box[0], (float*)p, box[0]);
+    glm_vec3_maxv(box[1], (float*)p, box[1]);
+  }
+  vec3 center;
+  glm_vec3_center(box[0], box[1], center);
+  float radius2 = 0.0f;
+  for(uint32_t i = 0; i < meshlet->count; i++) {
+    const float* p = positions + tri[i] * stride;
+    radius2 = glm_max(radius2, glm_vec3_distance2(center, (float*)p));
+  }
+  glm_vec3_copy(center, meshlet->sphere);
+  meshlet->sphere[3] = sqrtf(radius2);
+
+  // axis is the mean of the unit normals, the cone just wide enough for
+  // the one furthest from it
+  vec3 normals[MESHLET_MAX_TRIANGLES], axis = {0.0f, 0.0f, 0.0f};
+  uint32_t normal_count = 0;
+  for(uint32_t i = 0; i < meshlet->count; i += 3) {
+    vec3 e1, e2, n;
+    glm_vec3_sub(
+        (float*)(positions + tri[i + 1] * stride),
+        (float*)(positions + tri[i] * stride), e1
+    );
+    glm_vec3_sub(
+        (float*)(positions + tri[i + 2] * stride),
+        (float*)(positions + tri[i] * stride), e2
+    );
+    glm_vec3_cross(e1, e2, n);
+    if(glm_vec3_norm2(n) > 0.0f) {
+      glm_vec3_normalize_to(n, normals[normal_count]);
+      glm_vec3_add(axis, normals[normal_count], axis);
+      normal_count++;
+    }
+  }
+  glm_vec4_copy((vec4){0.0f, 0.0f, 1.0f, 1.0f}, meshlet->cone);
+  if(glm_vec3_norm2(axis) <= 0.0f) {
+    return;
+  }
+  glm_vec3_normalize(axis);
+  float min_dot = 1.0f;
+  for(uint32_t i = 0; i < normal_count; i++) {
+    min_dot = glm_min(min_dot, glm_vec3_dot(axis, normals[i]));
+  }
+  if(min_dot >= MESHLET_CONE_MIN_DOT) {
+    glm_vec3_copy(axis, meshlet->cone);
+    meshlet->cone[3] = sqrtf(1.0f - min_dot * min_dot);
+  }
+}
+
+static void* meshlet_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate meshlets\n");
+    exit(1);
+  }
+  return p;
+}
+
+size_t meshlet_build(
+    struct meshlet* meshlets, uint32_t* indices, size_t index_count,
+    const float* positions, size_t stride, size_t vertex_count
+) {
+  size_t triangle_count = index_count / 3;
+  if(triangle_count == 0) {
+    return 0;
+  }
+
+  // triangles around each vertex
+  uint32_t* offsets = meshlet_alloc((vertex_count + 1) * sizeof(uint32_t));
+  uint32_t* adjacency = meshlet_alloc(triangle_count * 3 * sizeof(uint32_t));
+  memset(offsets, 0, (vertex_count + 1) * sizeof(uint32_t));
+  for(size_t i = 0; i < triangle_count * 3; i++) {
+    offsets[indices[i] + 1]++;
+  }
+  for(size_t v = 0; v < vertex_count; v++) {
+    offsets[v + 1] += offsets[v];
+  }
+  for(size_t i = 0; i < triangle_count * 3; i++) {
+    adjacency[offsets[indices[i]]++] = (uint32_t)(i / 3);
+  }
+  for(size_t v = vertex_count; v > 0; v--) {
+    offsets[v] = offsets[v - 1];
+  }
+  offsets[0] = 0;
+
+  // unit normals and centroids, and the radius a meshlet of average
+  // triangles would have
+  float (*normals)[3] = meshlet_alloc(triangle_count * sizeof(*normals));
+  float (*centroids)[3] = meshlet_alloc(triangle_count * sizeof(*centroids));
+  float area = 0.0f;
+  for(size_t t = 0; t < triangle_count; t++) {
+    const float* p[3];
+    for(int c = 0; c < 3; c++) {
+      p[c] = positions + indices[t * 3 + c] * stride;
+    }
+    vec3 e1, e2;
+    glm_vec3_sub((float*)p[1], (float*)p[0], e1);
+    glm_vec3_sub((float*)p[2], (float*)p[0], e2);
+    glm_vec3_cross(e1, e2, normals[t]);
+    area += glm_vec3_norm(normals[t]) * 0.5f;
+    glm_vec3_normalize(normals[t]);
+    glm_vec3_add((float*)p[0], (float*)p[1], centroids[t]);
+    glm_vec3_add(centroids[t], (float*)p[2], centroids[t]);
+    glm_vec3_scale(centroids[t], 1.0f / 3.0f, centroids[t]);
+  }
+  float expected_radius =
+      sqrtf(area / triangle_count * MESHLET_MAX_TRIANGLES / GLM_PIf);
+  if(expected_radius <= 0.0f) {
+    expected_radius = 1.0f;
+  }
+
+  // which meshlet (+ 1) holds a vertex, so no per meshlet clearing
+  uint32_t* seen = meshlet_alloc(vertex_count * sizeof(uint32_t));
+  memset(seen, 0, vertex_count * sizeof(uint32_t));
+  bool* used = meshlet_alloc(triangle_count * sizeof(bool));
+  memset(used, 0, triangle_count * sizeof(bool));
+  uint32_t* order = meshlet_alloc(triangle_count * sizeof(uint32_t));
+
+  // grow each meshlet from the first triangle left in the input order by
+  // the neighbour adding the fewest vertices, then the one closest to it
+  // in position and normal
+  size_t count = 0, emitted = 0, seed = 0;
+  while(emitted < triangle_count) {
+    uint32_t id = (uint32_t)count + 1;
+    uint32_t vertices[MESHLET_MAX_VERTICES];
+    uint32_t vertex_total = 0;
+    size_t first = emitted;
+    vec3 normal_sum = {0.0f, 0.0f, 0.0f}, centroid_sum = {0.0f, 0.0f, 0.0f};
+    while(used[seed]) {
+      seed++;
+    }
+    size_t next = seed;
+    while(next != SIZE_MAX) {
+      used[next] = true;
+      order[emitted++] = (uint32_t)next;
+      glm_vec3_add(normal_sum, normals[next], normal_sum);
+      glm_vec3_add(centroid_sum, centroids[next], centroid_sum);
+      for(int c = 0; c < 3; c++) {
+        uint32_t v = indices[next * 3 + c];
+        if(seen[v] != id) {
+          seen[v] = id;
+          vertices[vertex_total++] = v;
+        }
+      }
+      if(emitted - first == MESHLET_MAX_TRIANGLES) {
+        break;
+      }
+
+      vec3 axis, center;
+      glm_vec3_normalize_to(normal_sum, axis);
+      glm_vec3_scale(centroid_sum, 1.0f / (emitted - first), center);
+      next = SIZE_MAX;
+      uint32_t best_extra = 4;
+      float best_score = FLT_MAX;
+      for(uint32_t i = 0; i < vertex_total; i++) {
+        uint32_t v = vertices[i];
+        for(uint32_t k = offsets[v]; k < offsets[v + 1]; k++) {
+          uint32_t t = adjacency[k];
+          if(used[t]) {
+            continue;
+          }
+          uint32_t extra = 0;
+          for(int c = 0; c < 3; c++) {
+            extra += seen[indices[t * 3 + c]] != id;
+          }
+          if(vertex_total + extra > MESHLET_MAX_VERTICES ||
+             extra > best_extra) {
+            continue;
+          }
+          float score =
+              glm_vec3_distance(centroids[t], center) / expected_radius +
+              1.0f - glm_vec3_dot(normals[t], axis);
+          if(extra < best_extra || score < best_score) {
+            next = t;
+            best_extra = extra;
+            best_score = score;
+          }
+        }
+      }
+      // nothing touching it is left: carry on in input order, which is
+      // still mostly nearby, rather than leave the meshlet half empty
+      while(seed < triangle_count && used[seed]) {
+        seed++;
+      }
+      if(next == SIZE_MAX && seed < triangle_count) {
+        uint32_t extra = 0;
+        for(int c = 0; c < 3; c++) {
+          extra += seen[indices[seed * 3 + c]] != id;
+        }
+        if(vertex_total + extra <= MESHLET_MAX_VERTICES) {
+          next = seed;
+        }
+      }
+    }
+    struct meshlet* meshlet = &meshlets[count++];
+    memset(meshlet, 0, sizeof(*meshlet));
+    meshlet->first = (uint32_t)first * 3;
+    meshlet->count = (uint32_t)(emitted - first) * 3;
+  }
+
+  // put the triangles in meshlet order, then bound the ranges
+  uint32_t* reordered = meshlet_alloc(triangle_count * 3 * sizeof(uint32_t));
+  for(size_t t = 0; t < triangle_count; t++) {
+    memcpy(reordered + t * 3, indices + order[t] * 3, 3 * sizeof(uint32_t));
+  }
+  memcpy(indices, reordered, triangle_count * 3 * sizeof(uint32_t));
+  for(size_t m = 0; m < count; m++) {
+    meshlet_bounds(&meshlets[m], indices, positions, stride);
+  }
+
+  free(reordered);
+  free(order);
+  free(used);
+  free(seen);
+  free(centroids);
+  free(normals);
+  free(adjacency);
+  free(offsets);
+  return count;
+}
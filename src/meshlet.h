@@ -0,0 +1,50 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MESHLET_FUNCTIONS
+#define MESHLET_FUNCTIONS
+
+// limits of one cluster, the ones mesh shading hardware is tuned for
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+// normals spread further than this from the cone axis (as a cosine) make a
+// cone that would hardly ever cull, such meshlets get none
+#define MESHLET_CONE_MIN_DOT 0.1f
+
+/**
+ * A cluster of triangles, a range of its mesh's index buffer, with bounds
+ * for culling in mesh space. It faces away from an eye e entirely when
+ * dot(center - e, axis) >= cutoff * |center - e| + radius, cutoff is the
+ * sine of the normals' spread around axis and 1 when there is no cone.
+ * Laid out as an std430 array element: vec4 sphere, vec4 cone, uint first,
+ * uint count, 2 more uints of padding.
+ */
+struct meshlet {
+  float sphere[4]; // center, radius
+  float cone[4];   // axis, cutoff
+  uint32_t first, count; // in indices
+  uint32_t reserved[2];
+};
+
+/**
+ * Most meshlets meshlet_build makes of index_count indices.
+ */
+size_t meshlet_max_count(size_t index_count);
+
+/**
+ * Reorder the triangles of an index buffer into meshlets of at most
+ * MESHLET_MAX_VERTICES distinct vertices and MESHLET_MAX_TRIANGLES
+ * triangles, each one consecutive range, so it is one range of a
+ * multi-draw. Meshlets grow over neighbouring triangles preferring those
+ * that add no vertices and then those close in position and normal, which
+ * keeps vertex reuse within a meshlet and its cone narrow. They are seeded
+ * in the incoming order, so run it after the vertex cache and overdraw
+ * optimizations. positions has stride floats per vertex, x y z first.
+ * first counts from indices. Returns the number of meshlets written.
+ */
+size_t meshlet_build(
+    struct meshlet* meshlets, uint32_t* indices, size_t index_count,
+    const float* positions, size_t stride, size_t vertex_count
+);
+
+#endif
@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "cull.h"
+#include "meshlet_cull.h"
+#include "shader.h"
+
+// one invocation per meshlet of the level, writing its draw command; the
+// tests are the cpu ones below
+static const char* cull_compute_source =
+    "#version 430 core\n"
+    "layout (local_size_x = 64) in; // MESHLET_CULL_GROUP_SIZE\n"
+    "struct meshlet {\n"
+    "  vec4 sphere;\n"
+    "  vec4 cone;\n"
+    "  uint first, count, reserved0, reserved1;\n"
+    "};\n"
+    "struct command {\n"
+    "  uint count, instance_count, first;\n"
+    "  int base_vertex;\n"
+    "  uint base_instance;\n"
+    "};\n"
+    "layout (std430, binding = 0) readonly buffer meshlet_buffer {\n"
+    "  meshlet meshlets[];\n"
+    "};\n"
+    "layout (std430, binding = 1) writeonly buffer command_buffer {\n"
+    "  command commands[];\n"
+    "};\n"
+    "uniform vec4 planes[6];\n"
+    "uniform vec3 eye;\n"
+    "uniform uint meshlet_first;\n"
+    "uniform uint meshlet_count;\n"
+    "void main() {\n"
+    "  uint i = gl_GlobalInvocationID.x;\n"
+    "  if(i >= meshlet_count) {\n"
+    "    return;\n"
+    "  }\n"
+    "  meshlet m = meshlets[meshlet_first + i];\n"
+    "  bool visible = true;\n"
+    "  for(int p = 0; p < 6; p++) {\n"
+    "    visible = visible &&\n"
+    "              dot(planes[p].xyz, m.sphere.xyz) + planes[p].w >=\n"
+    "                  -m.sphere.w;\n"
+    "  }\n"
+    "  vec3 v = m.sphere.xyz - eye;\n"
+    "  visible = visible &&\n"
+    "            dot(v, m.cone.xyz) < m.cone.w * length(v) + m.sphere.w;\n"
+    "  commands[i] = command(m.count, visible ? 1u : 0u, m.first, 0, 0u);\n"
+    "}\n";
+
+// DrawElementsIndirectCommand
+struct meshlet_command {
+  GLuint count, instance_count, first;
+  GLint base_vertex;
+  GLuint base_instance;
+};
+
+static void* meshlet_cull_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate meshlet culling\n");
+    exit(1);
+  }
+  return p;
+}
+
+void meshlet_culler_init(struct meshlet_culler* c, struct mesh* mesh) {
+  memset(c, 0, sizeof(*c));
+  c->mesh = mesh;
+  size_t count = mesh->meshlet_count;
+  c->spheres = meshlet_cull_alloc(count * 4 * sizeof(float));
+  for(size_t m = 0; m < count; m++) {
+    glm_sphere_soa_set(mesh->meshlets[m].sphere, c->spheres, count, m);
+  }
+  c->visible = meshlet_cull_alloc(count * sizeof(uint32_t));
+  c->counts = meshlet_cull_alloc(count * sizeof(GLsizei));
+  c->offsets = meshlet_cull_alloc(count * sizeof(void*));
+
+  GLint major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  c->gpu = (major > 4 || (major == 4 && minor >= 3)) && count > 0;
+  if(!c->gpu) {
+    return;
+  }
+  c->program = process_compute_shader(cull_compute_source);
+  c->planes_loc = glGetUniformLocation(c->program, "planes");
+  c->eye_loc = glGetUniformLocation(c->program, "eye");
+  c->first_loc = glGetUniformLocation(c->program, "meshlet_first");
+  c->count_loc = glGetUniformLocation(c->program, "meshlet_count");
+
+  // room for the commands of the level with the most meshlets
+  size_t commands = 0;
+  for(int l = 0; l < mesh->lod.levels; l++) {
+    if(mesh->meshlet_levels[l].count > commands) {
+      commands = mesh->meshlet_levels[l].count;
+    }
+  }
+  glGenBuffers(1, &c->meshlet_buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, c->meshlet_buffer);
+  glBufferData(
+      GL_SHADER_STORAGE_BUFFER, count * sizeof(struct meshlet), mesh->meshlets,
+      GL_STATIC_DRAW
+  );
+  glGenBuffers(1, &c->command_buffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, c->command_buffer);
+  glBufferData(
+      GL_SHADER_STORAGE_BUFFER, commands * sizeof(struct meshlet_command),
+      NULL, GL_DYNAMIC_DRAW
+  );
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void meshlet_culler_destroy(struct meshlet_culler* c) {
+  if(c->program) {
+    glDeleteProgram(c->program);
+    glDeleteBuffers(1, &c->meshlet_buffer);
+    glDeleteBuffers(1, &c->command_buffer);
+  }
+  free(c->offsets);
+  free(c->counts);
+  free(c->visible);
+  free(c->spheres);
+  memset(c, 0, sizeof(*c));
+}
+
+// frustum planes and eye in mesh space
+static void meshlet_cull_space(
+    mat4 model, mat4 view_proj, vec3 eye, vec4 planes[6], vec3 local_eye
+) {
+  mat4 mvp, inverse;
+  glm_mat4_mul(view_proj, model, mvp);
+  glm_frustum_planes(mvp, planes);
+  glm_mat4_inv(model, inverse);
+  glm_mat4_mulv3(inverse, eye, 1.0f, local_eye);
+}
+
+size_t meshlet_cull(
+    struct meshlet_culler* c, int level, mat4 model, mat4 view_proj, vec3 eye
+) {
+  struct mesh* mesh = c->mesh;
+  uint32_t first = mesh->meshlet_levels[level].first;
+  size_t count = mesh->meshlet_levels[level].count;
+  vec4 planes[6];
+  vec3 local_eye;
+  meshlet_cull_space(model, view_proj, eye, planes, local_eye);
+
+  // the level's spheres are a column range of the SoA
+  size_t visible = cull_spheres(
+      c->spheres + first, mesh->meshlet_count, count, planes, c->visible
+  );
+  size_t index_size = mesh->lod.index_type == GL_UNSIGNED_SHORT
+                          ? sizeof(uint16_t)
+                          : sizeof(uint32_t);
+  size_t drawn = 0;
+  for(size_t i = 0; i < visible; i++) {
+    const struct meshlet* m = &mesh->meshlets[first + c->visible[i]];
+    vec3 v;
+    glm_vec3_sub((float*)m->sphere, local_eye, v);
+    if(glm_vec3_dot(v, (float*)m->cone) >=
+       m->cone[3] * glm_vec3_norm(v) + m->sphere[3]) {
+      continue;
+    }
+    c->counts[drawn] = (GLsizei)m->count;
+    c->offsets[drawn] = (const void*)(uintptr_t)(m->first * index_size);
+    drawn++;
+  }
+  return drawn;
+}
+
+void meshlet_draw(
+    struct meshlet_culler* c, int level, mat4 model, mat4 view_proj, vec3 eye
+) {
+  struct mesh* mesh = c->mesh;
+  if(!c->gpu) {
+    size_t drawn = meshlet_cull(c, level, model, view_proj, eye);
+    glBindVertexArray(mesh->vao);
+    glMultiDrawElements(
+        GL_TRIANGLES, c->counts, mesh->lod.index_type, c->offsets,
+        (GLsizei)drawn
+    );
+    return;
+  }
+
+  GLuint count = mesh->meshlet_levels[level].count;
+  if(count == 0) {
+    return;
+  }
+  vec4 planes[6];
+  vec3 local_eye;
+  meshlet_cull_space(model, view_proj, eye, planes, local_eye);
+
+  GLint program = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glUseProgram(c->program);
+  glUniform4fv(c->planes_loc, 6, planes[0]);
+  glUniform3fv(c->eye_loc, 1, local_eye);
+  glUniform1ui(c->first_loc, mesh->meshlet_levels[level].first);
+  glUniform1ui(c->count_loc, count);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, c->meshlet_buffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, c->command_buffer);
+  glDispatchCompute(
+      (count + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1
+  );
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+  glUseProgram(program);
+
+  glBindVertexArray(mesh->vao);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, c->command_buffer);
+  glMultiDrawElementsIndirect(
+      GL_TRIANGLES, mesh->lod.index_type, NULL, (GLsizei)count, 0
+  );
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,65 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <GL/glew.h>
+
+#include "../include/cglm/types.h"
+#include "mesh.h"
+
+#ifndef MESHLET_CULL_FUNCTIONS
+#define MESHLET_CULL_FUNCTIONS
+
+// compute shader work group size of the gpu pass
+#define MESHLET_CULL_GROUP_SIZE 64
+
+/**
+ * Per meshlet culling of one mesh: meshlets outside the frustum or facing
+ * away from the eye are dropped and the rest drawn with one multi-draw.
+ * Culling runs in mesh space, on planes of view_proj * model and the eye
+ * moved by the inverse of model, which stays exact for any model matrix
+ * that keeps triangle winding.
+ *
+ * On GL 4.3 a compute shader writes one indirect command per meshlet, with
+ * no instances for culled ones, and glMultiDrawElementsIndirect draws them
+ * without a round trip to the cpu. Before that (or with gpu cleared) the
+ * meshlet spheres go through cull_spheres on the job threads, the cone
+ * test runs on the survivors and glMultiDrawElements draws them.
+ */
+struct meshlet_culler {
+  struct mesh* mesh;
+  float* spheres; // SoA meshlet spheres for cull_spheres
+  uint32_t* visible;
+  GLsizei* counts;
+  const void** offsets;
+  bool gpu;
+  GLuint program, meshlet_buffer, command_buffer;
+  GLint planes_loc, eye_loc, first_loc, count_loc;
+};
+
+/**
+ * Set up culling of mesh's meshlets, which must stay loaded while the
+ * culler is used. The gpu path is taken when the context is GL 4.3+.
+ */
+void meshlet_culler_init(struct meshlet_culler* c, struct mesh* mesh);
+
+void meshlet_culler_destroy(struct meshlet_culler* c);
+
+/**
+ * Cpu pass over the meshlets of a detail level: fill counts and offsets
+ * with the visible ones for glMultiDrawElements and return how many there
+ * are. eye is the camera position in world space.
+ */
+size_t meshlet_cull(
+    struct meshlet_culler* c, int level, mat4 model, mat4 view_proj, vec3 eye
+);
+
+/**
+ * Cull the meshlets of a detail level, on the gpu when c->gpu, and draw
+ * what is left. The program drawing the mesh must be current, it is again
+ * afterwards.
+ */
+void meshlet_draw(
+    struct meshlet_culler* c, int level, mat4 model, mat4 view_proj, vec3 eye
+);
+
+#endif
@@ -0,0 +1,288 @@
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "jobs.h"
+#include "occlusion.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define OCCLUSION_BAND_ROWS 16
+// corners closer to the eye plane than this can not be projected
+#define OCCLUSION_MIN_W 1e-5f
+
+static void* occlusion_alloc(size_t size) {
+  // rows are read and written four floats at a time
+  void* p = aligned_alloc(16, (size + 15) & ~(size_t)15);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate occlusion buffers\n");
+    exit(1);
+  }
+  return p;
+}
+
+// clip space w of a point, the last row of m
+static float occlusion_clip_w(mat4 m, vec3 p) {
+  return m[0][3] * p[0] + m[1][3] * p[1] + m[2][3] * p[2] + m[3][3];
+}
+
+void occlusion_init(struct occlusion* occ, int width, int height) {
+  memset(occ, 0, sizeof(*occ));
+  occ->width = width;
+  occ->height = height;
+  glm_vec4_copy((vec4){0.0f, 0.0f, width, height}, occ->viewport);
+  glm_mat4_identity(occ->view_proj);
+
+  int w = width, h = height;
+  while(occ->levels < OCCLUSION_MAX_LEVELS) {
+    int l = occ->levels++;
+    occ->level_width[l] = w;
+    occ->level_height[l] = h;
+    occ->level_stride[l] = (w + 3) & ~3;
+    occ->level[l] = occlusion_alloc(occ->level_stride[l] * h * sizeof(float));
+    if(w == 1 && h == 1) {
+      break;
+    }
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+  }
+}
+
+void occlusion_destroy(struct occlusion* occ) {
+  for(int l = 0; l < occ->levels; l++) {
+    free(occ->level[l]);
+  }
+  free(occ->triangles);
+  memset(occ, 0, sizeof(*occ));
+}
+
+void occlusion_begin(struct occlusion* occ, mat4 view_proj) {
+  glm_mat4_copy(view_proj, occ->view_proj);
+  occ->triangle_count = 0;
+}
+
+void occlusion_add_occluder(
+    struct occlusion* occ, mat4 model, const float* positions, size_t stride,
+    const uint32_t* indices, size_t index_count
+) {
+  mat4 m;
+  glm_mat4_mul(occ->view_proj, model, m);
+
+  size_t needed = occ->triangle_count + index_count / 3;
+  if(needed > occ->triangle_capacity) {
+    occ->triangle_capacity = 2 * occ->triangle_capacity > needed
+                                 ? 2 * occ->triangle_capacity
+                                 : needed;
+    occ->triangles = realloc(
+        occ->triangles, occ->triangle_capacity * 9 * sizeof(float)
+    );
+    if(!occ->triangles) {
+      fprintf(stderr, "[Error] Could not allocate occlusion buffers\n");
+      exit(1);
+    }
+  }
+
+  for(size_t i = 0; i + 3 <= index_count; i += 3) {
+    float* tri = occ->triangles + occ->triangle_count * 9;
+    int c = 0;
+    for(; c < 3; c++) {
+      const float* p = positions + indices[i + c] * stride;
+      vec3 v = {p[0], p[1], p[2]};
+      if(occlusion_clip_w(m, v) <= OCCLUSION_MIN_W) {
+        break;
+      }
+      glm_project(v, m, occ->viewport, tri + c * 3);
+    }
+    if(c == 3) {
+      occ->triangle_count++;
+    }
+  }
+}
+
+// rasterize every triangle into rows [y0, y1), keeping the nearest depth
+static void occlusion_raster(struct occlusion* occ, int y0, int y1) {
+  float* depth = occ->level[0];
+  int stride = occ->level_stride[0];
+
+  for(size_t t = 0; t < occ->triangle_count; t++) {
+    const float* v = occ->triangles + t * 9;
+    float minx = glm_min(v[0], glm_min(v[3], v[6]));
+    float maxx = glm_max(v[0], glm_max(v[3], v[6]));
+    float miny = glm_min(v[1], glm_min(v[4], v[7]));
+    float maxy = glm_max(v[1], glm_max(v[4], v[7]));
+    // skip bounds off the band (or NaN) while still in float, so clamping
+    // leaves both ends in range before they are converted
+    if(!(maxx >= 0.0f && minx < occ->width && maxy >= y0 && miny < y1)) {
+      continue;
+    }
+    // pixel centers inside the bounds, in this band
+    int ix0 = (int)glm_clamp(ceilf(minx - 0.5f), 0.0f, occ->width - 1.0f);
+    int ix1 = (int)glm_clamp(floorf(maxx - 0.5f), 0.0f, occ->width - 1.0f);
+    int iy0 = (int)glm_clamp(ceilf(miny - 0.5f), (float)y0, y1 - 1.0f);
+    int iy1 = (int)glm_clamp(floorf(maxy - 0.5f), (float)y0, y1 - 1.0f);
+    if(ix0 > ix1 || iy0 > iy1) {
+      continue;
+    }
+
+    float area = (v[3] - v[0]) * (v[7] - v[1]) - (v[6] - v[0]) * (v[4] - v[1]);
+    if(fabsf(area) < 1e-8f) {
+      continue;
+    }
+    // edge functions, positive inside whatever the winding
+    float s = area > 0.0f ? 1.0f : -1.0f, a[3], b[3], c[3];
+    for(int e = 0; e < 3; e++) {
+      const float* p = v + e * 3;
+      const float* q = v + ((e + 1) % 3) * 3;
+      a[e] = -(q[1] - p[1]) * s;
+      b[e] = (q[0] - p[0]) * s;
+      c[e] = ((q[1] - p[1]) * p[0] - (q[0] - p[0]) * p[1]) * s;
+    }
+    // depth is affine in window space
+    float dzdx = ((v[5] - v[2]) * (v[7] - v[1]) - (v[8] - v[2]) * (v[4] - v[1]))
+               / area;
+    float dzdy = ((v[8] - v[2]) * (v[3] - v[0]) - (v[5] - v[2]) * (v[6] - v[0]))
+               / area;
+    float zc = v[2] - dzdx * v[0] - dzdy * v[1];
+
+    for(int y = iy0; y <= iy1; y++) {
+      float py = y + 0.5f;
+      float* row = depth + y * stride;
+#if defined(__SSE2__)
+      __m128 zero = _mm_setzero_ps(), lo = _mm_set1_ps(ix0);
+      __m128 hi = _mm_set1_ps(ix1), dz = _mm_set1_ps(dzdx);
+      __m128 z = _mm_set1_ps(dzdy * py + zc), ea[3], eb[3];
+      for(int e = 0; e < 3; e++) {
+        ea[e] = _mm_set1_ps(a[e]);
+        eb[e] = _mm_set1_ps(b[e] * py + c[e]);
+      }
+      // aligned groups of four, lanes outside [ix0, ix1] are masked
+      for(int x = ix0 & ~3; x <= ix1; x += 4) {
+        __m128 ix = _mm_add_ps(_mm_set1_ps(x), _mm_set_ps(3, 2, 1, 0));
+        __m128 px = _mm_add_ps(ix, _mm_set1_ps(0.5f));
+        __m128 m = _mm_and_ps(_mm_cmpge_ps(ix, lo), _mm_cmple_ps(ix, hi));
+        for(int e = 0; e < 3; e++) {
+          __m128 edge = _mm_add_ps(_mm_mul_ps(ea[e], px), eb[e]);
+          m = _mm_and_ps(m, _mm_cmpge_ps(edge, zero));
+        }
+        __m128 d = _mm_load_ps(row + x);
+        __m128 pz = _mm_add_ps(_mm_mul_ps(dz, px), z);
+        d = _mm_or_ps(_mm_and_ps(m, _mm_min_ps(d, pz)), _mm_andnot_ps(m, d));
+        _mm_store_ps(row + x, d);
+      }
+#else
+      for(int x = ix0; x <= ix1; x++) {
+        float px = x + 0.5f;
+        if(a[0] * px + b[0] * py + c[0] >= 0.0f &&
+           a[1] * px + b[1] * py + c[1] >= 0.0f &&
+           a[2] * px + b[2] * py + c[2] >= 0.0f) {
+          row[x] = glm_min(row[x], dzdx * px + dzdy * py + zc);
+        }
+      }
+#endif
+    }
+  }
+}
+
+static void occlusion_band(void* arg, size_t band) {
+  struct occlusion* occ = arg;
+  int y0 = (int)band * OCCLUSION_BAND_ROWS;
+  int y1 = y0 + OCCLUSION_BAND_ROWS < occ->height ? y0 + OCCLUSION_BAND_ROWS
+                                                  : occ->height;
+  int stride = occ->level_stride[0];
+
+  for(int i = y0 * stride; i < y1 * stride; i++) {
+    occ->level[0][i] = 1.0f;
+  }
+  occlusion_raster(occ, y0, y1);
+}
+
+void occlusion_render(struct occlusion* occ) {
+  size_t bands =
+      (occ->height + OCCLUSION_BAND_ROWS - 1) / OCCLUSION_BAND_ROWS;
+  jobs_run(occlusion_band, occ, bands);
+
+  // each texel keeps the farthest depth of the 2x2 texels below it
+  for(int l = 1; l < occ->levels; l++) {
+    const float* src = occ->level[l - 1];
+    float* dst = occ->level[l];
+    int sw = occ->level_width[l - 1], sh = occ->level_height[l - 1];
+    int ss = occ->level_stride[l - 1], ds = occ->level_stride[l];
+    for(int y = 0; y < occ->level_height[l]; y++) {
+      const float* r0 = src + 2 * y * ss;
+      const float* r1 = 2 * y + 1 < sh ? r0 + ss : r0;
+      for(int x = 0; x < occ->level_width[l]; x++) {
+        int x0 = 2 * x, x1 = 2 * x + 1 < sw ? 2 * x + 1 : 2 * x;
+        dst[y * ds + x] = glm_max(
+            glm_max(r0[x0], r0[x1]), glm_max(r1[x0], r1[x1])
+        );
+      }
+    }
+  }
+}
+
+bool occlusion_visible(struct occlusion* occ, vec3 box[2]) {
+  float minx = FLT_MAX, miny = FLT_MAX, maxx = -FLT_MAX, maxy = -FLT_MAX;
+  float zmin = FLT_MAX;
+
+  for(int c = 0; c < 8; c++) {
+    vec3 p = {box[c & 1][0], box[(c >> 1) & 1][1], box[(c >> 2) & 1][2]};
+    vec3 s;
+    // a corner behind the eye has no window position, keep the object
+    if(occlusion_clip_w(occ->view_proj, p) <= OCCLUSION_MIN_W) {
+      return true;
+    }
+    glm_project(p, occ->view_proj, occ->viewport, s);
+    minx = glm_min(minx, s[0]);
+    maxx = glm_max(maxx, s[0]);
+    miny = glm_min(miny, s[1]);
+    maxy = glm_max(maxy, s[1]);
+    zmin = glm_min(zmin, s[2]);
+  }
+
+  // off screen objects are the frustum test's business
+  if(maxx < 0.0f || maxy < 0.0f || minx >= occ->width ||
+     miny >= occ->height) {
+    return true;
+  }
+  int ix0 = (int)glm_max(minx, 0.0f);
+  int iy0 = (int)glm_max(miny, 0.0f);
+  int ix1 = (int)glm_min(maxx, occ->width - 1.0f);
+  int iy1 = (int)glm_min(maxy, occ->height - 1.0f);
+
+  // coarsest level the rect still covers at most 4x4 texels of, a 2x2
+  // footprint is cheaper to read but rejects far less
+  int l = 0;
+  while(l < occ->levels - 1 &&
+        ((ix1 >> l) - (ix0 >> l) > 3 || (iy1 >> l) - (iy0 >> l) > 3)) {
+    l++;
+  }
+  const float* level = occ->level[l];
+  int stride = occ->level_stride[l];
+  for(int y = iy0 >> l; y <= iy1 >> l; y++) {
+    for(int x = ix0 >> l; x <= ix1 >> l; x++) {
+      if(zmin <= level[y * stride + x]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+size_t occlusion_cull(
+    struct occlusion* occ, vec3 (*boxes)[2], const uint32_t* ids,
+    size_t count, uint32_t* visible
+) {
+  size_t n = 0;
+  for(size_t i = 0; i < count; i++) {
+    uint32_t id = ids[i];
+    if(occlusion_visible(occ, boxes[id])) {
+      visible[n++] = id;
+    }
+  }
+  return n;
+}
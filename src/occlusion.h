@@ -0,0 +1,81 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef OCCLUSION_FUNCTIONS
+#define OCCLUSION_FUNCTIONS
+
+#define OCCLUSION_MAX_LEVELS 16
+
+/**
+ * Software occlusion culling. A few occluder meshes are rasterized into a
+ * small depth buffer, a max-depth (Hi-Z) pyramid is built from it and
+ * object boxes are tested against the pyramid before their draws are
+ * submitted. Depth is window depth as glm_project gives it, smaller is
+ * nearer.
+ */
+struct occlusion {
+  int width, height;
+  int levels;
+  int level_width[OCCLUSION_MAX_LEVELS];
+  int level_height[OCCLUSION_MAX_LEVELS];
+  int level_stride[OCCLUSION_MAX_LEVELS];
+  float* level[OCCLUSION_MAX_LEVELS]; // level 0 is the depth buffer
+  mat4 view_proj;
+  vec4 viewport;
+  float* triangles; // projected occluder triangles, x y z per corner
+  size_t triangle_count, triangle_capacity;
+};
+
+/**
+ * Allocate a width x height depth buffer and its pyramid. A quarter or less
+ * of the window size is plenty.
+ */
+void occlusion_init(struct occlusion* occ, int width, int height);
+
+/**
+ * Free the buffers.
+ */
+void occlusion_destroy(struct occlusion* occ);
+
+/**
+ * Start a frame: drop last frame's occluders and use view_proj (world to
+ * clip space) for everything until the next occlusion_begin.
+ */
+void occlusion_begin(struct occlusion* occ, mat4 view_proj);
+
+/**
+ * Queue an indexed triangle mesh as occluder. positions has stride floats
+ * per vertex with x y z first, model takes it to world space. Triangles
+ * crossing the near plane are skipped, which only loses occlusion.
+ */
+void occlusion_add_occluder(
+    struct occlusion* occ, mat4 model, const float* positions, size_t stride,
+    const uint32_t* indices, size_t index_count
+);
+
+/**
+ * Rasterize the queued occluders on the job threads, one band of rows per
+ * job, then build the Hi-Z pyramid.
+ */
+void occlusion_render(struct occlusion* occ);
+
+/**
+ * Whether a world space box may be visible. False only when every pixel it
+ * covers has an occluder in front of its nearest point.
+ */
+bool occlusion_visible(struct occlusion* occ, vec3 box[2]);
+
+/**
+ * Keep the objects of ids (count of them, e.g. from bvh_frustum) whose
+ * boxes[id] are not occluded, write them to visible (may be ids) and
+ * return how many there are.
+ */
+size_t occlusion_cull(
+    struct occlusion* occ, vec3 (*boxes)[2], const uint32_t* ids,
+    size_t count, uint32_t* visible
+);
+
+#endif
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "occlusion_query.h"
+#include "shader.h"
+
+// queries are generated this many at a time
+#define OCCLUSION_QUERY_POOL_STEP 64
+
+static const char* box_vertex_source =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "uniform mat4 box_transform;\n"
+    "void main() {\n"
+    "  gl_Position = box_transform * vec4(position, 1.0);\n"
+    "}\n";
+
+// no color output, the query only counts samples passing the depth test
+static const char* box_fragment_source = "#version 330 core\n"
+                                         "void main() {\n"
+                                         "}\n";
+
+// unit cube [0, 1], scaled and moved onto each box
+static const float box_vertices[] = {
+    0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+};
+
+static const GLubyte box_indices[] = {
+    0, 2, 1, 1, 2, 3, // -z
+    4, 5, 6, 5, 7, 6, // +z
+    0, 1, 4, 1, 5, 4, // -y
+    2, 6, 3, 3, 6, 7, // +y
+    0, 4, 2, 2, 4, 6, // -x
+    1, 3, 5, 3, 7, 5  // +x
+};
+
+static void* occlusion_query_alloc(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate occlusion queries\n");
+    exit(1);
+  }
+  return p;
+}
+
+static GLuint occlusion_query_acquire(struct occlusion_queries* q) {
+  if(q->pool_count == 0) {
+    // every name ever generated fits back into the pool
+    q->pool_capacity += OCCLUSION_QUERY_POOL_STEP;
+    q->pool = realloc(q->pool, q->pool_capacity * sizeof(GLuint));
+    if(!q->pool) {
+      fprintf(stderr, "[Error] Could not allocate occlusion queries\n");
+      exit(1);
+    }
+    glGenQueries(OCCLUSION_QUERY_POOL_STEP, q->pool);
+    q->pool_count = OCCLUSION_QUERY_POOL_STEP;
+  }
+  return q->pool[--q->pool_count];
+}
+
+void occlusion_queries_init(struct occlusion_queries* q, size_t object_count) {
+  memset(q, 0, sizeof(*q));
+  q->object_count = object_count;
+  q->pending = occlusion_query_alloc(object_count * sizeof(GLuint));
+  q->visible = occlusion_query_alloc(object_count * sizeof(bool));
+  memset(q->pending, 0, object_count * sizeof(GLuint));
+  memset(q->visible, 1, object_count * sizeof(bool));
+
+  // conservative queries may count samples near edges, which is all a
+  // visibility test needs and lets the driver answer early
+  GLint major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  q->target = major > 4 || (major == 4 && minor >= 3)
+                  ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+                  : GL_ANY_SAMPLES_PASSED;
+
+  GLint program = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  q->program = process_shaders(box_vertex_source, box_fragment_source);
+  q->box_transform_loc = glGetUniformLocation(q->program, "box_transform");
+  glUseProgram(program);
+
+  GLint vao = 0;
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+  glGenVertexArrays(1, &q->vao);
+  glBindVertexArray(q->vao);
+  glGenBuffers(1, &q->vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, q->vbo);
+  glBufferData(
+      GL_ARRAY_BUFFER, sizeof(box_vertices), box_vertices, GL_STATIC_DRAW
+  );
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+  glEnableVertexAttribArray(0);
+  glGenBuffers(1, &q->ebo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, q->ebo);
+  glBufferData(
+      GL_ELEMENT_ARRAY_BUFFER, sizeof(box_indices), box_indices,
+      GL_STATIC_DRAW
+  );
+  glBindVertexArray(vao);
+}
+
+void occlusion_queries_destroy(struct occlusion_queries* q) {
+  for(size_t i = 0; i < q->object_count; i++) {
+    if(q->pending[i]) {
+      glDeleteQueries(1, &q->pending[i]);
+    }
+  }
+  glDeleteQueries(q->pool_count, q->pool);
+  glDeleteBuffers(1, &q->vbo);
+  glDeleteBuffers(1, &q->ebo);
+  glDeleteVertexArrays(1, &q->vao);
+  glDeleteProgram(q->program);
+  free(q->pending);
+  free(q->visible);
+  free(q->pool);
+  memset(q, 0, sizeof(*q));
+}
+
+void occlusion_queries_poll(struct occlusion_queries* q) {
+  for(size_t i = 0; i < q->object_count; i++) {
+    GLuint query = q->pending[i], available = 0, result = 0;
+    if(!query) {
+      continue;
+    }
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) {
+      continue;
+    }
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT, &result);
+    q->visible[i] = result != 0;
+    q->pending[i] = 0;
+    q->pool[q->pool_count++] = query;
+  }
+}
+
+bool occlusion_queries_begin_draw(struct occlusion_queries* q, uint32_t id) {
+  q->conditional = q->pending[id] != 0;
+  if(q->conditional) {
+    // the result is not back yet, let the gpu decide without stalling
+    glBeginConditionalRender(q->pending[id], GL_QUERY_NO_WAIT);
+    return true;
+  }
+  return q->visible[id];
+}
+
+void occlusion_queries_end_draw(struct occlusion_queries* q) {
+  if(q->conditional) {
+    glEndConditionalRender();
+    q->conditional = false;
+  }
+}
+
+void occlusion_queries_issue(
+    struct occlusion_queries* q, mat4 view_proj, vec3 (*boxes)[2],
+    const uint32_t* ids, size_t count
+) {
+  vec4 planes[6];
+  glm_frustum_planes(view_proj, planes);
+
+  GLint program = 0, vao = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+  GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+  GLboolean cull_face = glIsEnabled(GL_CULL_FACE);
+  GLint depth_func = GL_LESS;
+  glGetIntegerv(GL_DEPTH_FUNC, &depth_func);
+
+  glUseProgram(q->program);
+  glBindVertexArray(q->vao);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_FALSE);
+  glEnable(GL_DEPTH_TEST);
+  // faces lying on the object's own surface must still count as visible
+  glDepthFunc(GL_LEQUAL);
+  glDisable(GL_CULL_FACE);
+
+  for(size_t i = 0; i < count; i++) {
+    uint32_t id = ids[i];
+    if(q->pending[id]) {
+      continue;
+    }
+
+    bool crosses_near = false;
+    for(int c = 0; c < 8 && !crosses_near; c++) {
+      vec3 p = {
+          boxes[id][c & 1][0], boxes[id][(c >> 1) & 1][1],
+          boxes[id][(c >> 2) & 1][2]
+      };
+      crosses_near = glm_vec3_dot(planes[GLM_NEAR], p) + planes[GLM_NEAR][3] <
+                     0.0f;
+    }
+    if(crosses_near) {
+      q->visible[id] = true;
+      continue;
+    }
+
+    mat4 m;
+    vec3 size;
+    glm_vec3_sub(boxes[id][1], boxes[id][0], size);
+    glm_translate_make(m, boxes[id][0]);
+    glm_scale(m, size);
+    glm_mat4_mul(view_proj, m, m);
+    glUniformMatrix4fv(q->box_transform_loc, 1, GL_FALSE, *m);
+
+    GLuint query = occlusion_query_acquire(q);
+    glBeginQuery(q->target, query);
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, 0);
+    glEndQuery(q->target);
+    q->pending[id] = query;
+  }
+
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glDepthMask(GL_TRUE);
+  glDepthFunc(depth_func);
+  if(!depth_test) {
+    glDisable(GL_DEPTH_TEST);
+  }
+  if(cull_face) {
+    glEnable(GL_CULL_FACE);
+  }
+  glUseProgram(program);
+  glBindVertexArray(vao);
+}
@@ -0,0 +1,76 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GL/glew.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef OCCLUSION_QUERY_FUNCTIONS
+#define OCCLUSION_QUERY_FUNCTIONS
+
+/**
+ * GPU occlusion queries on object bounding boxes. Results are read back a
+ * frame (or more) late and never waited for: an object is drawn normally
+ * while it is known visible, skipped while it is known hidden and drawn
+ * under glBeginConditionalRender(GL_QUERY_NO_WAIT) while its query is still
+ * in flight, so the GPU drops it if the box turned out hidden.
+ *
+ * Per frame:
+ *   occlusion_queries_poll       collect finished results
+ *   occlusion_queries_begin_draw / occlusion_queries_end_draw around every
+ *                                object draw
+ *   occlusion_queries_issue      after the opaque pass, query boxes of
+ *                                objects without a query in flight
+ */
+struct occlusion_queries {
+  size_t object_count;
+  GLuint* pending;    // query in flight for each object, 0 if none
+  bool* visible;      // last result, objects start visible
+  GLuint* pool;       // free query names
+  size_t pool_count, pool_capacity;
+  GLenum target;      // GL_ANY_SAMPLES_PASSED(_CONSERVATIVE)
+  GLuint program, vao, vbo, ebo;
+  GLint box_transform_loc;
+  bool conditional;   // set by begin_draw for end_draw
+};
+
+/**
+ * Set up queries for object_count objects, the proxy box shader and its
+ * buffers. Uses GL_ANY_SAMPLES_PASSED_CONSERVATIVE on GL 4.3+ and
+ * GL_ANY_SAMPLES_PASSED before.
+ */
+void occlusion_queries_init(struct occlusion_queries* q, size_t object_count);
+
+/**
+ * Delete every query and GL object.
+ */
+void occlusion_queries_destroy(struct occlusion_queries* q);
+
+/**
+ * Read results of the queries which are done, without waiting for the
+ * rest.
+ */
+void occlusion_queries_poll(struct occlusion_queries* q);
+
+/**
+ * Call before drawing an object. Returns false when the object is known to
+ * be hidden and the draw should be skipped, otherwise the draw goes ahead
+ * (conditionally while a query is in flight). Pair every true return with
+ * occlusion_queries_end_draw.
+ */
+bool occlusion_queries_begin_draw(struct occlusion_queries* q, uint32_t id);
+void occlusion_queries_end_draw(struct occlusion_queries* q);
+
+/**
+ * Draw the boxes of objects ids[0..count) which have no query in flight
+ * into the current depth buffer, color and depth writes off, one query
+ * each. Boxes crossing the near plane are marked visible instead, their
+ * clipped proxy could miss every sample.
+ */
+void occlusion_queries_issue(
+    struct occlusion_queries* q, mat4 view_proj, vec3 (*boxes)[2],
+    const uint32_t* ids, size_t count
+);
+
+#endif
@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/cglm/cglm.h"
+
+#include "jobs.h"
+#include "scene.h"
+
+// below this a single thread is faster than waking the pool
+#define SCENE_MIN_PER_THREAD 4096
+#define SCENE_MAX_CHUNKS 64
+
+static void* scene_alloc(size_t size) {
+  // mat4 arrays are read with aligned SIMD loads
+  void* p = aligned_alloc(32, (size + 31) & ~(size_t)31);
+  if(!p) {
+    fprintf(stderr, "[Error] Could not allocate scene storage\n");
+    exit(1);
+  }
+  return p;
+}
+
+// move everything to new arrays of the given capacity, slot i of the new
+// layout is slot order[i] of the old one (NULL keeps the order)
+static void scene_relayout(
+    struct scene* scene, size_t capacity, const uint32_t* order
+) {
+  size_t old_capacity = scene->capacity;
+  float* translation = scene_alloc(3 * capacity * sizeof(float));
+  float* rotation = scene_alloc(4 * capacity * sizeof(float));
+  float* scale = scene_alloc(3 * capacity * sizeof(float));
+  uint32_t* parent = scene_alloc(capacity * sizeof(uint32_t));
+  uint32_t* depth = scene_alloc(capacity * sizeof(uint32_t));
+  uint32_t* slot = scene_alloc(capacity * sizeof(uint32_t));
+  uint32_t* node = scene_alloc(capacity * sizeof(uint32_t));
+  bool* dirty = scene_alloc(capacity * sizeof(bool));
+  mat4* world = scene_alloc(capacity * sizeof(mat4));
+
+  for(size_t i = 0; i < scene->count; i++) {
+    size_t from = order ? order[i] : i;
+    for(int k = 0; k < 3; k++) {
+      translation[k * capacity + i] =
+          scene->translation[k * old_capacity + from];
+      scale[k * capacity + i] = scene->scale[k * old_capacity + from];
+    }
+    for(int k = 0; k < 4; k++) {
+      rotation[k * capacity + i] = scene->rotation[k * old_capacity + from];
+    }
+    depth[i] = scene->depth[from];
+    node[i] = scene->node[from];
+    dirty[i] = scene->dirty[from];
+    glm_mat4_copy(scene->world[from], world[i]);
+    slot[node[i]] = (uint32_t)i;
+  }
+  // parents are slots too, map them through the new node -> slot table
+  for(size_t i = 0; i < scene->count; i++) {
+    uint32_t p = scene->parent[order ? order[i] : i];
+    parent[i] = p == SCENE_NO_PARENT ? p : slot[scene->node[p]];
+  }
+
+  free(scene->translation);
+  free(scene->rotation);
+  free(scene->scale);
+  free(scene->parent);
+  free(scene->depth);
+  free(scene->slot);
+  free(scene->node);
+  free(scene->dirty);
+  free(scene->local);
+  free(scene->parent_world);
+  free(scene->world);
+
+  scene->translation = translation;
+  scene->rotation = rotation;
+  scene->scale = scale;
+  scene->parent = parent;
+  scene->depth = depth;
+  scene->slot = slot;
+  scene->node = node;
+  scene->dirty = dirty;
+  scene->local = scene_alloc(capacity * sizeof(mat4));
+  scene->parent_world = scene_alloc(capacity * sizeof(mat4));
+  scene->world = world;
+  scene->capacity = capacity;
+  if(order) {
+    scene->first_dirty = 0;
+  }
+}
+
+// stable counting sort of the slots by depth
+static void scene_sort(struct scene* scene) {
+  uint32_t max_depth = 0;
+  for(size_t i = 0; i < scene->count; i++) {
+    if(scene->depth[i] > max_depth) {
+      max_depth = scene->depth[i];
+    }
+  }
+
+  size_t* start = calloc(max_depth + 2, sizeof(size_t));
+  uint32_t* order = malloc(scene->count * sizeof(uint32_t));
+  if(!start || !order) {
+    fprintf(stderr, "[Error] Could not allocate scene storage\n");
+    exit(1);
+  }
+  for(size_t i = 0; i < scene->count; i++) {
+    start[scene->depth[i] + 1]++;
+  }
+  for(uint32_t d = 1; d <= max_depth + 1; d++) {
+    start[d] += start[d - 1];
+  }
+  for(size_t i = 0; i < scene->count; i++) {
+    order[start[scene->depth[i]]++] = (uint32_t)i;
+  }
+
+  scene_relayout(scene, scene->capacity, order);
+  scene->sorted = true;
+  free(order);
+  free(start);
+}
+
+static void scene_mark_dirty(struct scene* scene, size_t i) {
+  scene->dirty[i] = true;
+  if(i < scene->first_dirty) {
+    scene->first_dirty = i;
+  }
+}
+
+void scene_init(struct scene* scene, size_t capacity) {
+  memset(scene, 0, sizeof(*scene));
+  scene->first_dirty = SIZE_MAX;
+  scene->sorted = true;
+  scene_relayout(scene, capacity ? capacity : 1, NULL);
+}
+
+void scene_destroy(struct scene* scene) {
+  free(scene->translation);
+  free(scene->rotation);
+  free(scene->scale);
+  free(scene->parent);
+  free(scene->depth);
+  free(scene->slot);
+  free(scene->node);
+  free(scene->dirty);
+  free(scene->local);
+  free(scene->parent_world);
+  free(scene->world);
+  memset(scene, 0, sizeof(*scene));
+}
+
+uint32_t scene_add(struct scene* scene, uint32_t parent) {
+  if(scene->count == scene->capacity) {
+    scene_relayout(scene, scene->capacity * 2, NULL);
+  }
+
+  size_t i = scene->count++;
+  size_t capacity = scene->capacity;
+  for(int k = 0; k < 3; k++) {
+    scene->translation[k * capacity + i] = 0.0f;
+    scene->rotation[k * capacity + i] = 0.0f;
+    scene->scale[k * capacity + i] = 1.0f;
+  }
+  scene->rotation[3 * capacity + i] = 1.0f;
+
+  if(parent == SCENE_NO_PARENT) {
+    scene->parent[i] = SCENE_NO_PARENT;
+    scene->depth[i] = 0;
+  } else {
+    scene->parent[i] = scene->slot[parent];
+    scene->depth[i] = scene->depth[scene->parent[i]] + 1;
+  }
+  if(i > 0 && scene->depth[i] < scene->depth[i - 1]) {
+    scene->sorted = false;
+  }
+
+  // new nodes take the next id, which is also their slot until a sort
+  scene->node[i] = (uint32_t)i;
+  scene->slot[i] = (uint32_t)i;
+  scene_mark_dirty(scene, i);
+  glm_mat4_identity(scene->world[i]);
+  return (uint32_t)i;
+}
+
+void scene_set_translation(struct scene* scene, uint32_t node, vec3 t) {
+  size_t i = scene->slot[node];
+  for(int k = 0; k < 3; k++) {
+    scene->translation[k * scene->capacity + i] = t[k];
+  }
+  scene_mark_dirty(scene, i);
+}
+
+void scene_set_rotation(struct scene* scene, uint32_t node, versor q) {
+  size_t i = scene->slot[node];
+  for(int k = 0; k < 4; k++) {
+    scene->rotation[k * scene->capacity + i] = q[k];
+  }
+  scene_mark_dirty(scene, i);
+}
+
+void scene_set_scale(struct scene* scene, uint32_t node, vec3 s) {
+  size_t i = scene->slot[node];
+  for(int k = 0; k < 3; k++) {
+    scene->scale[k * scene->capacity + i] = s[k];
+  }
+  scene_mark_dirty(scene, i);
+}
+
+vec4* scene_world(struct scene* scene, uint32_t node) {
+  return scene->world[scene->slot[node]];
+}
+
+// world matrices of the dirty slots [first, first + count), all of one level
+static void scene_update_run(struct scene* scene, size_t first, size_t count) {
+  size_t capacity = scene->capacity;
+  bool roots = scene->parent[first] == SCENE_NO_PARENT;
+  // roots have no parent to multiply with, build them in place
+  mat4* local = roots ? scene->world : scene->local;
+
+  glm_quat_mat4_soa(scene->rotation + first, capacity, local + first, count);
+  for(size_t i = first; i < first + count; i++) {
+    glm_vec4_scale(local[i][0], scene->scale[i], local[i][0]);
+    glm_vec4_scale(local[i][1], scene->scale[capacity + i], local[i][1]);
+    glm_vec4_scale(local[i][2], scene->scale[2 * capacity + i], local[i][2]);
+    local[i][3][0] = scene->translation[i];
+    local[i][3][1] = scene->translation[capacity + i];
+    local[i][3][2] = scene->translation[2 * capacity + i];
+  }
+  if(roots) {
+    return;
+  }
+
+  for(size_t i = first; i < first + count; i++) {
+    glm_mat4_copy(scene->world[scene->parent[i]], scene->parent_world[i]);
+  }
+  glm_mat4_mul_batch(
+      scene->parent_world + first, local + first, scene->world + first, count
+  );
+}
+
+// every dirty run of [first, last)
+static void scene_update_range(struct scene* scene, size_t first, size_t last) {
+  size_t i = first;
+  while(i < last) {
+    if(!scene->dirty[i]) {
+      i++;
+      continue;
+    }
+    size_t end = i + 1;
+    while(end < last && scene->dirty[end]) {
+      end++;
+    }
+    scene_update_run(scene, i, end - i);
+    i = end;
+  }
+}
+
+struct scene_job {
+  struct scene* scene;
+  size_t first, last, chunk;
+};
+
+static void scene_update_chunk(void* arg, size_t index) {
+  struct scene_job* job = arg;
+  size_t first = job->first + index * job->chunk;
+  size_t last = job->last - first < job->chunk ? job->last : first + job->chunk;
+  scene_update_range(job->scene, first, last);
+}
+
+static void scene_update_level(struct scene* scene, size_t first, size_t last) {
+  size_t chunks = (last - first) / SCENE_MIN_PER_THREAD;
+  size_t threads = (size_t)jobs_thread_count();
+  if(chunks > threads) {
+    chunks = threads;
+  }
+  if(chunks > SCENE_MAX_CHUNKS) {
+    chunks = SCENE_MAX_CHUNKS;
+  }
+  if(chunks <= 1) {
+    scene_update_range(scene, first, last);
+    return;
+  }
+
+  struct scene_job job = {
+      .scene = scene,
+      .first = first,
+      .last = last,
+      .chunk = (last - first + chunks - 1) / chunks,
+  };
+  jobs_run(scene_update_chunk, &job, chunks);
+}
+
+size_t scene_update(struct scene* scene) {
+  if(!scene->sorted) {
+    scene_sort(scene);
+  }
+
+  if(scene->first_dirty >= scene->count) {
+    return 0;
+  }
+
+  // parents come first, so one pass pushes dirty down whole subtrees,
+  // everything before the first dirty slot is clean and stays clean
+  size_t changed = 0;
+  for(size_t i = scene->first_dirty; i < scene->count; i++) {
+    uint32_t p = scene->parent[i];
+    if(p != SCENE_NO_PARENT && scene->dirty[p]) {
+      scene->dirty[i] = true;
+    }
+    changed += scene->dirty[i];
+  }
+
+  size_t first = scene->first_dirty;
+  while(first < scene->count) {
+    size_t last = first + 1;
+    while(last < scene->count && scene->depth[last] == scene->depth[first]) {
+      last++;
+    }
+    scene_update_level(scene, first, last);
+    first = last;
+  }
+
+  memset(
+      scene->dirty + scene->first_dirty, 0,
+      (scene->count - scene->first_dirty) * sizeof(bool)
+  );
+  scene->first_dirty = SIZE_MAX;
+  return changed;
+}
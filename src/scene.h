@@ -0,0 +1,80 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef SCENE_FUNCTIONS
+#define SCENE_FUNCTIONS
+
+#define SCENE_NO_PARENT UINT32_MAX
+
+/**
+ * Transform hierarchy. Nodes are addressed by the id scene_add returns,
+ * storage is kept in slots sorted by depth (roots first, then their
+ * children, ...) so parents always come before children and every level is
+ * one contiguous range.
+ *
+ * Local translation, rotation (quaternion) and scale are SoA planes:
+ * component k of slot i is at p[k * capacity + i]. World matrices are only
+ * recomputed for nodes which changed since the last scene_update and for
+ * everything below them.
+ */
+struct scene {
+  size_t count, capacity;
+  float* translation; // 3 planes
+  float* rotation;    // 4 planes, x y z w
+  float* scale;       // 3 planes
+  uint32_t* parent;   // parent slot or SCENE_NO_PARENT
+  uint32_t* depth;
+  uint32_t* slot;     // node id -> slot
+  uint32_t* node;     // slot -> node id
+  bool* dirty;
+  size_t first_dirty; // lowest dirty slot, SIZE_MAX when clean
+  mat4* local;        // scratch for T * R * S
+  mat4* parent_world; // scratch for gathered parent matrices
+  mat4* world;
+  bool sorted;
+};
+
+/**
+ * Initialize an empty scene with room for capacity nodes, it grows on
+ * demand.
+ */
+void scene_init(struct scene* scene, size_t capacity);
+
+/**
+ * Free everything scene_init and scene_add allocated.
+ */
+void scene_destroy(struct scene* scene);
+
+/**
+ * Add a node with identity transform under parent (a node id, or
+ * SCENE_NO_PARENT for a root) and return its id. Nodes can be added in any
+ * order as long as the parent exists, slots are re-sorted on the next
+ * scene_update.
+ */
+uint32_t scene_add(struct scene* scene, uint32_t parent);
+
+/**
+ * Set the local transform of a node and mark it dirty.
+ */
+void scene_set_translation(struct scene* scene, uint32_t node, vec3 t);
+void scene_set_rotation(struct scene* scene, uint32_t node, versor q);
+void scene_set_scale(struct scene* scene, uint32_t node, vec3 s);
+
+/**
+ * Recompute world matrices of dirty nodes and their subtrees, one depth
+ * level at a time. Nodes of one level are independent of each other, large
+ * levels are split across the job threads. Returns the number of world
+ * matrices which changed.
+ */
+size_t scene_update(struct scene* scene);
+
+/**
+ * World matrix of a node as of the last scene_update. The pointer is valid
+ * until the next scene_add or scene_update.
+ */
+vec4* scene_world(struct scene* scene, uint32_t node);
+
+#endif
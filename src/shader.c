@@ -12,6 +12,8 @@ const char* shader_type_as_cstr(GLuint shader) {
     return "GL_VERTEX_SHADER";
   case GL_FRAGMENT_SHADER:
     return "GL_FRAGMENT_SHADER";
+  case GL_COMPUTE_SHADER:
+    return "GL_COMPUTE_SHADER";
   default:
     return "(Unknown)";
   }
@@ -77,3 +79,28 @@ GLuint process_shaders(const GLchar* vert_source, const GLchar* frag_source) {
   glUseProgram(program);
   return program;
 }
+
+GLuint process_compute_shader(const GLchar* source) {
+  GLuint shader = 0;
+  if(!compile_shader_source(source, GL_COMPUTE_SHADER, &shader)) {
+    fprintf(stderr, "[ERROR] Could not compile/link shaders\n");
+    exit(1);
+  }
+  GLuint program = glCreateProgram();
+  glAttachShader(program, shader);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+
+  GLint linked = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if(!linked) {
+    GLsizei message_size = 0;
+    GLchar message[1024];
+    glGetProgramInfoLog(program, sizeof(message), &message_size, message);
+    fprintf(
+        stderr, "[Error] Could not link program: %.*s\n", message_size, message
+    );
+    exit(1);
+  }
+  return program;
+}
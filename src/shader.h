@@ -9,4 +9,10 @@
  */
 GLuint process_shaders(const GLchar* vert_source, const GLchar* frag_source);
 
+/**
+ * Create, Link and Return a Program from compute shader source (GL 4.3).
+ * Unlike process_shaders it does not make the program current.
+ */
+GLuint process_compute_shader(const GLchar* source);
+
 #endif
@@ -0,0 +1,177 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "../include/cglm/cglm.h"
+#include "../include/cglm/pack.h"
+
+#include "vertex_layout.h"
+
+GLsizei vertex_format_size(enum vertex_format format) {
+  switch(format) {
+  case VERTEX_FLOAT2:
+    return 2 * sizeof(float);
+  case VERTEX_FLOAT3:
+    return 3 * sizeof(float);
+  case VERTEX_FLOAT4:
+    return 4 * sizeof(float);
+  case VERTEX_HALF2:
+    return 2 * sizeof(uint16_t);
+  case VERTEX_HALF4:
+    return 4 * sizeof(uint16_t);
+  case VERTEX_UNORM8X4:
+  case VERTEX_UNORM8X3:
+    return 4 * sizeof(uint8_t);
+  case VERTEX_OCT_SNORM16:
+    return 2 * sizeof(int16_t);
+  case VERTEX_QUANTIZED_UNORM16:
+    // the fourth short pads the attribute to 4 byte alignment
+    return 4 * sizeof(uint16_t);
+  default:
+    fprintf(stderr, "[Error] Unknown vertex format %d\n", format);
+    exit(1);
+  }
+}
+
+void vertex_layout_init(
+    struct vertex_layout* layout, const struct vertex_attrib* attribs,
+    int count
+) {
+  if(count > VERTEX_LAYOUT_MAX_ATTRIBS) {
+    fprintf(
+        stderr, "[Error] More than %d vertex attributes\n",
+        VERTEX_LAYOUT_MAX_ATTRIBS
+    );
+    exit(1);
+  }
+  memset(layout, 0, sizeof(*layout));
+  layout->count = count;
+  for(int i = 0; i < count; i++) {
+    layout->attribs[i] = attribs[i];
+    layout->offsets[i] = layout->stride;
+    layout->stride += vertex_format_size(attribs[i].format);
+  }
+  glm_vec3_one(layout->box[1]);
+}
+
+void vertex_layout_set_box(struct vertex_layout* layout, vec3 box[2]) {
+  glm_vec3_copy(box[0], layout->box[0]);
+  glm_vec3_copy(box[1], layout->box[1]);
+}
+
+void vertex_layout_pack(
+    const struct vertex_layout* layout, const float* source,
+    size_t source_stride, size_t count, void* dest
+) {
+  vec3 box[2];
+  glm_vec3_copy((float*)layout->box[0], box[0]);
+  glm_vec3_copy((float*)layout->box[1], box[1]);
+
+  for(size_t i = 0; i < count; i++) {
+    unsigned char* vertex = (unsigned char*)dest + i * layout->stride;
+    const float* src = source + i * source_stride;
+    for(int a = 0; a < layout->count; a++) {
+      const float* s = src + layout->attribs[a].source;
+      unsigned char* d = vertex + layout->offsets[a];
+      uint16_t h[4] = {0, 0, 0, 0};
+      int16_t oct[2];
+      uint8_t unorm[4];
+      vec4 v;
+
+      // memcpy in and out, neither side need be aligned: a source
+      // attribute can start at any float of its vertex
+      switch(layout->attribs[a].format) {
+      case VERTEX_FLOAT2:
+      case VERTEX_FLOAT3:
+      case VERTEX_FLOAT4:
+        memcpy(d, s, vertex_format_size(layout->attribs[a].format));
+        break;
+      case VERTEX_HALF4:
+        h[2] = glm_pack_half(s[2]);
+        h[3] = glm_pack_half(s[3]);
+        // fall through
+      case VERTEX_HALF2:
+        h[0] = glm_pack_half(s[0]);
+        h[1] = glm_pack_half(s[1]);
+        memcpy(d, h, vertex_format_size(layout->attribs[a].format));
+        break;
+      case VERTEX_UNORM8X4:
+      case VERTEX_UNORM8X3:
+        v[3] = 1.0f;
+        memcpy(v, s, layout->attribs[a].format == VERTEX_UNORM8X3
+                         ? 3 * sizeof(float)
+                         : 4 * sizeof(float));
+        glm_vec4_pack_unorm8(v, unorm);
+        memcpy(d, unorm, sizeof(unorm));
+        break;
+      case VERTEX_OCT_SNORM16:
+        memcpy(v, s, 3 * sizeof(float));
+        glm_vec3_pack_oct_snorm16(v, oct);
+        memcpy(d, oct, sizeof(oct));
+        break;
+      case VERTEX_QUANTIZED_UNORM16:
+        memcpy(v, s, 3 * sizeof(float));
+        glm_vec3_quantize_unorm16(v, box, h);
+        memcpy(d, h, sizeof(h));
+        break;
+      }
+    }
+  }
+}
+
+void process_vertex_layout(const struct vertex_layout* layout, size_t offset) {
+  for(int a = 0; a < layout->count; a++) {
+    GLint size;
+    GLenum type;
+    GLboolean normalized = GL_TRUE;
+    switch(layout->attribs[a].format) {
+    case VERTEX_FLOAT2:
+    case VERTEX_FLOAT3:
+    case VERTEX_FLOAT4:
+      size = 2 + (layout->attribs[a].format - VERTEX_FLOAT2);
+      type = GL_FLOAT;
+      normalized = GL_FALSE;
+      break;
+    case VERTEX_HALF2:
+    case VERTEX_HALF4:
+      size = layout->attribs[a].format == VERTEX_HALF2 ? 2 : 4;
+      type = GL_HALF_FLOAT;
+      normalized = GL_FALSE;
+      break;
+    case VERTEX_UNORM8X4:
+    case VERTEX_UNORM8X3:
+      size = 4;
+      type = GL_UNSIGNED_BYTE;
+      break;
+    case VERTEX_OCT_SNORM16:
+      size = 2;
+      type = GL_SHORT;
+      break;
+    default:
+      size = 4;
+      type = GL_UNSIGNED_SHORT;
+      break;
+    }
+    GLuint location = layout->attribs[a].location;
+    glVertexAttribPointer(
+        location, size, type, normalized, layout->stride,
+        (void*)(offset + layout->offsets[a])
+    );
+    glEnableVertexAttribArray(location);
+  }
+}
+
+void vertex_layout_set_uniforms(
+    const struct vertex_layout* layout, GLuint program
+) {
+  vec3 extent;
+  glm_vec3_sub((float*)layout->box[1], (float*)layout->box[0], extent);
+  glUniform3fv(
+      glGetUniformLocation(program, "vertex_box_min"), 1, layout->box[0]
+  );
+  glUniform3fv(glGetUniformLocation(program, "vertex_box_extent"), 1, extent);
+}
@@ -0,0 +1,112 @@
+#include <stddef.h>
+
+#include <GL/glew.h>
+
+#include "../include/cglm/types.h"
+
+#ifndef VERTEX_LAYOUT_FUNCTIONS
+#define VERTEX_LAYOUT_FUNCTIONS
+
+#define VERTEX_LAYOUT_MAX_ATTRIBS 8
+
+/**
+ * Attribute formats, packed on the cpu with cglm/pack.h. Sizes are padded to
+ * 4 bytes, attributes start aligned.
+ */
+enum vertex_format {
+  VERTEX_FLOAT2,         // 8 bytes
+  VERTEX_FLOAT3,         // 12 bytes
+  VERTEX_FLOAT4,         // 16 bytes
+  VERTEX_HALF2,          // 4 bytes, glm_pack_half, e.g. uvs
+  VERTEX_HALF4,          // 8 bytes
+  VERTEX_UNORM8X4,       // 4 bytes, glm_vec4_pack_unorm8, e.g. colors
+  VERTEX_UNORM8X3,       // 4 bytes, from 3 floats, the fourth byte is 1.0
+  VERTEX_OCT_SNORM16,    // 4 bytes, unit vectors, decode VERTEX_GLSL_OCT
+  VERTEX_QUANTIZED_UNORM16 // 8 bytes, points in the layout's box, decode
+                           // VERTEX_GLSL_DEQUANTIZE
+};
+
+/**
+ * One attribute: where the shader reads it, how it is stored and which
+ * floats of the source vertex (source, source + 1, ...) it is packed from.
+ */
+struct vertex_attrib {
+  GLuint location;
+  enum vertex_format format;
+  int source;
+};
+
+/**
+ * An interleaved vertex, described once and used both to pack vertices and
+ * to set up the vertex array.
+ */
+struct vertex_layout {
+  struct vertex_attrib attribs[VERTEX_LAYOUT_MAX_ATTRIBS];
+  GLsizei offsets[VERTEX_LAYOUT_MAX_ATTRIBS];
+  int count;
+  GLsizei stride;
+  vec3 box[2]; // quantization bounds, see vertex_layout_set_box
+};
+
+/**
+ * GLSL (330 core) decode snippets, paste into the vertex shader source before
+ * main(), like the instance ones.
+ */
+#define VERTEX_GLSL_OCT                                                       \
+  "vec3 oct_decode(vec2 e) {\n"                                               \
+  "  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"                          \
+  "  float t = max(-v.z, 0.0);\n"                                             \
+  "  v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0.0)));\n"   \
+  "  return normalize(v);\n"                                                  \
+  "}\n"
+
+// set the uniforms with vertex_layout_set_uniforms
+#define VERTEX_GLSL_DEQUANTIZE                                                \
+  "uniform vec3 vertex_box_min;\n"                                            \
+  "uniform vec3 vertex_box_extent;\n"                                         \
+  "vec3 dequantize(vec4 q) {\n"                                               \
+  "  return vertex_box_min + q.xyz * vertex_box_extent;\n"                    \
+  "}\n"
+
+/**
+ * Size in bytes of one attribute in the given format.
+ */
+GLsizei vertex_format_size(enum vertex_format format);
+
+/**
+ * Lay count attributes out in order and compute offsets and stride. The box
+ * starts as the unit cube.
+ */
+void vertex_layout_init(
+    struct vertex_layout* layout, const struct vertex_attrib* attribs,
+    int count
+);
+
+/**
+ * Bounds VERTEX_QUANTIZED_UNORM16 attributes are quantized in.
+ */
+void vertex_layout_set_box(struct vertex_layout* layout, vec3 box[2]);
+
+/**
+ * Pack count source vertices of source_stride floats each into dest,
+ * layout->stride bytes per vertex.
+ */
+void vertex_layout_pack(
+    const struct vertex_layout* layout, const float* source,
+    size_t source_stride, size_t count, void* dest
+);
+
+/**
+ * Point the layout's attributes to the bound GL_ARRAY_BUFFER, vertices
+ * starting at offset bytes, and enable them.
+ */
+void process_vertex_layout(const struct vertex_layout* layout, size_t offset);
+
+/**
+ * Set the VERTEX_GLSL_DEQUANTIZE uniforms of the current program.
+ */
+void vertex_layout_set_uniforms(
+    const struct vertex_layout* layout, GLuint program
+);
+
+#endif